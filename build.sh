@@ -2,7 +2,7 @@ rm -rf build
 
 mkdir build
 
-clang -g -Wall \
+clang -g -Wall -DMATH_HEADER_ONLY -DRENDER_STATS \
 -I /usr/local/include -I ./libs -framework OpenGL \
 /usr/local/lib/libglfw.3.3.dylib ./libs/**/*.c ./src/*.c \
 -o ./build/main
\ No newline at end of file
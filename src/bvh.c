@@ -0,0 +1,497 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include "bvh.h"
+#include "utils.h"
+
+#define SAH_BINS 16
+// leaves this small are never split
+static const int MIN_SPLIT_ITEMS = 4;
+// leaves this large are always split when the items can be separated
+static const int MAX_LEAF_ITEMS = 16;
+// cost of visiting a node relative to testing an item
+static const float TRAVERSAL_COST = 1.0f;
+// refit hands the subtrees this far down to separate threads
+#define REFIT_SPLIT_DEPTH 6
+// nodes this deep are left as leaves, which bounds the traversal stack
+#define MAX_DEPTH 64
+
+typedef struct refitJob
+{
+    bvh_t *bvh;
+    v3_t *mins;
+    v3_t *maxs;
+    int roots[1 << REFIT_SPLIT_DEPTH];
+} refitJob_t;
+
+// comparisons rather than fminf, which compilers leave as a libm call to
+// handle NaNs. bounds are never NaN, and the build does this per item per axis
+static v3_t minV3(v3_t a, v3_t b)
+{
+    return v3_create(a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z);
+}
+
+static v3_t maxV3(v3_t a, v3_t b)
+{
+    return v3_create(a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z);
+}
+
+static float axisOf(v3_t v, int axis)
+{
+    return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+}
+
+// half the surface area, the constant factor doesn't change the SAH's choice
+static float halfArea(v3_t min, v3_t max)
+{
+    v3_t d = v3_sub(max, min);
+    return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+static void leafBounds(bvh_t *bvh, v3_t *mins, v3_t *maxs, bvh_node_t *node)
+{
+    node->min = v3_create(INFINITY, INFINITY, INFINITY);
+    node->max = v3_create(-INFINITY, -INFINITY, -INFINITY);
+    for (int i = node->first; i < node->first + node->count; ++i)
+    {
+        node->min = minV3(node->min, mins[bvh->items[i]]);
+        node->max = maxV3(node->max, maxs[bvh->items[i]]);
+    }
+}
+
+typedef struct buildState
+{
+    bvh_t *bvh;
+    v3_t *mins;
+    v3_t *maxs;
+    v3_t *centroids;
+} buildState_t;
+
+typedef struct sahBin
+{
+    v3_t min;
+    v3_t max;
+    int count;
+} sahBin_t;
+
+static int binOf(float centroid, float lo, float binScale)
+{
+    int b = (int)((centroid - lo) * binScale);
+    return b < SAH_BINS ? b : SAH_BINS - 1;
+}
+
+// top down, splitting each node where the binned surface area heuristic says
+// the two halves are cheapest to traverse. every node takes three passes over
+// its items: bounds, binning all three axes at once, then partitioning
+static void buildNode(buildState_t *state, int nodeIndex, int depth, int first, int count)
+{
+    bvh_t *bvh = state->bvh;
+    bvh_node_t *node = &bvh->nodes[nodeIndex];
+    node->first = first;
+    node->count = count;
+
+    // items are binned by their centroids
+    v3_t min = v3_create(INFINITY, INFINITY, INFINITY);
+    v3_t max = v3_create(-INFINITY, -INFINITY, -INFINITY);
+    v3_t centroidMin = min;
+    v3_t centroidMax = max;
+    for (int i = first; i < first + count; ++i)
+    {
+        int item = bvh->items[i];
+        min = minV3(min, state->mins[item]);
+        max = maxV3(max, state->maxs[item]);
+        centroidMin = minV3(centroidMin, state->centroids[item]);
+        centroidMax = maxV3(centroidMax, state->centroids[item]);
+    }
+    node->min = min;
+    node->max = max;
+    if (count <= MIN_SPLIT_ITEMS || depth == MAX_DEPTH)
+    {
+        return;
+    }
+
+    float los[3];
+    float binScales[3];
+    sahBin_t bins[3][SAH_BINS];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        los[axis] = axisOf(centroidMin, axis);
+        float extent = axisOf(centroidMax, axis) - los[axis];
+        binScales[axis] = extent > 0.0f ? SAH_BINS / extent : 0.0f;
+        for (int b = 0; b < SAH_BINS; ++b)
+        {
+            bins[axis][b].min = v3_create(INFINITY, INFINITY, INFINITY);
+            bins[axis][b].max = v3_create(-INFINITY, -INFINITY, -INFINITY);
+            bins[axis][b].count = 0;
+        }
+    }
+    for (int i = first; i < first + count; ++i)
+    {
+        int item = bvh->items[i];
+        v3_t centroid = state->centroids[item];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            sahBin_t *bin = &bins[axis][binOf(axisOf(centroid, axis), los[axis], binScales[axis])];
+            bin->min = minV3(bin->min, state->mins[item]);
+            bin->max = maxV3(bin->max, state->maxs[item]);
+            ++bin->count;
+        }
+    }
+
+    float bestCost = INFINITY;
+    int bestAxis = -1;
+    int bestBin = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (binScales[axis] == 0.0f)
+        {
+            continue;
+        }
+        // sweep from the right to get the cost right of every boundary, then
+        // from the left to combine them
+        float rightCosts[SAH_BINS];
+        v3_t accMin = v3_create(INFINITY, INFINITY, INFINITY);
+        v3_t accMax = v3_create(-INFINITY, -INFINITY, -INFINITY);
+        int accCount = 0;
+        for (int b = SAH_BINS - 1; b > 0; --b)
+        {
+            accMin = minV3(accMin, bins[axis][b].min);
+            accMax = maxV3(accMax, bins[axis][b].max);
+            accCount += bins[axis][b].count;
+            rightCosts[b] = accCount > 0 ? accCount * halfArea(accMin, accMax) : 0.0f;
+        }
+        accMin = v3_create(INFINITY, INFINITY, INFINITY);
+        accMax = v3_create(-INFINITY, -INFINITY, -INFINITY);
+        accCount = 0;
+        for (int b = 0; b < SAH_BINS - 1; ++b)
+        {
+            accMin = minV3(accMin, bins[axis][b].min);
+            accMax = maxV3(accMax, bins[axis][b].max);
+            accCount += bins[axis][b].count;
+            if (accCount == 0 || accCount == count)
+            {
+                continue;
+            }
+            float cost = accCount * halfArea(accMin, accMax) + rightCosts[b + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = b;
+            }
+        }
+    }
+
+    // every centroid in the same place, nothing separates them
+    if (bestAxis < 0)
+    {
+        return;
+    }
+    float area = halfArea(min, max);
+    bool isSplitCheaper = TRAVERSAL_COST * area + bestCost < count * area;
+    if (!isSplitCheaper && count <= MAX_LEAF_ITEMS)
+    {
+        return;
+    }
+
+    // partition in place around the chosen boundary
+    int left = first;
+    int right = first + count - 1;
+    while (left <= right)
+    {
+        int item = bvh->items[left];
+        if (binOf(axisOf(state->centroids[item], bestAxis), los[bestAxis], binScales[bestAxis]) <= bestBin)
+        {
+            ++left;
+        }
+        else
+        {
+            bvh->items[left] = bvh->items[right];
+            bvh->items[right] = item;
+            --right;
+        }
+    }
+    int leftCount = left - first;
+
+    int childIndex = bvh->nodesLen;
+    bvh->nodesLen += 2;
+    node->first = childIndex;
+    node->count = 0;
+    buildNode(state, childIndex, depth + 1, first, leftCount);
+    buildNode(state, childIndex + 1, depth + 1, first + leftCount, count - leftCount);
+}
+
+bvh_t bvh_build(v3_t *mins, v3_t *maxs, int len)
+{
+    bvh_t bvh;
+    bvh.itemsLen = len;
+    bvh.items = utils_malloc(sizeof(int) * (len > 0 ? len : 1));
+    for (int i = 0; i < len; ++i)
+    {
+        bvh.items[i] = i;
+    }
+    // a binary tree with at least one item per leaf never needs more
+    bvh.nodes = utils_malloc(sizeof(bvh_node_t) * (len > 0 ? 2 * len - 1 : 1));
+    bvh.nodesLen = 1;
+
+    buildState_t state;
+    state.bvh = &bvh;
+    state.mins = mins;
+    state.maxs = maxs;
+    state.centroids = utils_malloc(sizeof(v3_t) * (len > 0 ? len : 1));
+    for (int i = 0; i < len; ++i)
+    {
+        state.centroids[i] = v3_mul(v3_add(mins[i], maxs[i]), 0.5f);
+    }
+    buildNode(&state, 0, 0, 0, len);
+    free(state.centroids);
+    return bvh;
+}
+
+static void refitNode(bvh_t *bvh, v3_t *mins, v3_t *maxs, int nodeIndex)
+{
+    bvh_node_t *node = &bvh->nodes[nodeIndex];
+    if (node->count > 0)
+    {
+        leafBounds(bvh, mins, maxs, node);
+        return;
+    }
+    refitNode(bvh, mins, maxs, node->first);
+    refitNode(bvh, mins, maxs, node->first + 1);
+    node->min = minV3(bvh->nodes[node->first].min, bvh->nodes[node->first + 1].min);
+    node->max = maxV3(bvh->nodes[node->first].max, bvh->nodes[node->first + 1].max);
+}
+
+static void refitSubtreeJob(void *ctx, int index)
+{
+    refitJob_t *job = ctx;
+    refitNode(job->bvh, job->mins, job->maxs, job->roots[index]);
+}
+
+static void collectRefitRoots(bvh_t *bvh, int nodeIndex, int depth, int *roots, int *rootsLen)
+{
+    bvh_node_t *node = &bvh->nodes[nodeIndex];
+    if (depth == REFIT_SPLIT_DEPTH || node->count > 0)
+    {
+        roots[(*rootsLen)++] = nodeIndex;
+        return;
+    }
+    collectRefitRoots(bvh, node->first, depth + 1, roots, rootsLen);
+    collectRefitRoots(bvh, node->first + 1, depth + 1, roots, rootsLen);
+}
+
+// the nodes above the subtrees, once those are done
+static void refitTop(bvh_t *bvh, int nodeIndex, int depth)
+{
+    bvh_node_t *node = &bvh->nodes[nodeIndex];
+    if (depth == REFIT_SPLIT_DEPTH || node->count > 0)
+    {
+        return;
+    }
+    refitTop(bvh, node->first, depth + 1);
+    refitTop(bvh, node->first + 1, depth + 1);
+    node->min = minV3(bvh->nodes[node->first].min, bvh->nodes[node->first + 1].min);
+    node->max = maxV3(bvh->nodes[node->first].max, bvh->nodes[node->first + 1].max);
+}
+
+// updates the node bounds after items moved, keeping the tree's shape. cheaper
+// than a rebuild, but the tree degrades if items move far from where they were
+// built
+void bvh_refit(bvh_t *bvh, v3_t *mins, v3_t *maxs, int numThreads)
+{
+    if (bvh->itemsLen == 0)
+    {
+        return;
+    }
+    refitJob_t job;
+    job.bvh = bvh;
+    job.mins = mins;
+    job.maxs = maxs;
+    int rootsLen = 0;
+    collectRefitRoots(bvh, 0, 0, job.roots, &rootsLen);
+    utils_parallelFor(rootsLen, numThreads, refitSubtreeJob, &job);
+    refitTop(bvh, 0, 0);
+}
+
+// distance of the box corner furthest along the plane normal, and the nearest
+static void planeExtents(frustum_t *frustum, int plane, v3_t min, v3_t max, float *far, float *near)
+{
+    v3_t n = frustum->normals[plane];
+    v3_t p = v3_create(n.x >= 0.0f ? max.x : min.x, n.y >= 0.0f ? max.y : min.y, n.z >= 0.0f ? max.z : min.z);
+    v3_t q = v3_create(n.x >= 0.0f ? min.x : max.x, n.y >= 0.0f ? min.y : max.y, n.z >= 0.0f ? min.z : max.z);
+    *far = v3_dot(n, p) + frustum->distances[plane];
+    *near = v3_dot(n, q) + frustum->distances[plane];
+}
+
+static void emitSubtree(bvh_t *bvh, int nodeIndex, int *result, int *resultLen)
+{
+    bvh_node_t *node = &bvh->nodes[nodeIndex];
+    if (node->count > 0)
+    {
+        for (int i = node->first; i < node->first + node->count; ++i)
+        {
+            result[(*resultLen)++] = bvh->items[i];
+        }
+        return;
+    }
+    emitSubtree(bvh, node->first, result, resultLen);
+    emitSubtree(bvh, node->first + 1, result, resultLen);
+}
+
+// planeMask holds the planes the parent straddled, a node fully inside one
+// never tests it again below
+static void cullNode(
+    bvh_t *bvh, frustum_t *frustum, v3_t *mins, v3_t *maxs,
+    int nodeIndex, int planeMask, int *result, int *resultLen)
+{
+    bvh_node_t *node = &bvh->nodes[nodeIndex];
+    for (int plane = 0; plane < FRUSTUM_PLANES_LEN; ++plane)
+    {
+        if ((planeMask & (1 << plane)) == 0)
+        {
+            continue;
+        }
+        float far, near;
+        planeExtents(frustum, plane, node->min, node->max, &far, &near);
+        if (far < 0.0f)
+        {
+            return;
+        }
+        if (near >= 0.0f)
+        {
+            planeMask &= ~(1 << plane);
+        }
+    }
+
+    if (planeMask == 0)
+    {
+        emitSubtree(bvh, nodeIndex, result, resultLen);
+    }
+    else if (node->count > 0)
+    {
+        for (int i = node->first; i < node->first + node->count; ++i)
+        {
+            int item = bvh->items[i];
+            if (frustum_testAabb(*frustum, mins[item], maxs[item]))
+            {
+                result[(*resultLen)++] = item;
+            }
+        }
+    }
+    else
+    {
+        cullNode(bvh, frustum, mins, maxs, node->first, planeMask, result, resultLen);
+        cullNode(bvh, frustum, mins, maxs, node->first + 1, planeMask, result, resultLen);
+    }
+}
+
+// writes the items whose bounds touch the frustum to result, which needs room
+// for every item. returns how many there are
+int bvh_cullFrustum(bvh_t *bvh, frustum_t frustum, v3_t *mins, v3_t *maxs, int *result)
+{
+    int resultLen = 0;
+    if (bvh->itemsLen > 0)
+    {
+        cullNode(bvh, &frustum, mins, maxs, 0, (1 << FRUSTUM_PLANES_LEN) - 1, result, &resultLen);
+    }
+    return resultLen;
+}
+
+// slab test, the entry distance when the ray hits the box before maxDist
+static bool rayHitsBox(v3_t origin, v3_t invDir, v3_t min, v3_t max, float maxDist, float *entry)
+{
+    float t0 = (min.x - origin.x) * invDir.x;
+    float t1 = (max.x - origin.x) * invDir.x;
+    float tMin = fminf(t0, t1);
+    float tMax = fmaxf(t0, t1);
+    t0 = (min.y - origin.y) * invDir.y;
+    t1 = (max.y - origin.y) * invDir.y;
+    tMin = fmaxf(tMin, fminf(t0, t1));
+    tMax = fminf(tMax, fmaxf(t0, t1));
+    t0 = (min.z - origin.z) * invDir.z;
+    t1 = (max.z - origin.z) * invDir.z;
+    tMin = fmaxf(tMin, fminf(t0, t1));
+    tMax = fminf(tMax, fmaxf(t0, t1));
+
+    tMin = fmaxf(tMin, 0.0f);
+    *entry = tMin;
+    return tMin <= tMax && tMin < maxDist;
+}
+
+// the nearest item whose bounds the ray hits, or -1. for picking, hitDist gets
+// the distance along dir to the item's box
+int bvh_raycast(bvh_t *bvh, v3_t origin, v3_t dir, v3_t *mins, v3_t *maxs, float *hitDist)
+{
+    int hit = -1;
+    float best = INFINITY;
+    if (bvh->itemsLen == 0)
+    {
+        return hit;
+    }
+    // infinities from zero components are what the slab test expects
+    v3_t invDir = v3_create(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+
+    // each level leaves at most one sibling waiting
+    int stack[MAX_DEPTH + 2];
+    int stackLen = 0;
+    float entry;
+    if (rayHitsBox(origin, invDir, bvh->nodes[0].min, bvh->nodes[0].max, best, &entry))
+    {
+        stack[stackLen++] = 0;
+    }
+    while (stackLen > 0)
+    {
+        bvh_node_t *node = &bvh->nodes[stack[--stackLen]];
+        if (node->count > 0)
+        {
+            for (int i = node->first; i < node->first + node->count; ++i)
+            {
+                int item = bvh->items[i];
+                if (rayHitsBox(origin, invDir, mins[item], maxs[item], best, &entry))
+                {
+                    best = entry;
+                    hit = item;
+                }
+            }
+            continue;
+        }
+
+        // push the nearer child last so it's visited first, which shrinks best
+        // before the further one is reached
+        float entryA, entryB;
+        bool hitsA = rayHitsBox(origin, invDir, bvh->nodes[node->first].min, bvh->nodes[node->first].max, best, &entryA);
+        bool hitsB = rayHitsBox(origin, invDir, bvh->nodes[node->first + 1].min, bvh->nodes[node->first + 1].max, best, &entryB);
+        int near = node->first;
+        int far = node->first + 1;
+        if (hitsA && hitsB && entryB < entryA)
+        {
+            near = node->first + 1;
+            far = node->first;
+        }
+        if (hitsA && hitsB)
+        {
+            stack[stackLen++] = far;
+            stack[stackLen++] = near;
+        }
+        else if (hitsA)
+        {
+            stack[stackLen++] = node->first;
+        }
+        else if (hitsB)
+        {
+            stack[stackLen++] = node->first + 1;
+        }
+    }
+
+    if (hitDist != NULL)
+    {
+        *hitDist = best;
+    }
+    return hit;
+}
+
+void bvh_free(bvh_t bvh)
+{
+    free(bvh.nodes);
+    free(bvh.items);
+}
@@ -0,0 +1,38 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include "frustum.h"
+#include "v3.h"
+
+typedef struct bvh_node
+{
+    v3_t min;
+    // internal nodes: the first child, the second follows it. leaves: the
+    // first of their entries in items
+    int first;
+    v3_t max;
+    // items in a leaf, 0 for internal nodes
+    int count;
+} bvh_node_t;
+
+// bounding volume hierarchy over item AABBs. items are referred to by their
+// index in the bounds arrays passed to every call, the tree only keeps the order
+typedef struct bvh
+{
+    bvh_node_t *nodes;
+    int nodesLen;
+    int *items;
+    int itemsLen;
+} bvh_t;
+
+bvh_t bvh_build(v3_t *mins, v3_t *maxs, int len);
+
+void bvh_refit(bvh_t *bvh, v3_t *mins, v3_t *maxs, int numThreads);
+
+int bvh_cullFrustum(bvh_t *bvh, frustum_t frustum, v3_t *mins, v3_t *maxs, int *result);
+
+int bvh_raycast(bvh_t *bvh, v3_t origin, v3_t dir, v3_t *mins, v3_t *maxs, float *hitDist);
+
+void bvh_free(bvh_t bvh);
+
+#endif
@@ -0,0 +1,145 @@
+#include <math.h>
+#include <stdint.h>
+#include "frustum.h"
+
+#if defined(MAT4X4_SSE) || defined(MAT4X4_AVX)
+#include <immintrin.h>
+#endif
+#if defined(MAT4X4_NEON)
+#include <arm_neon.h>
+#endif
+
+// spheres per iteration of frustum_cullSpheres
+#if defined(MAT4X4_AVX)
+#define CULL_WIDTH 8
+#elif defined(MAT4X4_SSE) || (defined(MAT4X4_NEON) && defined(__aarch64__))
+#define CULL_WIDTH 4
+#else
+#define CULL_WIDTH 1
+#endif
+
+// the planes of the clip volume -w <= x, y, z <= w, pulled back through
+// viewProj (projection * view). each is a sum or difference of the w row and
+// another row
+frustum_t frustum_create(mat4x4_t viewProj)
+{
+    frustum_t result;
+    for (int i = 0; i < FRUSTUM_PLANES_LEN; ++i)
+    {
+        int row = i / 2;
+        float sign = i % 2 == 0 ? 1.0f : -1.0f;
+        float plane[4];
+        for (int col = 0; col < 4; ++col)
+        {
+            plane[col] = viewProj.m[3][col] + sign * viewProj.m[row][col];
+        }
+        // unit normals so distances are in world units, which the radii are
+        float invLen = 1.0f / sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        result.normals[i] = v3_create(plane[0] * invLen, plane[1] * invLen, plane[2] * invLen);
+        result.distances[i] = plane[3] * invLen;
+    }
+    return result;
+}
+
+bool frustum_testSphere(frustum_t frustum, v3_t center, float radius)
+{
+    for (int i = 0; i < FRUSTUM_PLANES_LEN; ++i)
+    {
+        if (v3_dot(frustum.normals[i], center) + frustum.distances[i] < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// only the corner furthest along each plane's normal needs testing
+bool frustum_testAabb(frustum_t frustum, v3_t min, v3_t max)
+{
+    for (int i = 0; i < FRUSTUM_PLANES_LEN; ++i)
+    {
+        v3_t n = frustum.normals[i];
+        v3_t corner = v3_create(n.x >= 0.0f ? max.x : min.x, n.y >= 0.0f ? max.y : min.y, n.z >= 0.0f ? max.z : min.z);
+        if (v3_dot(n, corner) + frustum.distances[i] < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// frustum_testSphere over a stream of spheres, a whole SIMD register of them
+// against each plane at a time. radii and isVisible need
+// v3stream_paddedLen(centers.len) entries. returns the number visible
+int frustum_cullSpheres(frustum_t frustum, v3stream_t centers, float *radii, unsigned char *isVisible)
+{
+    int len = centers.len;
+    int visibleLen = 0;
+    for (int i = 0; i < len; i += CULL_WIDTH)
+    {
+#if defined(MAT4X4_AVX)
+        __m256 x = _mm256_load_ps(centers.x + i);
+        __m256 y = _mm256_load_ps(centers.y + i);
+        __m256 z = _mm256_load_ps(centers.z + i);
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radii + i));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < FRUSTUM_PLANES_LEN; ++p)
+        {
+            __m256 d = _mm256_add_ps(
+                _mm256_add_ps(
+                    _mm256_mul_ps(x, _mm256_set1_ps(frustum.normals[p].x)),
+                    _mm256_mul_ps(y, _mm256_set1_ps(frustum.normals[p].y))),
+                _mm256_add_ps(
+                    _mm256_mul_ps(z, _mm256_set1_ps(frustum.normals[p].z)),
+                    _mm256_set1_ps(frustum.distances[p])));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negRadius, _CMP_GE_OQ));
+        }
+        int mask = _mm256_movemask_ps(inside);
+#elif defined(MAT4X4_SSE)
+        __m128 x = _mm_load_ps(centers.x + i);
+        __m128 y = _mm_load_ps(centers.y + i);
+        __m128 z = _mm_load_ps(centers.z + i);
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radii + i));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < FRUSTUM_PLANES_LEN; ++p)
+        {
+            __m128 d = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(x, _mm_set1_ps(frustum.normals[p].x)),
+                    _mm_mul_ps(y, _mm_set1_ps(frustum.normals[p].y))),
+                _mm_add_ps(
+                    _mm_mul_ps(z, _mm_set1_ps(frustum.normals[p].z)),
+                    _mm_set1_ps(frustum.distances[p])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negRadius));
+        }
+        int mask = _mm_movemask_ps(inside);
+#elif defined(MAT4X4_NEON) && defined(__aarch64__)
+        float32x4_t x = vld1q_f32(centers.x + i);
+        float32x4_t y = vld1q_f32(centers.y + i);
+        float32x4_t z = vld1q_f32(centers.z + i);
+        float32x4_t negRadius = vnegq_f32(vld1q_f32(radii + i));
+        uint32x4_t inside = vdupq_n_u32(0xffffffff);
+        for (int p = 0; p < FRUSTUM_PLANES_LEN; ++p)
+        {
+            float32x4_t d = vdupq_n_f32(frustum.distances[p]);
+            d = vmlaq_n_f32(d, x, frustum.normals[p].x);
+            d = vmlaq_n_f32(d, y, frustum.normals[p].y);
+            d = vmlaq_n_f32(d, z, frustum.normals[p].z);
+            inside = vandq_u32(inside, vcgeq_f32(d, negRadius));
+        }
+        // one bit per lane, like movemask
+        const uint32_t laneBits[4] = {1, 2, 4, 8};
+        int mask = (int)vaddvq_u32(vandq_u32(inside, vld1q_u32(laneBits)));
+#else
+        int mask = frustum_testSphere(frustum, v3stream_get(centers, i), radii[i]);
+#endif
+        // padded lanes are written but not counted
+        for (int lane = 0; lane < CULL_WIDTH; ++lane)
+        {
+            unsigned char laneVisible = (mask >> lane) & 1;
+            isVisible[i + lane] = laneVisible;
+            visibleLen += i + lane < len ? laneVisible : 0;
+        }
+    }
+    return visibleLen;
+}
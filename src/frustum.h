@@ -0,0 +1,36 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <stdbool.h>
+#include "mat4x4.h"
+#include "v3.h"
+#include "v3stream.h"
+
+enum frustum_plane
+{
+    FRUSTUM_LEFT,
+    FRUSTUM_RIGHT,
+    FRUSTUM_BOTTOM,
+    FRUSTUM_TOP,
+    FRUSTUM_NEAR,
+    FRUSTUM_FAR,
+    FRUSTUM_PLANES_LEN,
+};
+
+// world space planes facing inwards, p is inside when
+// dot(normals[i], p) + distances[i] >= 0 for every plane
+typedef struct frustum
+{
+    v3_t normals[FRUSTUM_PLANES_LEN];
+    float distances[FRUSTUM_PLANES_LEN];
+} frustum_t;
+
+frustum_t frustum_create(mat4x4_t viewProj);
+
+bool frustum_testSphere(frustum_t frustum, v3_t center, float radius);
+
+bool frustum_testAabb(frustum_t frustum, v3_t min, v3_t max);
+
+int frustum_cullSpheres(frustum_t frustum, v3stream_t centers, float *radii, unsigned char *isVisible);
+
+#endif
@@ -0,0 +1,95 @@
+#include <glad/glad.h>
+#include "glstate.h"
+#include "renderstats.h"
+
+#define MAX_TEXTURE_UNITS 16
+
+// the caps whose state is tracked, others always reach GL
+static const GLenum TRACKED_CAPS[] = {
+    GL_DEPTH_TEST,
+    GL_CULL_FACE,
+    GL_BLEND,
+    GL_STENCIL_TEST,
+    GL_SCISSOR_TEST,
+};
+static const int TRACKED_CAPS_LEN = sizeof(TRACKED_CAPS) / sizeof(TRACKED_CAPS[0]);
+
+// starts at the GL defaults, which are all zero
+static unsigned int currentProgram;
+static unsigned int currentVao;
+static int activeUnit;
+static unsigned int boundTextures[MAX_TEXTURE_UNITS];
+static bool enabledCaps[sizeof(TRACKED_CAPS) / sizeof(TRACKED_CAPS[0])];
+
+void glstate_useProgram(unsigned int program)
+{
+    if (program == currentProgram)
+    {
+        RENDERSTATS_COUNT_ELIDED_GL_CALLS(1);
+        return;
+    }
+    glUseProgram(program);
+    currentProgram = program;
+    RENDERSTATS_COUNT_GL_CALLS(1);
+}
+
+void glstate_bindVertexArray(unsigned int vao)
+{
+    if (vao == currentVao)
+    {
+        RENDERSTATS_COUNT_ELIDED_GL_CALLS(1);
+        return;
+    }
+    glBindVertexArray(vao);
+    currentVao = vao;
+    RENDERSTATS_COUNT_GL_CALLS(1);
+}
+
+// binds a 2D texture to unit, only switching the active unit when it has to
+void glstate_bindTexture(int unit, unsigned int texture)
+{
+    if (boundTextures[unit] == texture)
+    {
+        RENDERSTATS_COUNT_ELIDED_GL_CALLS(2);
+        return;
+    }
+    if (activeUnit != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+        RENDERSTATS_COUNT_GL_CALLS(1);
+    }
+    else
+    {
+        RENDERSTATS_COUNT_ELIDED_GL_CALLS(1);
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    boundTextures[unit] = texture;
+    RENDERSTATS_COUNT_GL_CALLS(1);
+}
+
+void glstate_setEnabled(unsigned int cap, bool isEnabled)
+{
+    for (int i = 0; i < TRACKED_CAPS_LEN; ++i)
+    {
+        if (TRACKED_CAPS[i] == cap)
+        {
+            if (enabledCaps[i] == isEnabled)
+            {
+                RENDERSTATS_COUNT_ELIDED_GL_CALLS(1);
+                return;
+            }
+            enabledCaps[i] = isEnabled;
+            break;
+        }
+    }
+    if (isEnabled)
+    {
+        glEnable(cap);
+    }
+    else
+    {
+        glDisable(cap);
+    }
+    RENDERSTATS_COUNT_GL_CALLS(1);
+}
@@ -0,0 +1,17 @@
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#include <stdbool.h>
+
+// shadows the GL binding state so redundant binds are never sent to the
+// driver. only correct while every program, VAO, texture and enable change
+// goes through here
+void glstate_useProgram(unsigned int program);
+
+void glstate_bindVertexArray(unsigned int vao);
+
+void glstate_bindTexture(int unit, unsigned int texture);
+
+void glstate_setEnabled(unsigned int cap, bool isEnabled);
+
+#endif
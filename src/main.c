@@ -8,11 +8,21 @@
 #include <stb/stb_image.h>
 #include "utils.h"
 #include "mat4x4.h"
+#include "mat3x4.h"
+#include "quat.h"
 #include "v3.h"
+#include "bvh.h"
 #include "camera.h"
+#include "frustum.h"
 #include "shader.h"
 #include "texture.h"
 #include "mesh.h"
+#include "meshcache.h"
+#include "mesharena.h"
+#include "renderqueue.h"
+#include "glstate.h"
+#include "renderstats.h"
+#include "ubo.h"
 
 static const int WINDOW_WIDTH = 800;
 static const int WINDOW_HEIGHT = 600;
@@ -20,6 +30,11 @@ static const float FOV = M_PI_2;
 static const float Z_NEAR = 0.1f;
 static const float Z_FAR = 100.0f;
 static const double MOUSE_SENSITIVITY = 0.002f;
+// draw every mesh at full detail when false, to compare triangles per frame
+static const bool USE_LODS = true;
+// the static crate wall, SCENERY_COLUMNS crates wide
+#define SCENERY_CRATES_LEN 24
+static const int SCENERY_COLUMNS = 8;
 
 static double lastMouseX = (double)WINDOW_WIDTH / 2.0;
 static double lastMouseY = (double)WINDOW_HEIGHT / 2.0;
@@ -69,6 +84,19 @@ void handleMouseMove(GLFWwindow *window, double xPos, double yPos)
     camera_turn(&playerCamera, dx * MOUSE_SENSITIVITY, dy * MOUSE_SENSITIVITY);
 }
 
+// world space boxes around the cubes' bounding spheres
+void calcCubeBounds(meshInstance_t *transforms, v3_t *scales, int len, mesh_t mesh, v3_t *mins, v3_t *maxs)
+{
+    for (int i = 0; i < len; ++i)
+    {
+        v3_t center = mat3x4_transformPoint(transforms[i].model, mesh.boundsCenter);
+        float radius = mesh.boundsRadius * scales[i].x;
+        v3_t extent = v3_create(radius, radius, radius);
+        mins[i] = v3_sub(center, extent);
+        maxs[i] = v3_add(center, extent);
+    }
+}
+
 int main(void)
 {
     //
@@ -101,40 +129,99 @@ int main(void)
         exit(EXIT_FAILURE);
     };
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    glstate_setEnabled(GL_DEPTH_TEST, true);
+    glstate_setEnabled(GL_CULL_FACE, true);
 
     stbi_set_flip_vertically_on_load(true);
     //
     // Create shader programs
     //
     shader_t objectShader = shader_create(
-        "./src/shaders/object.vs",
+        "./src/shaders/object_instanced.vs",
         "./src/shaders/object.fs");
+    ubo_bindBlocks(objectShader);
+    mesh_bindSamplers(objectShader);
+    mesh_uniforms_t objectUniforms = mesh_getUniforms(objectShader);
 
     v3_t cubePositions[] = {
-        v3_create(0.0f, 0.0f, 0.0f),
-        v3_create(2.0f, 5.0f, -15.0f),
-        v3_create(-1.5f, -2.2f, -2.5f),
-        v3_create(-3.8f, -2.0f, -12.3f),
-        v3_create(2.4f, -0.4f, -3.5f),
-        v3_create(-1.7f, 3.0f, -7.5f),
-        v3_create(1.3f, -2.0f, -2.5f),
-        v3_create(1.5f, 2.0f, -2.5f),
-        v3_create(1.5f, 0.2f, -1.5f),
-        v3_create(-1.3f, 1.0f, -1.5f),
+        V3_INIT(0.0f, 0.0f, 0.0f),
+        V3_INIT(2.0f, 5.0f, -15.0f),
+        V3_INIT(-1.5f, -2.2f, -2.5f),
+        V3_INIT(-3.8f, -2.0f, -12.3f),
+        V3_INIT(2.4f, -0.4f, -3.5f),
+        V3_INIT(-1.7f, 3.0f, -7.5f),
+        V3_INIT(1.3f, -2.0f, -2.5f),
+        V3_INIT(1.5f, 2.0f, -2.5f),
+        V3_INIT(1.5f, 0.2f, -1.5f),
+        V3_INIT(-1.3f, 1.0f, -1.5f),
     };
+    const int cubesLen = sizeof(cubePositions) / sizeof(cubePositions[0]);
+    quat_t cubeOrientations[cubesLen];
+    v3_t cubeScales[cubesLen];
+    // every cube's instance rows
+    meshInstance_t cubeTransforms[cubesLen];
+    v3_t cubeMins[cubesLen];
+    v3_t cubeMaxs[cubesLen];
+    int cubeVisible[cubesLen];
+    for (int i = 0; i < cubesLen; ++i)
+    {
+        cubeOrientations[i] = quat_createIdentity();
+        cubeScales[i] = v3_create(0.5f, 0.5f, 0.5f);
+    }
 
     // clang-format on
     //
     // Create mesh
     //
-    vertex_t *cubeVerts = utils_malloc(sizeof(vertex_t) * 128);
-    int numCubeVerts = mesh_loadVerts(&cubeVerts, "./assets/cube.obj");
+    meshcache_t cubeCache = meshcache_loadObj("./assets/cube.obj");
     texture_t diffuseMap = texture_load("./assets/container2.png", DIFFUSE);
     texture_t specularMap = texture_load("./assets/container2_specular.png", SPECULAR);
     texture_t meshTextures[] = {diffuseMap, specularMap};
-    mesh_t cubeMesh = mesh_create(cubeVerts, numCubeVerts, meshTextures, 2);
+    mesh_t cubeMesh = mesh_createPacked(
+        cubeCache.vertices, cubeCache.packedVertices, cubeCache.verticesLen, cubeCache.quantization,
+        cubeCache.indices, cubeCache.indicesLen,
+        meshTextures, 2);
+    mesh_generateLods(&cubeMesh, utils_getNumCores());
+    mesh_printStats(cubeMesh, "cube");
+    mesh_printQuantizationStats(cubeCache.vertices, cubeCache.verticesLen, "cube");
+    renderqueue_t renderQueue = renderqueue_create();
+
+    // a wall of crates behind the cubes that never moves, baked into an arena
+    // and drawn with one call
+    mesharena_t sceneryArena = mesharena_create(
+        SCENERY_CRATES_LEN * cubeCache.verticesLen, SCENERY_CRATES_LEN * cubeCache.indicesLen);
+    mesharena_range_t sceneryRanges[SCENERY_CRATES_LEN];
+    for (int i = 0; i < SCENERY_CRATES_LEN; ++i)
+    {
+        int column = i % SCENERY_COLUMNS;
+        int row = i / SCENERY_COLUMNS;
+        mat4x4_t model = mat4x4_composeTRS(
+            v3_create((column - SCENERY_COLUMNS / 2) * 2.0f, row * 2.0f - 3.0f, -25.0f),
+            v3_create(0.0f, 0.0f, 0.0f),
+            v3_create(1.0f, 1.0f, 1.0f));
+        sceneryRanges[i] = mesharena_add(
+            &sceneryArena,
+            cubeCache.vertices, cubeCache.verticesLen,
+            cubeCache.indices, cubeCache.indicesLen,
+            model);
+    }
+
+    // built once, then refit as the cubes move
+    for (int i = 0; i < cubesLen; ++i)
+    {
+        cubeTransforms[i] = mesh_createInstanceTRS(cubePositions[i], cubeOrientations[i], cubeScales[i]);
+    }
+    calcCubeBounds(cubeTransforms, cubeScales, cubesLen, cubeMesh, cubeMins, cubeMaxs);
+    bvh_t cubeBvh = bvh_build(cubeMins, cubeMaxs, cubesLen);
+
+    //
+    // Create uniform buffers
+    //
+    ubo_t perFrameUbo = ubo_create(UBO_PER_FRAME, sizeof(ubo_perFrame_t));
+    ubo_t lightsUbo = ubo_create(UBO_LIGHTS, sizeof(ubo_lights_t));
+    ubo_t materialUbo = ubo_create(UBO_MATERIAL, sizeof(ubo_material_t));
+    ubo_material_t material = {.shininess = 32.0f};
+    ubo_update(materialUbo, &material);
 
     // intialize globals
     playerCamera = camera_create(v3_create(0.0f, 0.0f, 3.0f), -M_PI_2, 0.0f);
@@ -154,9 +241,23 @@ int main(void)
         // inputs
         processInput(window);
 
-        // create transforms
-        mat4x4_t view = camera_getViewTransform(playerCamera);
-        mat4x4_t projection = mat4x4_createProj((float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, FOV, Z_NEAR, Z_FAR);
+        // per frame uniforms, uploaded once for every shader
+        ubo_perFrame_t perFrame = {
+            .view = camera_getViewTransform(playerCamera),
+            .projection = mat4x4_createProj((float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, FOV, Z_NEAR, Z_FAR),
+            .viewPos = playerCamera.pos,
+        };
+        ubo_update(perFrameUbo, &perFrame);
+
+        ubo_lights_t lights = {
+            .sunlight = {
+                .dir = sunlightDir,
+                .ambient = v3_mul(sunlightColor, 0.1f),
+                .diffuse = v3_mul(sunlightColor, 0.8f),
+                .specular = v3_mul(sunlightColor, 1.0f),
+            },
+        };
+        ubo_update(lightsUbo, &lights);
 
         // render
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -165,37 +266,41 @@ int main(void)
         //
         // draw cube
         //
-        shader_use(objectShader);
-
-        mat4x4_t objectModel = mat4x4_createIdentity();
-        objectModel = mat4x4_mul(objectModel, mat4x4_createTranslate(v3_create(0.0, -2.0, 0.0)));
-        objectModel = mat4x4_mul(objectModel, mat4x4_createRotX(glfwGetTime()));
-
-        shader_setMat4x4(objectShader, "model", objectModel);
-        shader_setMat4x4(objectShader, "view", view);
-        shader_setMat4x4(objectShader, "projection", projection);
-        shader_setV3(objectShader, "viewPos", playerCamera.pos);
-
-        // sunlight
-        shader_setV3(objectShader, "sunlight.dir", sunlightDir);
-        shader_setV3(objectShader, "sunlight.ambient", v3_mul(sunlightColor, 0.1f));
-        shader_setV3(objectShader, "sunlight.diffuse", v3_mul(sunlightColor, 0.8f));
-        shader_setV3(objectShader, "sunlight.specular", v3_mul(sunlightColor, 1.0f));
+        // the cubes spin about x. each frame's turn is composed onto their
+        // orientations, renormalized so rounding doesn't drift them off unit length
+        quat_t cubeSpin = quat_createAxisAngle(v3_create(1.0f, 0.0f, 0.0f), dt);
+        for (int i = 0; i < cubesLen; ++i)
+        {
+            cubeOrientations[i] = quat_normalize(quat_mul(cubeSpin, cubeOrientations[i]));
+            cubeTransforms[i] = mesh_createInstanceTRS(cubePositions[i], cubeOrientations[i], cubeScales[i]);
+        }
 
-        // materials
-        shader_setFloat(objectShader, "material.shininess", 32.0f);
+        // too few cubes for threads to pay off
+        calcCubeBounds(cubeTransforms, cubeScales, cubesLen, cubeMesh, cubeMins, cubeMaxs);
+        bvh_refit(&cubeBvh, cubeMins, cubeMaxs, 1);
 
-        for (int i = 0; i < 10; ++i)
+        frustum_t viewFrustum = frustum_create(mat4x4_mul(perFrame.projection, perFrame.view));
+        int cubeVisibleLen = bvh_cullFrustum(&cubeBvh, viewFrustum, cubeMins, cubeMaxs, cubeVisible);
+        // the queue draws each level of detail as one instanced draw
+        for (int i = 0; i < cubeVisibleLen; ++i)
         {
-            mat4x4_t objectModel = mat4x4_createIdentity();
-            objectModel = mat4x4_mul(objectModel, mat4x4_createTranslate(cubePositions[i]));
-            objectModel = mat4x4_mul(objectModel, mat4x4_createRotX(currentFrame));
-            objectModel = mat4x4_mul(objectModel, mat4x4_createScale(v3_create(0.5f, 0.5f, 0.5f)));
-            shader_setMat4x4(objectShader, "model", objectModel);
-            mesh_render(cubeMesh, objectShader);
+            int cube = cubeVisible[i];
+            float distance = v3_len(v3_sub(cubePositions[cube], playerCamera.pos));
+            int lod = USE_LODS ? mesh_selectLod(cubeMesh, distance, cubeScales[cube].x, (float)WINDOW_HEIGHT, FOV) : 0;
+            renderqueue_push(&renderQueue, RENDERQUEUE_OPAQUE, &cubeMesh, &objectShader, cubeTransforms[cube], lod, distance);
         }
+        renderqueue_sort(&renderQueue);
+        renderqueue_submit(&renderQueue);
+        renderqueue_clear(&renderQueue);
+
+        //
+        // draw scenery
+        //
+        shader_use(objectShader);
+        mesharena_draw(&sceneryArena, objectUniforms, meshTextures, 2, sceneryRanges, SCENERY_CRATES_LEN);
 
         // update
+        renderstats_endFrame(currentFrame);
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
@@ -0,0 +1,142 @@
+#include <string.h>
+#include "mat3x4.h"
+
+#if defined(MAT4X4_SSE)
+#include <immintrin.h>
+#endif
+#if defined(MAT4X4_NEON)
+#include <arm_neon.h>
+#endif
+
+mat3x4_t mat3x4_createIdentity(void)
+{
+    mat3x4_t result;
+    memset(&result, 0, sizeof(result));
+    result.m[0][0] = 1;
+    result.m[1][1] = 1;
+    result.m[2][2] = 1;
+    return result;
+}
+
+// translate * rotation * scale. rotation must be a unit quaternion
+mat3x4_t mat3x4_createTRS(v3_t translation, quat_t rotation, v3_t scale)
+{
+    quat_t q = rotation;
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    mat3x4_t result;
+
+    result.m[0][0] = (1.0f - 2.0f * (yy + zz)) * scale.x;
+    result.m[0][1] = 2.0f * (xy - wz) * scale.y;
+    result.m[0][2] = 2.0f * (xz + wy) * scale.z;
+    result.m[0][3] = translation.x;
+
+    result.m[1][0] = 2.0f * (xy + wz) * scale.x;
+    result.m[1][1] = (1.0f - 2.0f * (xx + zz)) * scale.y;
+    result.m[1][2] = 2.0f * (yz - wx) * scale.z;
+    result.m[1][3] = translation.y;
+
+    result.m[2][0] = 2.0f * (xz - wy) * scale.x;
+    result.m[2][1] = 2.0f * (yz + wx) * scale.y;
+    result.m[2][2] = (1.0f - 2.0f * (xx + yy)) * scale.z;
+    result.m[2][3] = translation.z;
+
+    return result;
+}
+
+mat3x4_t mat3x4_mul(mat3x4_t a, mat3x4_t b)
+{
+    mat3x4_t result;
+
+#if defined(MAT4X4_SSE)
+    // as mat4x4_mul, with b's implicit bottom row only adding a's translation
+    __m128 b0 = _mm_load_ps(b.m[0]);
+    __m128 b1 = _mm_load_ps(b.m[1]);
+    __m128 b2 = _mm_load_ps(b.m[2]);
+    __m128 b3 = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+    for (int row = 0; row < 3; row++)
+    {
+        __m128 aRow = _mm_load_ps(a.m[row]);
+        __m128 r = _mm_mul_ps(_mm_shuffle_ps(aRow, aRow, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(aRow, aRow, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(aRow, aRow, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(aRow, aRow, _MM_SHUFFLE(3, 3, 3, 3)), b3));
+        _mm_store_ps(result.m[row], r);
+    }
+#elif defined(MAT4X4_NEON)
+    float32x4_t b0 = vld1q_f32(b.m[0]);
+    float32x4_t b1 = vld1q_f32(b.m[1]);
+    float32x4_t b2 = vld1q_f32(b.m[2]);
+    for (int row = 0; row < 3; row++)
+    {
+        float32x4_t r = vmulq_n_f32(b0, a.m[row][0]);
+        r = vmlaq_n_f32(r, b1, a.m[row][1]);
+        r = vmlaq_n_f32(r, b2, a.m[row][2]);
+        vst1q_f32(result.m[row], vsetq_lane_f32(vgetq_lane_f32(r, 3) + a.m[row][3], r, 3));
+    }
+#else
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 4; col++)
+        {
+            result.m[row][col] = a.m[row][0] * b.m[0][col] + a.m[row][1] * b.m[1][col] + a.m[row][2] * b.m[2][col];
+        }
+        result.m[row][3] += a.m[row][3];
+    }
+#endif
+
+    return result;
+}
+
+// general affine inverse, the 3x3 part is inverted by cofactors and the
+// translation is moved back through it
+mat3x4_t mat3x4_inverse(mat3x4_t a)
+{
+    float (*m)[4] = a.m;
+    float c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+    float c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+    float c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+    float invDet = 1.0f / (m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02);
+    mat3x4_t result;
+
+    result.m[0][0] = c00 * invDet;
+    result.m[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * invDet;
+    result.m[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * invDet;
+
+    result.m[1][0] = c01 * invDet;
+    result.m[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * invDet;
+    result.m[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * invDet;
+
+    result.m[2][0] = c02 * invDet;
+    result.m[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * invDet;
+    result.m[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * invDet;
+
+    for (int row = 0; row < 3; row++)
+    {
+        result.m[row][3] = -(result.m[row][0] * m[0][3] + result.m[row][1] * m[1][3] + result.m[row][2] * m[2][3]);
+    }
+
+    return result;
+}
+
+v3_t mat3x4_transformPoint(mat3x4_t a, v3_t p)
+{
+    v3_t result;
+    result.x = a.m[0][0] * p.x + a.m[0][1] * p.y + a.m[0][2] * p.z + a.m[0][3];
+    result.y = a.m[1][0] * p.x + a.m[1][1] * p.y + a.m[1][2] * p.z + a.m[1][3];
+    result.z = a.m[2][0] * p.x + a.m[2][1] * p.y + a.m[2][2] * p.z + a.m[2][3];
+    return result;
+}
+
+// only needed at upload time, everything else can stay in 3x4
+mat4x4_t mat3x4_toMat4x4(mat3x4_t a)
+{
+    mat4x4_t result;
+    memcpy(result.m, a.m, sizeof(a.m));
+    result.m[3][0] = 0;
+    result.m[3][1] = 0;
+    result.m[3][2] = 0;
+    result.m[3][3] = 1;
+    return result;
+}
@@ -0,0 +1,27 @@
+#ifndef MAT3X4_H
+#define MAT3X4_H
+
+#include "v3.h"
+#include "quat.h"
+#include "mat4x4.h"
+
+// affine transform stored as the top 3 rows of a row major mat4x4, the
+// bottom row is always (0, 0, 0, 1). 48 bytes instead of 64
+typedef struct mat3x4
+{
+    _Alignas(16) float m[3][4];
+} mat3x4_t;
+
+mat3x4_t mat3x4_createIdentity(void);
+
+mat3x4_t mat3x4_createTRS(v3_t translation, quat_t rotation, v3_t scale);
+
+mat3x4_t mat3x4_mul(mat3x4_t a, mat3x4_t b);
+
+mat3x4_t mat3x4_inverse(mat3x4_t a);
+
+v3_t mat3x4_transformPoint(mat3x4_t a, v3_t p);
+
+mat4x4_t mat3x4_toMat4x4(mat3x4_t a);
+
+#endif
@@ -1,241 +1,428 @@
 #include <stdlib.h>
 #include <math.h>
 #include "mat4x4.h"
+#ifndef MATH_HEADER_ONLY
+#include "mat4x4inline.h"
+#endif
+
+#if defined(MAT4X4_SSE) || defined(MAT4X4_AVX)
+#include <immintrin.h>
+#endif
+#if defined(MAT4X4_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(MAT4X4_SSE)
+#define SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define SWIZZLE(a, x, y, z, w) SHUFFLE(a, a, x, y, z, w)
+
+// 2x2 row major matrices packed in one register, as used by the block inverse
+// A * B
+static inline __m128 mat2Mul(__m128 a, __m128 b)
+{
+    return _mm_add_ps(
+        _mm_mul_ps(a, SWIZZLE(b, 0, 3, 0, 3)),
+        _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
 
-mat4x4_t mat4x4_mul(mat4x4_t a, mat4x4_t b)
+// adj(A) * B
+static inline __m128 mat2AdjMul(__m128 a, __m128 b)
 {
-    mat4x4_t result;
+    return _mm_sub_ps(
+        _mm_mul_ps(SWIZZLE(a, 3, 3, 0, 0), b),
+        _mm_mul_ps(SWIZZLE(a, 1, 1, 2, 2), SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// A * adj(B)
+static inline __m128 mat2MulAdj(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(
+        _mm_mul_ps(a, SWIZZLE(b, 3, 0, 3, 0)),
+        _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// cross product of the xyz lanes, w comes out as 0 when both inputs have w = 0
+static inline __m128 cross3(__m128 a, __m128 b)
+{
+    __m128 aYZX = SWIZZLE(a, 1, 2, 0, 3);
+    __m128 bYZX = SWIZZLE(b, 1, 2, 0, 3);
+    __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+    return SWIZZLE(c, 1, 2, 0, 3);
+}
+
+// past this the quadrant needs more bits than the exact products in sinCos4's
+// reduction leave room for
+#define SIN_COS_MAX_ANGLE 8192.0f
 
-    for (int row = 0; row < 4; row++)
+// sine and cosine of 4 angles. the angles are reduced to [-pi/4, pi/4] by
+// quadrant and fed to taylor polynomials. the reduction subtracts pi/2 in three
+// parts, the first two short enough that their products with the quadrant are
+// exact, so results stay within a couple of ulps of sinf and cosf up to
+// SIN_COS_MAX_ANGLE. larger angles go through libm
+static inline void sinCos4(__m128 x, __m128 *sinResult, __m128 *cosResult)
+{
+    // not less or equal, so NaNs take the libm path too
+    __m128 absX = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+    if (_mm_movemask_ps(_mm_cmpnle_ps(absX, _mm_set1_ps(SIN_COS_MAX_ANGLE))) != 0)
     {
-        for (int col = 0; col < 4; col++)
+        _Alignas(16) float angles[4];
+        _Alignas(16) float sines[4];
+        _Alignas(16) float cosines[4];
+        _mm_store_ps(angles, x);
+        for (int i = 0; i < 4; ++i)
         {
-            result.m[row][col] = a.m[row][0] * b.m[0][col] + a.m[row][1] * b.m[1][col] + a.m[row][2] * b.m[2][col] + a.m[row][3] * b.m[3][col];
+            sines[i] = sinf(angles[i]);
+            cosines[i] = cosf(angles[i]);
         }
+        *sinResult = _mm_load_ps(sines);
+        *cosResult = _mm_load_ps(cosines);
+        return;
     }
 
-    return result;
+    __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(2.0f / M_PI)));
+    __m128 q = _mm_cvtepi32_ps(quadrant);
+    // pi/2 = 1.5703125 + 4.837512969970703125e-4 + 7.549790126404332e-8, the
+    // first two have 8 and 11 significant bits and the quadrant at most 13
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(7.549790126404332e-8f)));
+    __m128 r2 = _mm_mul_ps(r, r);
+
+    __m128 s = _mm_add_ps(_mm_set1_ps(-1.0f / 5040.0f), _mm_mul_ps(r2, _mm_set1_ps(1.0f / 362880.0f)));
+    s = _mm_add_ps(_mm_set1_ps(1.0f / 120.0f), _mm_mul_ps(r2, s));
+    s = _mm_add_ps(_mm_set1_ps(-1.0f / 6.0f), _mm_mul_ps(r2, s));
+    s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), s));
+
+    __m128 c = _mm_add_ps(_mm_set1_ps(-1.0f / 720.0f), _mm_mul_ps(r2, _mm_set1_ps(1.0f / 40320.0f)));
+    c = _mm_add_ps(_mm_set1_ps(1.0f / 24.0f), _mm_mul_ps(r2, c));
+    c = _mm_add_ps(_mm_set1_ps(-0.5f), _mm_mul_ps(r2, c));
+    c = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(r2, c));
+
+    // odd quadrants swap sin and cos, the sign bits come from the quadrant's bit 1
+    __m128i one = _mm_set1_epi32(1);
+    __m128i two = _mm_set1_epi32(2);
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+    __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+    __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+    *sinResult = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sinSign);
+    *cosResult = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosSign);
 }
+#endif
 
-mat4x4_t mat4x4_createIdentity()
+// general inverse. a singular matrix gives non-finite values
+mat4x4_t mat4x4_inverse(mat4x4_t a)
 {
     mat4x4_t result;
 
-    result.m[0][0] = 1;
-    result.m[0][1] = 0;
-    result.m[0][2] = 0;
-    result.m[0][3] = 0;
-
-    result.m[1][0] = 0;
-    result.m[1][1] = 1;
-    result.m[1][2] = 0;
-    result.m[1][3] = 0;
-
-    result.m[2][0] = 0;
-    result.m[2][1] = 0;
-    result.m[2][2] = 1;
-    result.m[2][3] = 0;
-
-    result.m[3][0] = 0;
-    result.m[3][1] = 0;
-    result.m[3][2] = 0;
-    result.m[3][3] = 1;
+#if defined(MAT4X4_SSE)
+    // block inverse over the 2x2 sub matrices M = | A B |
+    //                                             | C D |
+    // each 2x2 block is held row major in one register
+    __m128 r0 = _mm_load_ps(a.m[0]);
+    __m128 r1 = _mm_load_ps(a.m[1]);
+    __m128 r2 = _mm_load_ps(a.m[2]);
+    __m128 r3 = _mm_load_ps(a.m[3]);
+
+    __m128 blockA = _mm_movelh_ps(r0, r1);
+    __m128 blockB = _mm_movehl_ps(r1, r0);
+    __m128 blockC = _mm_movelh_ps(r2, r3);
+    __m128 blockD = _mm_movehl_ps(r3, r2);
+
+    // (|A|, |B|, |C|, |D|)
+    __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(SHUFFLE(r0, r2, 0, 2, 0, 2), SHUFFLE(r1, r3, 1, 3, 1, 3)),
+        _mm_mul_ps(SHUFFLE(r0, r2, 1, 3, 1, 3), SHUFFLE(r1, r3, 0, 2, 0, 2)));
+    __m128 detA = SWIZZLE(detSub, 0, 0, 0, 0);
+    __m128 detB = SWIZZLE(detSub, 1, 1, 1, 1);
+    __m128 detC = SWIZZLE(detSub, 2, 2, 2, 2);
+    __m128 detD = SWIZZLE(detSub, 3, 3, 3, 3);
+
+    __m128 adjDC = mat2AdjMul(blockD, blockC);
+    __m128 adjAB = mat2AdjMul(blockA, blockB);
+    __m128 adjX = _mm_sub_ps(_mm_mul_ps(detD, blockA), mat2Mul(blockB, adjDC));
+    __m128 adjW = _mm_sub_ps(_mm_mul_ps(detA, blockD), mat2Mul(blockC, adjAB));
+    __m128 adjY = _mm_sub_ps(_mm_mul_ps(detB, blockC), mat2MulAdj(blockD, adjAB));
+    __m128 adjZ = _mm_sub_ps(_mm_mul_ps(detC, blockB), mat2MulAdj(blockA, adjDC));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    __m128 trace = _mm_mul_ps(adjAB, SWIZZLE(adjDC, 0, 2, 1, 3));
+    trace = _mm_add_ps(trace, SWIZZLE(trace, 2, 3, 0, 1));
+    trace = _mm_add_ps(trace, SWIZZLE(trace, 1, 0, 3, 2));
+    __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+    __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+    adjX = _mm_mul_ps(adjX, invDet);
+    adjY = _mm_mul_ps(adjY, invDet);
+    adjZ = _mm_mul_ps(adjZ, invDet);
+    adjW = _mm_mul_ps(adjW, invDet);
+
+    // the final adjugate swizzle is folded into the stores
+    _mm_store_ps(result.m[0], SHUFFLE(adjX, adjY, 3, 1, 3, 1));
+    _mm_store_ps(result.m[1], SHUFFLE(adjX, adjY, 2, 0, 2, 0));
+    _mm_store_ps(result.m[2], SHUFFLE(adjZ, adjW, 3, 1, 3, 1));
+    _mm_store_ps(result.m[3], SHUFFLE(adjZ, adjW, 2, 0, 2, 0));
+#else
+    // cofactor expansion via the 2x2 sub determinants of the top and bottom rows
+    float *m = &a.m[0][0];
+    float s0 = m[0] * m[5] - m[4] * m[1];
+    float s1 = m[0] * m[6] - m[4] * m[2];
+    float s2 = m[0] * m[7] - m[4] * m[3];
+    float s3 = m[1] * m[6] - m[5] * m[2];
+    float s4 = m[1] * m[7] - m[5] * m[3];
+    float s5 = m[2] * m[7] - m[6] * m[3];
+
+    float c5 = m[10] * m[15] - m[14] * m[11];
+    float c4 = m[9] * m[15] - m[13] * m[11];
+    float c3 = m[9] * m[14] - m[13] * m[10];
+    float c2 = m[8] * m[15] - m[12] * m[11];
+    float c1 = m[8] * m[14] - m[12] * m[10];
+    float c0 = m[8] * m[13] - m[12] * m[9];
+
+    float invDet = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+    float *r = &result.m[0][0];
+
+    r[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) * invDet;
+    r[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * invDet;
+    r[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) * invDet;
+    r[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * invDet;
+
+    r[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * invDet;
+    r[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) * invDet;
+    r[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * invDet;
+    r[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) * invDet;
+
+    r[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) * invDet;
+    r[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * invDet;
+    r[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) * invDet;
+    r[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * invDet;
+
+    r[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * invDet;
+    r[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) * invDet;
+    r[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * invDet;
+    r[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) * invDet;
+#endif
 
     return result;
 }
 
-mat4x4_t mat4x4_createScale(v3_t s)
+// inverse transpose of the upper 3x3, for transforming normals. the rest of
+// the result is identity
+mat4x4_t mat4x4_normalMatrix(mat4x4_t a)
 {
     mat4x4_t result;
 
-    result.m[0][0] = s.x;
-    result.m[0][1] = 0;
-    result.m[0][2] = 0;
-    result.m[0][3] = 0;
-
-    result.m[1][0] = 0;
-    result.m[1][1] = s.y;
-    result.m[1][2] = 0;
-    result.m[1][3] = 0;
-
-    result.m[2][0] = 0;
-    result.m[2][1] = 0;
-    result.m[2][2] = s.z;
-    result.m[2][3] = 0;
+#if defined(MAT4X4_SSE)
+    // the inverse transpose's rows are the cross products of a's rows over the
+    // determinant, the translation lane is masked off
+    __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    __m128 r0 = _mm_and_ps(_mm_load_ps(a.m[0]), mask);
+    __m128 r1 = _mm_and_ps(_mm_load_ps(a.m[1]), mask);
+    __m128 r2 = _mm_and_ps(_mm_load_ps(a.m[2]), mask);
+    __m128 c0 = cross3(r1, r2);
+    __m128 c1 = cross3(r2, r0);
+    __m128 c2 = cross3(r0, r1);
+
+    __m128 det = _mm_mul_ps(r0, c0);
+    det = _mm_add_ps(det, SWIZZLE(det, 1, 0, 3, 2));
+    det = _mm_add_ps(det, SWIZZLE(det, 2, 3, 0, 1));
+    __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+    _mm_store_ps(result.m[0], _mm_mul_ps(c0, invDet));
+    _mm_store_ps(result.m[1], _mm_mul_ps(c1, invDet));
+    _mm_store_ps(result.m[2], _mm_mul_ps(c2, invDet));
+    _mm_store_ps(result.m[3], _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+#else
+    v3_t r[3];
+    for (int row = 0; row < 3; row++)
+    {
+        r[row] = v3_create(a.m[row][0], a.m[row][1], a.m[row][2]);
+    }
+    v3_t c[3] = {v3_cross(r[1], r[2]), v3_cross(r[2], r[0]), v3_cross(r[0], r[1])};
+    float invDet = 1.0f / v3_dot(r[0], c[0]);
 
-    result.m[3][0] = 0;
-    result.m[3][1] = 0;
-    result.m[3][2] = 0;
-    result.m[3][3] = 1;
+    result = mat4x4_createIdentity();
+    for (int row = 0; row < 3; row++)
+    {
+        result.m[row][0] = c[row].x * invDet;
+        result.m[row][1] = c[row].y * invDet;
+        result.m[row][2] = c[row].z * invDet;
+    }
+#endif
 
     return result;
 }
 
-mat4x4_t mat4x4_createRotX(float theta)
+// mat4x4_normalMatrix for transforms known to be a rotation and a uniform scale,
+// where the inverse transpose is just the upper 3x3 over the squared scale
+mat4x4_t mat4x4_normalMatrixUniform(mat4x4_t a)
 {
-    mat4x4_t result;
-
-    result.m[0][0] = 1;
-    result.m[0][1] = 0;
-    result.m[0][2] = 0;
-    result.m[0][3] = 0;
-
-    result.m[1][0] = 0;
-    result.m[1][1] = cosf(theta);
-    result.m[1][2] = -sinf(theta);
-    result.m[1][3] = 0;
-
-    result.m[2][0] = 0;
-    result.m[2][1] = sinf(theta);
-    result.m[2][2] = cosf(theta);
-    result.m[2][3] = 0;
-
-    result.m[3][0] = 0;
-    result.m[3][1] = 0;
-    result.m[3][2] = 0;
-    result.m[3][3] = 1;
-
+    float invScaleSq = 1.0f / (a.m[0][0] * a.m[0][0] + a.m[0][1] * a.m[0][1] + a.m[0][2] * a.m[0][2]);
+    mat4x4_t result = mat4x4_createIdentity();
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            result.m[row][col] = a.m[row][col] * invScaleSq;
+        }
+    }
     return result;
 }
 
-mat4x4_t mat4x4_createRotY(float theta)
+// mat4x4_transformPoint over an array. points and result may be the same array
+void mat4x4_transformPoints(mat4x4_t a, v3_t *points, v3_t *result, int len)
 {
-    mat4x4_t result;
-
-    result.m[0][0] = cosf(theta);
-    result.m[0][1] = 0;
-    result.m[0][2] = sinf(theta);
-    result.m[0][3] = 0;
-
-    result.m[1][0] = 0;
-    result.m[1][1] = 1;
-    result.m[1][2] = 0;
-    result.m[1][3] = 0;
-
-    result.m[2][0] = -sinf(theta);
-    result.m[2][1] = 0;
-    result.m[2][2] = cosf(theta);
-    result.m[2][3] = 0;
-
-    result.m[3][0] = 0;
-    result.m[3][1] = 0;
-    result.m[3][2] = 0;
-    result.m[3][3] = 1;
-
-    return result;
+#if defined(MAT4X4_SSE)
+    // with the matrix transposed each point is a sum of its columns
+    mat4x4_t columns = mat4x4_transpose(a);
+    __m128 c0 = _mm_load_ps(columns.m[0]);
+    __m128 c1 = _mm_load_ps(columns.m[1]);
+    __m128 c2 = _mm_load_ps(columns.m[2]);
+    __m128 c3 = _mm_load_ps(columns.m[3]);
+    for (int i = 0; i < len; ++i)
+    {
+        v3_t p = points[i];
+        __m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), c0), c3);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(p.y), c1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(p.z), c2));
+        _Alignas(16) float out[4];
+        _mm_store_ps(out, r);
+        result[i] = v3_create(out[0], out[1], out[2]);
+    }
+#elif defined(MAT4X4_NEON)
+    mat4x4_t columns = mat4x4_transpose(a);
+    float32x4_t c0 = vld1q_f32(columns.m[0]);
+    float32x4_t c1 = vld1q_f32(columns.m[1]);
+    float32x4_t c2 = vld1q_f32(columns.m[2]);
+    float32x4_t c3 = vld1q_f32(columns.m[3]);
+    for (int i = 0; i < len; ++i)
+    {
+        v3_t p = points[i];
+        float32x4_t r = vmlaq_n_f32(c3, c0, p.x);
+        r = vmlaq_n_f32(r, c1, p.y);
+        r = vmlaq_n_f32(r, c2, p.z);
+        result[i] = v3_create(vgetq_lane_f32(r, 0), vgetq_lane_f32(r, 1), vgetq_lane_f32(r, 2));
+    }
+#else
+    for (int i = 0; i < len; ++i)
+    {
+        result[i] = mat4x4_transformPoint(a, points[i]);
+    }
+#endif
 }
 
-mat4x4_t mat4x4_createRotZ(float theta)
+#if defined(MAT4X4_AVX)
+// the same row of two matrices, one per 128 bit lane
+static inline __m256 loadRowPair(mat4x4_t *a, int row)
 {
-    mat4x4_t result;
-
-    result.m[0][0] = cosf(theta);
-    result.m[0][1] = -sinf(theta);
-    result.m[0][2] = 0;
-    result.m[0][3] = 0;
-
-    result.m[1][0] = sinf(theta);
-    result.m[1][1] = cosf(theta);
-    result.m[1][2] = 0;
-    result.m[1][3] = 0;
-
-    result.m[2][0] = 0;
-    result.m[2][1] = 0;
-    result.m[2][2] = 1;
-    result.m[2][3] = 0;
-
-    result.m[3][0] = 0;
-    result.m[3][1] = 0;
-    result.m[3][2] = 0;
-    result.m[3][3] = 1;
-
-    return result;
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(a[0].m[row])), _mm_load_ps(a[1].m[row]), 1);
 }
 
-mat4x4_t mat4x4_createTranslate(v3_t t)
+static inline void storeRowPair(mat4x4_t *a, int row, __m256 rows)
 {
-    mat4x4_t result;
-
-    result.m[0][0] = 1;
-    result.m[0][1] = 0;
-    result.m[0][2] = 0;
-    result.m[0][3] = t.x;
-
-    result.m[1][0] = 0;
-    result.m[1][1] = 1;
-    result.m[1][2] = 0;
-    result.m[1][3] = t.y;
-
-    result.m[2][0] = 0;
-    result.m[2][1] = 0;
-    result.m[2][2] = 1;
-    result.m[2][3] = t.z;
-
-    result.m[3][0] = 0;
-    result.m[3][1] = 0;
-    result.m[3][2] = 0;
-    result.m[3][3] = 1;
-
-    return result;
+    _mm_store_ps(a[0].m[row], _mm256_castps256_ps128(rows));
+    _mm_store_ps(a[1].m[row], _mm256_extractf128_ps(rows, 1));
 }
+#endif
 
-mat4x4_t mat4x4_createProj(float aspectRatio, float fov, float zNear, float zFar)
+// result[i] = a[i] * b[i]. result may alias either input
+void mat4x4_mulBatch(mat4x4_t *a, mat4x4_t *b, mat4x4_t *result, int len)
 {
-    float right = zNear * tanf(fov / 2.0f);
-    float top = right / aspectRatio;
-
-    mat4x4_t result;
-
-    result.m[0][0] = zNear / right;
-    result.m[0][1] = 0;
-    result.m[0][2] = 0;
-    result.m[0][3] = 0;
+    int i = 0;
 
-    result.m[1][0] = 0;
-    result.m[1][1] = zNear / top;
-    result.m[1][2] = 0;
-    result.m[1][3] = 0;
-
-    result.m[2][0] = 0;
-    result.m[2][1] = 0;
-    result.m[2][2] = -(zFar + zNear) / (zFar - zNear);
-    result.m[2][3] = (-2 * zFar * zNear) / (zFar - zNear);
-
-    result.m[3][0] = 0;
-    result.m[3][1] = 0;
-    result.m[3][2] = -1;
-    result.m[3][3] = 0;
+#if defined(MAT4X4_AVX)
+    // 2 objects at a time, one per 128 bit lane. the element broadcasts stay
+    // within a lane, so each object's row is scaled by its own elements
+    for (; i + 2 <= len; i += 2)
+    {
+        __m256 b0 = loadRowPair(b + i, 0);
+        __m256 b1 = loadRowPair(b + i, 1);
+        __m256 b2 = loadRowPair(b + i, 2);
+        __m256 b3 = loadRowPair(b + i, 3);
+        for (int row = 0; row < 4; row++)
+        {
+            __m256 aRows = loadRowPair(a + i, row);
+            __m256 r = _mm256_mul_ps(_mm256_permute_ps(aRows, 0x00), b0);
+            r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(aRows, 0x55), b1));
+            r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(aRows, 0xaa), b2));
+            r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(aRows, 0xff), b3));
+            // a's later rows are still unread, but a result row only overwrites
+            // the row of a it was computed from
+            storeRowPair(result + i, row, r);
+        }
+    }
+#endif
 
-    return result;
+    for (; i < len; ++i)
+    {
+        result[i] = mat4x4_mul(a[i], b[i]);
+    }
 }
 
-mat4x4_t mat4x4_createLookAt(v3_t pos, v3_t target, v3_t worldUp)
+// mat4x4_composeTRS over arrays of objects
+void mat4x4_composeTRSBatch(v3_t *translations, v3_t *rotations, v3_t *scales, mat4x4_t *result, int len)
 {
-    v3_t direction = v3_normalize(v3_sub(pos, target));
-    v3_t right = v3_normalize(v3_cross(worldUp, direction));
-    v3_t up = v3_cross(direction, right);
-
-    mat4x4_t result;
-
-    result.m[0][0] = right.x;
-    result.m[0][1] = right.y;
-    result.m[0][2] = right.z;
-    result.m[0][3] = right.x * -pos.x + right.y * -pos.y + right.z * -pos.z;
-
-    result.m[1][0] = up.x;
-    result.m[1][1] = up.y;
-    result.m[1][2] = up.z;
-    result.m[1][3] = up.x * -pos.x + up.y * -pos.y + up.z * -pos.z;
+    int i = 0;
 
-    result.m[2][0] = direction.x;
-    result.m[2][1] = direction.y;
-    result.m[2][2] = direction.z;
-    result.m[2][3] = direction.x * -pos.x + direction.y * -pos.y + direction.z * -pos.z;
-
-    result.m[3][0] = 0;
-    result.m[3][1] = 0;
-    result.m[3][2] = 0;
-    result.m[3][3] = 1;
+#if defined(MAT4X4_SSE)
+    // 4 objects at a time, one per lane
+    __m128 lastRow = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+    for (; i + 4 <= len; i += 4)
+    {
+        v3_t *t = translations + i;
+        v3_t *r = rotations + i;
+        v3_t *s = scales + i;
+
+        __m128 sx, cx, sy, cy, sz, cz;
+        sinCos4(_mm_setr_ps(r[0].x, r[1].x, r[2].x, r[3].x), &sx, &cx);
+        sinCos4(_mm_setr_ps(r[0].y, r[1].y, r[2].y, r[3].y), &sy, &cy);
+        sinCos4(_mm_setr_ps(r[0].z, r[1].z, r[2].z, r[3].z), &sz, &cz);
+        __m128 scaleX = _mm_setr_ps(s[0].x, s[1].x, s[2].x, s[3].x);
+        __m128 scaleY = _mm_setr_ps(s[0].y, s[1].y, s[2].y, s[3].y);
+        __m128 scaleZ = _mm_setr_ps(s[0].z, s[1].z, s[2].z, s[3].z);
+        __m128 czsy = _mm_mul_ps(cz, sy);
+        __m128 szsy = _mm_mul_ps(sz, sy);
+
+        __m128 m00 = _mm_mul_ps(_mm_mul_ps(cz, cy), scaleX);
+        __m128 m01 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(czsy, sx), _mm_mul_ps(sz, cx)), scaleY);
+        __m128 m02 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(czsy, cx), _mm_mul_ps(sz, sx)), scaleZ);
+        __m128 m03 = _mm_setr_ps(t[0].x, t[1].x, t[2].x, t[3].x);
+
+        __m128 m10 = _mm_mul_ps(_mm_mul_ps(sz, cy), scaleX);
+        __m128 m11 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(szsy, sx), _mm_mul_ps(cz, cx)), scaleY);
+        __m128 m12 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(szsy, cx), _mm_mul_ps(cz, sx)), scaleZ);
+        __m128 m13 = _mm_setr_ps(t[0].y, t[1].y, t[2].y, t[3].y);
+
+        __m128 m20 = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(sy, scaleX));
+        __m128 m21 = _mm_mul_ps(_mm_mul_ps(cy, sx), scaleY);
+        __m128 m22 = _mm_mul_ps(_mm_mul_ps(cy, cx), scaleZ);
+        __m128 m23 = _mm_setr_ps(t[0].z, t[1].z, t[2].z, t[3].z);
+
+        // each register holds one element for 4 objects, transposing turns
+        // them into one row for each object
+        _MM_TRANSPOSE4_PS(m00, m01, m02, m03);
+        _MM_TRANSPOSE4_PS(m10, m11, m12, m13);
+        _MM_TRANSPOSE4_PS(m20, m21, m22, m23);
+        _mm_store_ps(result[i].m[0], m00);
+        _mm_store_ps(result[i].m[1], m10);
+        _mm_store_ps(result[i].m[2], m20);
+        _mm_store_ps(result[i].m[3], lastRow);
+        _mm_store_ps(result[i + 1].m[0], m01);
+        _mm_store_ps(result[i + 1].m[1], m11);
+        _mm_store_ps(result[i + 1].m[2], m21);
+        _mm_store_ps(result[i + 1].m[3], lastRow);
+        _mm_store_ps(result[i + 2].m[0], m02);
+        _mm_store_ps(result[i + 2].m[1], m12);
+        _mm_store_ps(result[i + 2].m[2], m22);
+        _mm_store_ps(result[i + 2].m[3], lastRow);
+        _mm_store_ps(result[i + 3].m[0], m03);
+        _mm_store_ps(result[i + 3].m[1], m13);
+        _mm_store_ps(result[i + 3].m[2], m23);
+        _mm_store_ps(result[i + 3].m[3], lastRow);
+    }
+#endif
 
-    return result;
-}
\ No newline at end of file
+    for (; i < len; ++i)
+    {
+        result[i] = mat4x4_composeTRS(translations[i], rotations[i], scales[i]);
+    }
+}
@@ -2,28 +2,75 @@
 #define MAT4X4_H
 
 #include "v3.h"
+#include "mathinline.h"
 
+// SIMD kernels are picked at compile time from the target's instruction set,
+// define MAT4X4_SCALAR to force the plain C versions
+#if !defined(MAT4X4_SCALAR) && defined(__AVX__)
+#define MAT4X4_AVX
+#endif
+#if !defined(MAT4X4_SCALAR) && (defined(__SSE2__) || defined(_M_X64))
+#define MAT4X4_SSE
+#endif
+#if !defined(MAT4X4_SCALAR) && defined(__ARM_NEON)
+#define MAT4X4_NEON
+#endif
+
+// row major, rows are 16 byte aligned so they load straight into SIMD registers
 typedef struct mat4x4
 {
-    float m[4][4];
+    _Alignas(16) float m[4][4];
 } mat4x4_t;
 
-mat4x4_t mat4x4_mul(mat4x4_t a, mat4x4_t b);
+// constant initializers for static and const data. rotations take the cosine
+// and sine of the angle so they stay constant expressions
+#define MAT4X4_IDENTITY_INIT {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}}
+#define MAT4X4_SCALE_INIT(x, y, z) {{{(x), 0, 0, 0}, {0, (y), 0, 0}, {0, 0, (z), 0}, {0, 0, 0, 1}}}
+#define MAT4X4_TRANSLATE_INIT(x, y, z) {{{1, 0, 0, (x)}, {0, 1, 0, (y)}, {0, 0, 1, (z)}, {0, 0, 0, 1}}}
+#define MAT4X4_ROT_X_INIT(c, s) {{{1, 0, 0, 0}, {0, (c), -(s), 0}, {0, (s), (c), 0}, {0, 0, 0, 1}}}
+#define MAT4X4_ROT_Y_INIT(c, s) {{{(c), 0, (s), 0}, {0, 1, 0, 0}, {-(s), 0, (c), 0}, {0, 0, 0, 1}}}
+#define MAT4X4_ROT_Z_INIT(c, s) {{{(c), -(s), 0, 0}, {(s), (c), 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}}
+
+MATH_API mat4x4_t mat4x4_mul(mat4x4_t a, mat4x4_t b);
+
+MATH_API mat4x4_t mat4x4_transpose(mat4x4_t a);
+
+mat4x4_t mat4x4_inverse(mat4x4_t a);
+
+mat4x4_t mat4x4_normalMatrix(mat4x4_t a);
+
+mat4x4_t mat4x4_normalMatrixUniform(mat4x4_t a);
+
+MATH_API v3_t mat4x4_transformPoint(mat4x4_t a, v3_t p);
+
+MATH_API v3_t mat4x4_transformDir(mat4x4_t a, v3_t d);
+
+void mat4x4_transformPoints(mat4x4_t a, v3_t *points, v3_t *result, int len);
+
+void mat4x4_mulBatch(mat4x4_t *a, mat4x4_t *b, mat4x4_t *result, int len);
+
+MATH_API mat4x4_t mat4x4_composeTRS(v3_t translation, v3_t rotation, v3_t scale);
+
+void mat4x4_composeTRSBatch(v3_t *translations, v3_t *rotations, v3_t *scales, mat4x4_t *result, int len);
+
+MATH_API mat4x4_t mat4x4_createIdentity(void);
 
-mat4x4_t mat4x4_createIdentity(void);
+MATH_API mat4x4_t mat4x4_createScale(v3_t s);
 
-mat4x4_t mat4x4_createScale(v3_t s);
+MATH_API mat4x4_t mat4x4_createRotX(float theta);
 
-mat4x4_t mat4x4_createRotX(float theta);
+MATH_API mat4x4_t mat4x4_createRotY(float theta);
 
-mat4x4_t mat4x4_createRotY(float theta);
+MATH_API mat4x4_t mat4x4_createRotZ(float theta);
 
-mat4x4_t mat4x4_createRotZ(float theta);
+MATH_API mat4x4_t mat4x4_createTranslate(v3_t t);
 
-mat4x4_t mat4x4_createTranslate(v3_t t);
+MATH_API mat4x4_t mat4x4_createProj(float aspectRatio, float fov, float zNear, float zFar);
 
-mat4x4_t mat4x4_createProj(float aspectRatio, float fov, float zNear, float zFar);
+MATH_API mat4x4_t mat4x4_createLookAt(v3_t pos, v3_t target, v3_t up);
 
-mat4x4_t mat4x4_createLookAt(v3_t pos, v3_t target, v3_t up);
+#ifdef MATH_HEADER_ONLY
+#include "mat4x4inline.h"
+#endif
 
 #endif
\ No newline at end of file
@@ -0,0 +1,385 @@
+#ifndef MAT4X4INLINE_H
+#define MAT4X4INLINE_H
+
+// the small mat4x4 functions. compiled into mat4x4.c, or included by mat4x4.h
+// as static inline definitions when MATH_HEADER_ONLY is defined
+
+#include <math.h>
+#include "mat4x4.h"
+
+#if defined(MAT4X4_SSE) || defined(MAT4X4_AVX)
+#include <immintrin.h>
+#endif
+#if defined(MAT4X4_NEON)
+#include <arm_neon.h>
+#endif
+
+MATH_API mat4x4_t mat4x4_mul(mat4x4_t a, mat4x4_t b)
+{
+    mat4x4_t result;
+
+#if defined(MAT4X4_AVX)
+    // two result rows per iteration, each a sum of b's rows scaled by a's elements.
+    // rows are only 16 byte aligned, so the 32 byte accesses are unaligned
+    __m256 b0 = _mm256_broadcast_ps((__m128 *)b.m[0]);
+    __m256 b1 = _mm256_broadcast_ps((__m128 *)b.m[1]);
+    __m256 b2 = _mm256_broadcast_ps((__m128 *)b.m[2]);
+    __m256 b3 = _mm256_broadcast_ps((__m128 *)b.m[3]);
+    for (int row = 0; row < 4; row += 2)
+    {
+        __m256 aRows = _mm256_loadu_ps(a.m[row]);
+        __m256 r = _mm256_mul_ps(_mm256_permute_ps(aRows, 0x00), b0);
+        r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(aRows, 0x55), b1));
+        r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(aRows, 0xaa), b2));
+        r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(aRows, 0xff), b3));
+        _mm256_storeu_ps(result.m[row], r);
+    }
+#elif defined(MAT4X4_SSE)
+    __m128 b0 = _mm_load_ps(b.m[0]);
+    __m128 b1 = _mm_load_ps(b.m[1]);
+    __m128 b2 = _mm_load_ps(b.m[2]);
+    __m128 b3 = _mm_load_ps(b.m[3]);
+    for (int row = 0; row < 4; row++)
+    {
+        __m128 aRow = _mm_load_ps(a.m[row]);
+        __m128 r = _mm_mul_ps(_mm_shuffle_ps(aRow, aRow, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(aRow, aRow, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(aRow, aRow, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(aRow, aRow, _MM_SHUFFLE(3, 3, 3, 3)), b3));
+        _mm_store_ps(result.m[row], r);
+    }
+#elif defined(MAT4X4_NEON)
+    float32x4_t b0 = vld1q_f32(b.m[0]);
+    float32x4_t b1 = vld1q_f32(b.m[1]);
+    float32x4_t b2 = vld1q_f32(b.m[2]);
+    float32x4_t b3 = vld1q_f32(b.m[3]);
+    for (int row = 0; row < 4; row++)
+    {
+        float32x4_t r = vmulq_n_f32(b0, a.m[row][0]);
+        r = vmlaq_n_f32(r, b1, a.m[row][1]);
+        r = vmlaq_n_f32(r, b2, a.m[row][2]);
+        r = vmlaq_n_f32(r, b3, a.m[row][3]);
+        vst1q_f32(result.m[row], r);
+    }
+#else
+    for (int row = 0; row < 4; row++)
+    {
+        for (int col = 0; col < 4; col++)
+        {
+            result.m[row][col] = a.m[row][0] * b.m[0][col] + a.m[row][1] * b.m[1][col] + a.m[row][2] * b.m[2][col] + a.m[row][3] * b.m[3][col];
+        }
+    }
+#endif
+
+    return result;
+}
+
+MATH_API mat4x4_t mat4x4_transpose(mat4x4_t a)
+{
+    mat4x4_t result;
+
+#if defined(MAT4X4_SSE)
+    __m128 r0 = _mm_load_ps(a.m[0]);
+    __m128 r1 = _mm_load_ps(a.m[1]);
+    __m128 r2 = _mm_load_ps(a.m[2]);
+    __m128 r3 = _mm_load_ps(a.m[3]);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_store_ps(result.m[0], r0);
+    _mm_store_ps(result.m[1], r1);
+    _mm_store_ps(result.m[2], r2);
+    _mm_store_ps(result.m[3], r3);
+#elif defined(MAT4X4_NEON)
+    float32x4x4_t rows = vld4q_f32(&a.m[0][0]);
+    vst1q_f32(result.m[0], rows.val[0]);
+    vst1q_f32(result.m[1], rows.val[1]);
+    vst1q_f32(result.m[2], rows.val[2]);
+    vst1q_f32(result.m[3], rows.val[3]);
+#else
+    for (int row = 0; row < 4; row++)
+    {
+        for (int col = 0; col < 4; col++)
+        {
+            result.m[row][col] = a.m[col][row];
+        }
+    }
+#endif
+
+    return result;
+}
+
+// transforms p as a point (w = 1), without the perspective divide
+MATH_API v3_t mat4x4_transformPoint(mat4x4_t a, v3_t p)
+{
+    v3_t result;
+    result.x = a.m[0][0] * p.x + a.m[0][1] * p.y + a.m[0][2] * p.z + a.m[0][3];
+    result.y = a.m[1][0] * p.x + a.m[1][1] * p.y + a.m[1][2] * p.z + a.m[1][3];
+    result.z = a.m[2][0] * p.x + a.m[2][1] * p.y + a.m[2][2] * p.z + a.m[2][3];
+    return result;
+}
+
+// transforms d as a direction (w = 0)
+MATH_API v3_t mat4x4_transformDir(mat4x4_t a, v3_t d)
+{
+    v3_t result;
+    result.x = a.m[0][0] * d.x + a.m[0][1] * d.y + a.m[0][2] * d.z;
+    result.y = a.m[1][0] * d.x + a.m[1][1] * d.y + a.m[1][2] * d.z;
+    result.z = a.m[2][0] * d.x + a.m[2][1] * d.y + a.m[2][2] * d.z;
+    return result;
+}
+
+// translate * rotZ * rotY * rotX * scale in closed form, rotation holds
+// the x, y and z euler angles
+MATH_API mat4x4_t mat4x4_composeTRS(v3_t translation, v3_t rotation, v3_t scale)
+{
+    float sx = sinf(rotation.x), cx = cosf(rotation.x);
+    float sy = sinf(rotation.y), cy = cosf(rotation.y);
+    float sz = sinf(rotation.z), cz = cosf(rotation.z);
+    mat4x4_t result;
+
+    result.m[0][0] = cz * cy * scale.x;
+    result.m[0][1] = (cz * sy * sx - sz * cx) * scale.y;
+    result.m[0][2] = (cz * sy * cx + sz * sx) * scale.z;
+    result.m[0][3] = translation.x;
+
+    result.m[1][0] = sz * cy * scale.x;
+    result.m[1][1] = (sz * sy * sx + cz * cx) * scale.y;
+    result.m[1][2] = (sz * sy * cx - cz * sx) * scale.z;
+    result.m[1][3] = translation.y;
+
+    result.m[2][0] = -sy * scale.x;
+    result.m[2][1] = cy * sx * scale.y;
+    result.m[2][2] = cy * cx * scale.z;
+    result.m[2][3] = translation.z;
+
+    result.m[3][0] = 0;
+    result.m[3][1] = 0;
+    result.m[3][2] = 0;
+    result.m[3][3] = 1;
+
+    return result;
+}
+
+MATH_API mat4x4_t mat4x4_createIdentity(void)
+{
+    mat4x4_t result;
+
+    result.m[0][0] = 1;
+    result.m[0][1] = 0;
+    result.m[0][2] = 0;
+    result.m[0][3] = 0;
+
+    result.m[1][0] = 0;
+    result.m[1][1] = 1;
+    result.m[1][2] = 0;
+    result.m[1][3] = 0;
+
+    result.m[2][0] = 0;
+    result.m[2][1] = 0;
+    result.m[2][2] = 1;
+    result.m[2][3] = 0;
+
+    result.m[3][0] = 0;
+    result.m[3][1] = 0;
+    result.m[3][2] = 0;
+    result.m[3][3] = 1;
+
+    return result;
+}
+
+MATH_API mat4x4_t mat4x4_createScale(v3_t s)
+{
+    mat4x4_t result;
+
+    result.m[0][0] = s.x;
+    result.m[0][1] = 0;
+    result.m[0][2] = 0;
+    result.m[0][3] = 0;
+
+    result.m[1][0] = 0;
+    result.m[1][1] = s.y;
+    result.m[1][2] = 0;
+    result.m[1][3] = 0;
+
+    result.m[2][0] = 0;
+    result.m[2][1] = 0;
+    result.m[2][2] = s.z;
+    result.m[2][3] = 0;
+
+    result.m[3][0] = 0;
+    result.m[3][1] = 0;
+    result.m[3][2] = 0;
+    result.m[3][3] = 1;
+
+    return result;
+}
+
+MATH_API mat4x4_t mat4x4_createRotX(float theta)
+{
+    mat4x4_t result;
+
+    result.m[0][0] = 1;
+    result.m[0][1] = 0;
+    result.m[0][2] = 0;
+    result.m[0][3] = 0;
+
+    result.m[1][0] = 0;
+    result.m[1][1] = cosf(theta);
+    result.m[1][2] = -sinf(theta);
+    result.m[1][3] = 0;
+
+    result.m[2][0] = 0;
+    result.m[2][1] = sinf(theta);
+    result.m[2][2] = cosf(theta);
+    result.m[2][3] = 0;
+
+    result.m[3][0] = 0;
+    result.m[3][1] = 0;
+    result.m[3][2] = 0;
+    result.m[3][3] = 1;
+
+    return result;
+}
+
+MATH_API mat4x4_t mat4x4_createRotY(float theta)
+{
+    mat4x4_t result;
+
+    result.m[0][0] = cosf(theta);
+    result.m[0][1] = 0;
+    result.m[0][2] = sinf(theta);
+    result.m[0][3] = 0;
+
+    result.m[1][0] = 0;
+    result.m[1][1] = 1;
+    result.m[1][2] = 0;
+    result.m[1][3] = 0;
+
+    result.m[2][0] = -sinf(theta);
+    result.m[2][1] = 0;
+    result.m[2][2] = cosf(theta);
+    result.m[2][3] = 0;
+
+    result.m[3][0] = 0;
+    result.m[3][1] = 0;
+    result.m[3][2] = 0;
+    result.m[3][3] = 1;
+
+    return result;
+}
+
+MATH_API mat4x4_t mat4x4_createRotZ(float theta)
+{
+    mat4x4_t result;
+
+    result.m[0][0] = cosf(theta);
+    result.m[0][1] = -sinf(theta);
+    result.m[0][2] = 0;
+    result.m[0][3] = 0;
+
+    result.m[1][0] = sinf(theta);
+    result.m[1][1] = cosf(theta);
+    result.m[1][2] = 0;
+    result.m[1][3] = 0;
+
+    result.m[2][0] = 0;
+    result.m[2][1] = 0;
+    result.m[2][2] = 1;
+    result.m[2][3] = 0;
+
+    result.m[3][0] = 0;
+    result.m[3][1] = 0;
+    result.m[3][2] = 0;
+    result.m[3][3] = 1;
+
+    return result;
+}
+
+MATH_API mat4x4_t mat4x4_createTranslate(v3_t t)
+{
+    mat4x4_t result;
+
+    result.m[0][0] = 1;
+    result.m[0][1] = 0;
+    result.m[0][2] = 0;
+    result.m[0][3] = t.x;
+
+    result.m[1][0] = 0;
+    result.m[1][1] = 1;
+    result.m[1][2] = 0;
+    result.m[1][3] = t.y;
+
+    result.m[2][0] = 0;
+    result.m[2][1] = 0;
+    result.m[2][2] = 1;
+    result.m[2][3] = t.z;
+
+    result.m[3][0] = 0;
+    result.m[3][1] = 0;
+    result.m[3][2] = 0;
+    result.m[3][3] = 1;
+
+    return result;
+}
+
+MATH_API mat4x4_t mat4x4_createProj(float aspectRatio, float fov, float zNear, float zFar)
+{
+    float right = zNear * tanf(fov / 2.0f);
+    float top = right / aspectRatio;
+
+    mat4x4_t result;
+
+    result.m[0][0] = zNear / right;
+    result.m[0][1] = 0;
+    result.m[0][2] = 0;
+    result.m[0][3] = 0;
+
+    result.m[1][0] = 0;
+    result.m[1][1] = zNear / top;
+    result.m[1][2] = 0;
+    result.m[1][3] = 0;
+
+    result.m[2][0] = 0;
+    result.m[2][1] = 0;
+    result.m[2][2] = -(zFar + zNear) / (zFar - zNear);
+    result.m[2][3] = (-2 * zFar * zNear) / (zFar - zNear);
+
+    result.m[3][0] = 0;
+    result.m[3][1] = 0;
+    result.m[3][2] = -1;
+    result.m[3][3] = 0;
+
+    return result;
+}
+
+MATH_API mat4x4_t mat4x4_createLookAt(v3_t pos, v3_t target, v3_t worldUp)
+{
+    v3_t direction = v3_normalize(v3_sub(pos, target));
+    v3_t right = v3_normalize(v3_cross(worldUp, direction));
+    v3_t up = v3_cross(direction, right);
+
+    mat4x4_t result;
+
+    result.m[0][0] = right.x;
+    result.m[0][1] = right.y;
+    result.m[0][2] = right.z;
+    result.m[0][3] = right.x * -pos.x + right.y * -pos.y + right.z * -pos.z;
+
+    result.m[1][0] = up.x;
+    result.m[1][1] = up.y;
+    result.m[1][2] = up.z;
+    result.m[1][3] = up.x * -pos.x + up.y * -pos.y + up.z * -pos.z;
+
+    result.m[2][0] = direction.x;
+    result.m[2][1] = direction.y;
+    result.m[2][2] = direction.z;
+    result.m[2][3] = direction.x * -pos.x + direction.y * -pos.y + direction.z * -pos.z;
+
+    result.m[3][0] = 0;
+    result.m[3][1] = 0;
+    result.m[3][2] = 0;
+    result.m[3][3] = 1;
+
+    return result;
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef MATHINLINE_H
+#define MATHINLINE_H
+
+// define MATH_HEADER_ONLY to get the small v2, v3 and mat4x4 functions as
+// static inline definitions in their headers, so they inline without LTO and
+// in unoptimised builds. otherwise they are ordinary functions in the .c files
+#ifdef MATH_HEADER_ONLY
+#if defined(__GNUC__) || defined(__clang__)
+#define MATH_API static inline __attribute__((always_inline))
+#else
+#define MATH_API static inline
+#endif
+#else
+#define MATH_API
+#endif
+
+#endif
@@ -2,181 +2,711 @@
 #include <stdio.h>
 #include <string.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <math.h>
 #include <glad/glad.h>
 #include "mesh.h"
+#include "obj.h"
+#include "meshopt.h"
+#include "tangents.h"
+#include "glstate.h"
+#include "renderstats.h"
 #include "utils.h"
 
+static const int STATS_CACHE_SIZE = 32;
+// generated normals are smoothed across edges sharper than this
+static const float CREASE_ANGLE = M_PI / 3.0f;
 static const int DIFFUSE_TEXTURES_OFFSET = 0;
 static const int SPECULAR_TEXTURES_OFFSET = 3;
+static const int NORMAL_TEXTURES_OFFSET = 5;
+// the coarsest LOD whose error covers at most this many pixels is drawn
+static const float LOD_PIXEL_ERROR = 1.0f;
 static char *TEXTURE_NAMES[] = {
     "diffuse1",
     "diffuse2",
     "diffuse3",
     "specular1",
     "specular2",
+    "normal1",
 };
+static const int TEXTURES_LEN = sizeof(TEXTURE_NAMES) / sizeof(TEXTURE_NAMES[0]);
 
-int mesh_loadVerts(vertex_t **verts, char *path)
+// faces are assembled in batches so the work can be spread across threads
+static const int ASSEMBLE_BATCH_FACES = 1 << 14;
+
+typedef struct assembleJob
+{
+    obj_t *obj;
+    vertex_t *verts;
+    char *path;
+} assembleJob_t;
+
+static void assembleJob(void *ctx, int index)
 {
-    FILE *file = fopen(path, "r");
-    if (file == NULL)
+    assembleJob_t *job = ctx;
+    obj_t *obj = job->obj;
+    int start = index * ASSEMBLE_BATCH_FACES * 3;
+    int end = start + ASSEMBLE_BATCH_FACES * 3;
+    if (end > obj->cornersLen)
     {
-        printf("failed to open file: %s", path);
-        exit(EXIT_FAILURE);
+        end = obj->cornersLen;
     }
 
-    int vertsLen = 0;
+    for (int i = start; i < end; ++i)
+    {
+        obj_corner_t corner = obj->corners[i];
+        bool hasTexCoord = corner.texCoord != OBJ_MISSING_INDEX;
+        if (corner.pos < 0 || corner.pos >= obj->positionsLen ||
+            (hasTexCoord && (corner.texCoord < 0 || corner.texCoord >= obj->texCoordsLen)) ||
+            corner.normal < 0 || corner.normal >= obj->normalsLen)
+        {
+            printf("invalid face index in %s: face %d", job->path, i / 3 + 1);
+            exit(EXIT_FAILURE);
+        }
+
+        vertex_t *vert = &job->verts[i];
+        vert->pos = obj->positions[corner.pos];
+        vert->normal = obj->normals[corner.normal];
+        // faces without tex coords
+        vert->texCoords = hasTexCoord ? obj->texCoords[corner.texCoord] : v2_create(0.0f, 0.0f);
+        // filled in after vertices are merged
+        vert->tangent = v3_create(0.0f, 0.0f, 0.0f);
+    }
+
+    // the handedness is part of the vertex, so corners on either side of a
+    // mirrored uv seam aren't merged into one vertex whose tangents cancel
+    for (int i = start; i < end; i += 3)
+    {
+        vertex_t *tri = &job->verts[i];
+        float sign = tangents_triangleSign(tri[0].texCoords, tri[1].texCoords, tri[2].texCoords);
+        tri[0].bitangentSign = sign;
+        tri[1].bitangentSign = sign;
+        tri[2].bitangentSign = sign;
+    }
+}
+
+static uint32_t hashVertex(const vertex_t *vert)
+{
+    uint32_t words[sizeof(vertex_t) / sizeof(uint32_t)];
+    memcpy(words, vert, sizeof(words));
 
-    v3_t *vertPositions = utils_malloc(sizeof(v3_t) * 128);
-    int vertPositionsLen = 0;
-    v2_t *vertTexCoords = utils_malloc(sizeof(v2_t) * 128);
-    int vertTexCoordsLen = 0;
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < (int)(sizeof(words) / sizeof(*words)); ++i)
+    {
+        hash = (hash ^ words[i]) * 16777619u;
+        hash ^= hash >> 15;
+    }
+    return hash;
+}
 
-    char line[256];
-    char token[64];
+// collapses identical vertices, writing the unique ones to the front of verts
+// and an index per original vertex. returns the number of unique vertices
+static int dedupVerts(vertex_t *verts, int vertsLen, unsigned int *indices)
+{
+    int tableCap = 1;
+    while (tableCap < vertsLen * 2)
+    {
+        tableCap *= 2;
+    }
+    int *table = utils_malloc(sizeof(int) * tableCap);
+    memset(table, -1, sizeof(int) * tableCap);
 
-    while (fgets(line, 128, file) != NULL)
+    int uniqueLen = 0;
+
+    for (int i = 0; i < vertsLen; ++i)
     {
-        char *linePtr = line;
-        utils_getToken(linePtr, ' ', token, &linePtr);
+        uint32_t slot = hashVertex(&verts[i]) & (tableCap - 1);
 
-        if (strcmp(token, "v") == 0)
-        {
-            float posX = strtof(linePtr, &linePtr);
-            float posY = strtof(linePtr, &linePtr);
-            float posZ = strtof(linePtr, &linePtr);
-            vertPositions[vertPositionsLen] = v3_create(posX, posY, posZ);
-            ++vertPositionsLen;
-        }
-        else if (strcmp(token, "vt") == 0)
+        while (table[slot] != -1 && memcmp(&verts[table[slot]], &verts[i], sizeof(vertex_t)) != 0)
         {
-            float texCoordX = strtof(linePtr, &linePtr);
-            float texCoordY = strtof(linePtr, &linePtr);
-            vertTexCoords[vertTexCoordsLen] = v2_create(texCoordX, texCoordY);
-            vertTexCoordsLen++;
+            slot = (slot + 1) & (tableCap - 1);
         }
-        else if (strcmp(token, "f") == 0)
+
+        if (table[slot] == -1)
         {
-            // TODO: rethink name for a 'sub-token' and the pointer within it
-            char *tokenPtr;
-            char indexStr[16];
-
-            // vertex 1
-            utils_getToken(linePtr, ' ', token, &linePtr);
-            tokenPtr = token;
-            utils_getToken(tokenPtr, '/', indexStr, &tokenPtr);
-            int v1PositionIdx = strtol(indexStr, NULL, 10);
-            utils_getToken(tokenPtr, '/', indexStr, &tokenPtr);
-            int v1TexCoordIdx = strtol(indexStr, NULL, 10);
-
-            // vertex 2
-            utils_getToken(linePtr, ' ', token, &linePtr);
-            tokenPtr = token;
-            utils_getToken(tokenPtr, '/', indexStr, &tokenPtr);
-            int v2PositionIdx = strtol(indexStr, NULL, 10);
-            utils_getToken(tokenPtr, '/', indexStr, &tokenPtr);
-            int v2TexCoordIdx = strtol(indexStr, NULL, 10);
-
-            // vertex 3
-            utils_getToken(linePtr, ' ', token, &linePtr);
-            tokenPtr = token;
-            utils_getToken(tokenPtr, '/', indexStr, &tokenPtr);
-            int v3PositionIdx = strtol(indexStr, NULL, 10);
-            utils_getToken(tokenPtr, '/', indexStr, &tokenPtr);
-            int v3TexCoordIdx = strtol(indexStr, NULL, 10);
-
-            vertex_t vert1;
-            vert1.pos = vertPositions[v1PositionIdx - 1];
-            vert1.texCoords = vertTexCoords[v1TexCoordIdx - 1];
-
-            vertex_t vert2;
-            vert2.pos = vertPositions[v2PositionIdx - 1];
-            vert2.texCoords = vertTexCoords[v2TexCoordIdx - 1];
-
-            vertex_t vert3;
-            vert3.pos = vertPositions[v3PositionIdx - 1];
-            vert3.texCoords = vertTexCoords[v3TexCoordIdx - 1];
-
-            // assume CCW winding
-            v3_t faceNormal = v3_normalize(v3_cross(v3_sub(vert2.pos, vert1.pos), v3_sub(vert3.pos, vert1.pos)));
-            vert1.normal = faceNormal;
-            vert2.normal = faceNormal;
-            vert3.normal = faceNormal;
-
-            (*verts)[vertsLen++] = vert1;
-            (*verts)[vertsLen++] = vert2;
-            (*verts)[vertsLen++] = vert3;
+            // uniqueLen <= i, so this never overwrites a vertex that is still to be visited
+            verts[uniqueLen] = verts[i];
+            table[slot] = uniqueLen;
+            ++uniqueLen;
         }
+        indices[i] = table[slot];
     }
 
+    free(table);
+    return uniqueLen;
+}
+
+// the file is mapped and parsed in place. pass "-" to read from stdin
+int mesh_loadVerts(vertex_t **verts, unsigned int **indices, int *indicesLen, char *path)
+{
+    return mesh_loadVertsParallel(verts, indices, indicesLen, path, 1);
+}
+
+// splits parsing and vertex assembly across numThreads threads. vn records are
+// used when present, otherwise smooth normals are generated. vertices with the
+// same position, normal, tex coords and handedness are merged, so each face
+// corner is written to *indices, then tangents are generated for the merged
+// vertices
+int mesh_loadVertsParallel(vertex_t **verts, unsigned int **indices, int *indicesLen, char *path, int numThreads)
+{
+    mappedFile_t file = utils_mapFile(path);
+    obj_t obj = obj_create();
+    obj_parseParallel(&obj, file.data, file.data + file.len, numThreads);
+    utils_unmapFile(file);
+    obj_triangulate(&obj);
+    obj_generateNormals(&obj, CREASE_ANGLE, numThreads);
+
+    int vertsLen = obj.cornersLen;
+    *verts = utils_malloc(sizeof(vertex_t) * (vertsLen > 0 ? vertsLen : 1));
+
+    assembleJob_t job;
+    job.obj = &obj;
+    job.verts = *verts;
+    job.path = path;
+    int numBatches = (vertsLen / 3 + ASSEMBLE_BATCH_FACES - 1) / ASSEMBLE_BATCH_FACES;
+    utils_parallelFor(numBatches, numThreads, assembleJob, &job);
+
+    obj_free(&obj);
+
+    *indicesLen = vertsLen;
+    *indices = utils_malloc(sizeof(unsigned int) * (vertsLen > 0 ? vertsLen : 1));
+    vertsLen = dedupVerts(*verts, vertsLen, *indices);
+    *verts = utils_realloc(*verts, sizeof(vertex_t) * (vertsLen > 0 ? vertsLen : 1));
+    tangents_generate(*verts, vertsLen, *indices, *indicesLen, numThreads);
+
     return vertsLen;
 }
 
-mesh_t mesh_create(
+// the box around every vertex, and a sphere around its center that reaches the
+// furthest vertex, which is tighter than the box's corners
+static void calcBounds(mesh_t *mesh)
+{
+    v3_t min = v3_create(0.0f, 0.0f, 0.0f);
+    v3_t max = v3_create(0.0f, 0.0f, 0.0f);
+    if (mesh->verticesLen > 0)
+    {
+        min = mesh->vertices[0].pos;
+        max = mesh->vertices[0].pos;
+    }
+    for (int i = 1; i < mesh->verticesLen; ++i)
+    {
+        v3_t pos = mesh->vertices[i].pos;
+        min = v3_create(fminf(min.x, pos.x), fminf(min.y, pos.y), fminf(min.z, pos.z));
+        max = v3_create(fmaxf(max.x, pos.x), fmaxf(max.y, pos.y), fmaxf(max.z, pos.z));
+    }
+    v3_t center = v3_mul(v3_add(min, max), 0.5f);
+
+    float radiusSq = 0.0f;
+    for (int i = 0; i < mesh->verticesLen; ++i)
+    {
+        v3_t d = v3_sub(mesh->vertices[i].pos, center);
+        radiusSq = fmaxf(radiusSq, v3_dot(d, d));
+    }
+
+    mesh->boundsMin = min;
+    mesh->boundsMax = max;
+    mesh->boundsCenter = center;
+    mesh->boundsRadius = sqrtf(radiusSq);
+}
+
+static mesh_t initMesh(
     vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen,
     texture_t *textures, int texturesLen)
 {
     mesh_t mesh;
     mesh.vertices = vertices;
     mesh.verticesLen = verticesLen;
+    mesh.indices = indices;
+    mesh.indicesLen = indicesLen;
     mesh.textures = textures;
     mesh.texturesLen = texturesLen;
 
+    mesh.isQuantized = false;
+    mesh.posScale = v3_create(1.0f, 1.0f, 1.0f);
+    mesh.posOffset = v3_create(0.0f, 0.0f, 0.0f);
+    mesh.texCoordsScale = v2_create(1.0f, 1.0f);
+    mesh.texCoordsOffset = v2_create(0.0f, 0.0f);
+    calcBounds(&mesh);
+
+    mesh.lods[0].firstIndex = 0;
+    mesh.lods[0].indicesLen = indicesLen;
+    mesh.lods[0].error = 0.0f;
+    mesh.lodsLen = 1;
+
     glGenVertexArrays(1, &mesh.VAO);
     glGenBuffers(1, &mesh.VBO);
+    glGenBuffers(1, &mesh.EBO);
 
-    glBindVertexArray(mesh.VAO);
+    return mesh;
+}
+
+// expects the mesh's VAO to be bound
+static void uploadIndices(mesh_t *mesh, unsigned int *indices, int indicesLen)
+{
+    // 16 bit indices when every vertex can be addressed with them
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
+    if (mesh->verticesLen <= UINT16_MAX + 1)
+    {
+        uint16_t *shortIndices = utils_malloc(sizeof(uint16_t) * (indicesLen > 0 ? indicesLen : 1));
+        for (int i = 0; i < indicesLen; ++i)
+        {
+            shortIndices[i] = (uint16_t)indices[i];
+        }
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesLen * sizeof(uint16_t), shortIndices, GL_STATIC_DRAW);
+        free(shortIndices);
+        mesh->indexType = GL_UNSIGNED_SHORT;
+    }
+    else
+    {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesLen * sizeof(*indices), indices, GL_STATIC_DRAW);
+        mesh->indexType = GL_UNSIGNED_INT;
+    }
+}
+
+// points the bound VAO's attributes at vertex_t data in the bound array buffer
+void mesh_setVertexLayout(void)
+{
+    // vertex positions
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex_t), (void *)offsetof(vertex_t, pos));
+    glEnableVertexAttribArray(0);
+    // vertex normals
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vertex_t), (void *)offsetof(vertex_t, normal));
+    glEnableVertexAttribArray(1);
+    // vertex texture coords
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(vertex_t), (void *)offsetof(vertex_t, texCoords));
+    glEnableVertexAttribArray(2);
+    // vertex tangents, with the bitangent sign as w
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(vertex_t), (void *)offsetof(vertex_t, tangent));
+    glEnableVertexAttribArray(3);
+}
+
+mesh_t mesh_create(
+    vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen,
+    texture_t *textures, int texturesLen)
+{
+    mesh_t mesh = initMesh(vertices, verticesLen, indices, indicesLen, textures, texturesLen);
+
+    glstate_bindVertexArray(mesh.VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
     glBufferData(GL_ARRAY_BUFFER, mesh.verticesLen * sizeof(*mesh.vertices), mesh.vertices, GL_STATIC_DRAW);
+    uploadIndices(&mesh, mesh.indices, mesh.indicesLen);
+    mesh_setVertexLayout();
+
+    glstate_bindVertexArray(0);
+
+    return mesh;
+}
+
+static int16_t packSnorm16(float v)
+{
+    return (int16_t)lroundf(clampf(v, -1.0f, 1.0f) * INT16_MAX);
+}
+
+static uint16_t packUnorm16(float v)
+{
+    return (uint16_t)lroundf(clampf(v, 0.0f, 1.0f) * UINT16_MAX);
+}
+
+// GL_INT_2_10_10_10_REV, x in the low bits
+static uint32_t packSnorm1010102(v3_t v, float w)
+{
+    uint32_t x = (uint32_t)lroundf(clampf(v.x, -1.0f, 1.0f) * 511.0f) & 0x3ff;
+    uint32_t y = (uint32_t)lroundf(clampf(v.y, -1.0f, 1.0f) * 511.0f) & 0x3ff;
+    uint32_t z = (uint32_t)lroundf(clampf(v.z, -1.0f, 1.0f) * 511.0f) & 0x3ff;
+    // w only carries a sign. -2 and 1 decode to -1 and 1 under both the GL 4.2
+    // rule, max(c, -1), and the older (2c + 1) / 3 a 3.3 context may use, which
+    // would turn -1 into -1/3
+    uint32_t packedW = w < 0.0f ? 0x2 : 0x1;
+    return x | (y << 10) | (z << 20) | (packedW << 30);
+}
+
+static float unpackSnorm(int value, float max)
+{
+    return fmaxf(value / max, -1.0f);
+}
+
+static v3_t unpackSnorm1010102(uint32_t packed)
+{
+    // shift each field to the top of the word so the sign extends
+    return v3_create(
+        unpackSnorm((int32_t)(packed << 22) >> 22, 511.0f),
+        unpackSnorm((int32_t)(packed << 12) >> 22, 511.0f),
+        unpackSnorm((int32_t)(packed << 2) >> 22, 511.0f));
+}
+
+// positions are stored relative to the mesh bounds, and tex coords relative to
+// their own range. the shader maps them back with posScale/posOffset and
+// texCoordsScale/texCoordsOffset
+static void calcQuantization(
+    vertex_t *vertices, int verticesLen,
+    v3_t *posScale, v3_t *posOffset, v2_t *texCoordsScale, v2_t *texCoordsOffset)
+{
+    v3_t posMin = v3_create(INFINITY, INFINITY, INFINITY);
+    v3_t posMax = v3_create(-INFINITY, -INFINITY, -INFINITY);
+    v2_t texCoordsMin = v2_create(INFINITY, INFINITY);
+    v2_t texCoordsMax = v2_create(-INFINITY, -INFINITY);
+
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        vertex_t *vert = &vertices[i];
+        posMin = v3_create(fminf(posMin.x, vert->pos.x), fminf(posMin.y, vert->pos.y), fminf(posMin.z, vert->pos.z));
+        posMax = v3_create(fmaxf(posMax.x, vert->pos.x), fmaxf(posMax.y, vert->pos.y), fmaxf(posMax.z, vert->pos.z));
+        texCoordsMin = v2_create(fminf(texCoordsMin.x, vert->texCoords.x), fminf(texCoordsMin.y, vert->texCoords.y));
+        texCoordsMax = v2_create(fmaxf(texCoordsMax.x, vert->texCoords.x), fmaxf(texCoordsMax.y, vert->texCoords.y));
+    }
+
+    if (verticesLen == 0)
+    {
+        posMin = posMax = v3_create(0.0f, 0.0f, 0.0f);
+        texCoordsMin = texCoordsMax = v2_create(0.0f, 0.0f);
+    }
+
+    // avoid dividing by zero on flat meshes
+    *posScale = v3_mul(v3_sub(posMax, posMin), 0.5f);
+    posScale->x = posScale->x > 0.0f ? posScale->x : 1.0f;
+    posScale->y = posScale->y > 0.0f ? posScale->y : 1.0f;
+    posScale->z = posScale->z > 0.0f ? posScale->z : 1.0f;
+    *posOffset = v3_mul(v3_add(posMax, posMin), 0.5f);
+
+    *texCoordsScale = v2_create(texCoordsMax.x - texCoordsMin.x, texCoordsMax.y - texCoordsMin.y);
+    texCoordsScale->x = texCoordsScale->x > 0.0f ? texCoordsScale->x : 1.0f;
+    texCoordsScale->y = texCoordsScale->y > 0.0f ? texCoordsScale->y : 1.0f;
+    *texCoordsOffset = texCoordsMin;
+}
+
+static packedVertex_t packVertex(vertex_t vert, v3_t posScale, v3_t posOffset, v2_t texCoordsScale, v2_t texCoordsOffset)
+{
+    packedVertex_t result;
+    result.pos[0] = packSnorm16((vert.pos.x - posOffset.x) / posScale.x);
+    result.pos[1] = packSnorm16((vert.pos.y - posOffset.y) / posScale.y);
+    result.pos[2] = packSnorm16((vert.pos.z - posOffset.z) / posScale.z);
+    result.pos[3] = 0;
+    result.normal = packSnorm1010102(vert.normal, 0.0f);
+    result.tangent = packSnorm1010102(vert.tangent, vert.bitangentSign);
+    result.texCoords[0] = packUnorm16((vert.texCoords.x - texCoordsOffset.x) / texCoordsScale.x);
+    result.texCoords[1] = packUnorm16((vert.texCoords.y - texCoordsOffset.y) / texCoordsScale.y);
+    return result;
+}
+
+// packs the vertices into packed, which needs room for verticesLen of them,
+// and returns the ranges they were packed relative to
+meshQuantization_t mesh_quantize(vertex_t *vertices, int verticesLen, packedVertex_t *packed)
+{
+    meshQuantization_t q;
+    calcQuantization(vertices, verticesLen, &q.posScale, &q.posOffset, &q.texCoordsScale, &q.texCoordsOffset);
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        packed[i] = packVertex(vertices[i], q.posScale, q.posOffset, q.texCoordsScale, q.texCoordsOffset);
+    }
+    return q;
+}
+
+// uploads vertices already packed with mesh_quantize, as a mesh cache stores
+// them. vertices are the same vertices unpacked, kept for bounds and lods
+mesh_t mesh_createPacked(
+    vertex_t *vertices, packedVertex_t *packed, int verticesLen, meshQuantization_t quantization,
+    unsigned int *indices, int indicesLen,
+    texture_t *textures, int texturesLen)
+{
+    mesh_t mesh = initMesh(vertices, verticesLen, indices, indicesLen, textures, texturesLen);
+    mesh.isQuantized = true;
+    mesh.posScale = quantization.posScale;
+    mesh.posOffset = quantization.posOffset;
+    mesh.texCoordsScale = quantization.texCoordsScale;
+    mesh.texCoordsOffset = quantization.texCoordsOffset;
+
+    glstate_bindVertexArray(mesh.VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glBufferData(GL_ARRAY_BUFFER, verticesLen * sizeof(*packed), packed, GL_STATIC_DRAW);
+    uploadIndices(&mesh, mesh.indices, mesh.indicesLen);
 
     // vertex positions
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(*mesh.vertices), (void *)offsetof(vertex_t, pos));
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(packedVertex_t), (void *)offsetof(packedVertex_t, pos));
     glEnableVertexAttribArray(0);
     // vertex normals
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(*mesh.vertices), (void *)offsetof(vertex_t, normal));
+    glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(packedVertex_t), (void *)offsetof(packedVertex_t, normal));
     glEnableVertexAttribArray(1);
     // vertex texture coords
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(*mesh.vertices), (void *)offsetof(vertex_t, texCoords));
+    glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(packedVertex_t), (void *)offsetof(packedVertex_t, texCoords));
     glEnableVertexAttribArray(2);
+    // vertex tangents
+    glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(packedVertex_t), (void *)offsetof(packedVertex_t, tangent));
+    glEnableVertexAttribArray(3);
 
-    glBindVertexArray(0);
+    glstate_bindVertexArray(0);
 
     return mesh;
 }
 
-void mesh_render(mesh_t mesh, shader_t shader)
+// uploads the vertices in packedVertex_t form, half the size of vertex_t
+mesh_t mesh_createQuantized(
+    vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen,
+    texture_t *textures, int texturesLen)
+{
+    packedVertex_t *packed = utils_malloc(sizeof(packedVertex_t) * (verticesLen > 0 ? verticesLen : 1));
+    meshQuantization_t quantization = mesh_quantize(vertices, verticesLen, packed);
+    mesh_t mesh = mesh_createPacked(
+        vertices, packed, verticesLen, quantization,
+        indices, indicesLen,
+        textures, texturesLen);
+    free(packed);
+    return mesh;
+}
+
+// round trips every vertex through packedVertex_t to report the worst case error
+void mesh_printQuantizationStats(vertex_t *vertices, int verticesLen, char *name)
 {
-    // set textures
-    unsigned int numDiffuseMaps = 0;
-    unsigned int numSpecularMaps = 0;
+    v3_t posScale, posOffset;
+    v2_t texCoordsScale, texCoordsOffset;
+    calcQuantization(vertices, verticesLen, &posScale, &posOffset, &texCoordsScale, &texCoordsOffset);
 
-    for (int i = 0; i < mesh.texturesLen; ++i)
+    float maxPosError = 0.0f;
+    float maxNormalError = 0.0f;
+    float maxTexCoordsError = 0.0f;
+
+    for (int i = 0; i < verticesLen; ++i)
     {
-        glActiveTexture(GL_TEXTURE0 + i);
+        vertex_t vert = vertices[i];
+        packedVertex_t packed = packVertex(vert, posScale, posOffset, texCoordsScale, texCoordsOffset);
+
+        v3_t pos = v3_create(
+            unpackSnorm(packed.pos[0], INT16_MAX) * posScale.x + posOffset.x,
+            unpackSnorm(packed.pos[1], INT16_MAX) * posScale.y + posOffset.y,
+            unpackSnorm(packed.pos[2], INT16_MAX) * posScale.z + posOffset.z);
+        maxPosError = fmaxf(maxPosError, v3_len(v3_sub(pos, vert.pos)));
+
+        v3_t normal = v3_normalize(unpackSnorm1010102(packed.normal));
+        float cosAngle = clampf(v3_dot(normal, v3_normalize(vert.normal)), -1.0f, 1.0f);
+        maxNormalError = fmaxf(maxNormalError, acosf(cosAngle));
+
+        float u = packed.texCoords[0] / (float)UINT16_MAX * texCoordsScale.x + texCoordsOffset.x;
+        float v = packed.texCoords[1] / (float)UINT16_MAX * texCoordsScale.y + texCoordsOffset.y;
+        maxTexCoordsError = fmaxf(maxTexCoordsError, fmaxf(fabsf(u - vert.texCoords.x), fabsf(v - vert.texCoords.y)));
+    }
+
+    printf(
+        "%s: quantized %d vertices, %ld -> %ld bytes, max error pos %g, normal %g deg, tex coords %g\n",
+        name, verticesLen,
+        (long)verticesLen * sizeof(vertex_t), (long)verticesLen * sizeof(packedVertex_t),
+        maxPosError, maxNormalError * 180.0f / M_PI, maxTexCoordsError);
+}
 
+// gives every sampler the program may declare a fixed texture unit, so drawing
+// only has to bind textures. call once after creating the program
+void mesh_bindSamplers(shader_t shader)
+{
+    shader_use(shader);
+    for (int unit = 0; unit < TEXTURES_LEN; ++unit)
+    {
+        shader_setInt(shader, TEXTURE_NAMES[unit], unit);
+    }
+}
+
+// simplifies the mesh into up to MESH_MAX_LODS levels, stored after the full
+// mesh's indices in its index buffer. mesh->indices keeps only the full mesh
+void mesh_generateLods(mesh_t *mesh, int numThreads)
+{
+    unsigned int *lodIndices;
+    mesh->lodsLen = meshopt_generateLods(
+        mesh->vertices, mesh->verticesLen, mesh->indices, mesh->indicesLen,
+        MESH_MAX_LODS, numThreads, &lodIndices, mesh->lods);
+
+    mesh_lod_t last = mesh->lods[mesh->lodsLen - 1];
+    glstate_bindVertexArray(mesh->VAO);
+    uploadIndices(mesh, lodIndices, last.firstIndex + last.indicesLen);
+    glstate_bindVertexArray(0);
+    free(lodIndices);
+}
+
+// the coarsest level whose error, projected from distance with the vertical
+// fov onto a screen screenHeight pixels tall, stays under LOD_PIXEL_ERROR.
+// scale is the model's largest scale factor
+int mesh_selectLod(mesh_t mesh, float distance, float scale, float screenHeight, float fov)
+{
+    if (distance <= 0.0f)
+    {
+        return 0;
+    }
+    float pixelsPerUnit = screenHeight / (2.0f * tanf(fov * 0.5f) * distance);
+    int lod = 0;
+    while (lod + 1 < mesh.lodsLen && mesh.lods[lod + 1].error * scale * pixelsPerUnit <= LOD_PIXEL_ERROR)
+    {
+        ++lod;
+    }
+    return lod;
+}
+
+static void *lodOffset(mesh_t mesh, int lod)
+{
+    size_t indexSize = mesh.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    return (void *)((size_t)mesh.lods[lod].firstIndex * indexSize);
+}
+
+// looks up the uniforms mesh_bind sets. call once per program, not per draw
+mesh_uniforms_t mesh_getUniforms(shader_t shader)
+{
+    mesh_uniforms_t result;
+    result.hasNormalMap = shader_getUniform(shader, "hasNormalMap");
+    result.posScale = shader_getUniform(shader, "posScale");
+    result.posOffset = shader_getUniform(shader, "posOffset");
+    result.texCoordsScale = shader_getUniform(shader, "texCoordsScale");
+    result.texCoordsOffset = shader_getUniform(shader, "texCoordsOffset");
+    return result;
+}
+
+// binds the mesh's textures, VAO and per mesh uniforms for mesh_draw. uniforms
+// come from mesh_getUniforms for the program in use
+void mesh_bind(mesh_t mesh, mesh_uniforms_t uniforms)
+{
+    // set textures, each type fills its own range of units
+    int numDiffuseMaps = 0;
+    int numSpecularMaps = 0;
+    int numNormalMaps = 0;
+
+    for (int i = 0; i < mesh.texturesLen; ++i)
+    {
         enum texture_type type = mesh.textures[i].type;
 
-        if (type == DIFFUSE)
+        if (type == DIFFUSE && numDiffuseMaps < SPECULAR_TEXTURES_OFFSET - DIFFUSE_TEXTURES_OFFSET)
         {
-            char *textureName = TEXTURE_NAMES[DIFFUSE_TEXTURES_OFFSET + numDiffuseMaps];
-            shader_setInt(shader, textureName, i);
+            glstate_bindTexture(DIFFUSE_TEXTURES_OFFSET + numDiffuseMaps, mesh.textures[i].id);
             ++numDiffuseMaps;
         }
-        else if (type == SPECULAR)
+        else if (type == SPECULAR && numSpecularMaps < NORMAL_TEXTURES_OFFSET - SPECULAR_TEXTURES_OFFSET)
         {
-            char *textureName = TEXTURE_NAMES[SPECULAR_TEXTURES_OFFSET + numSpecularMaps];
-            shader_setInt(shader, textureName, i);
+            glstate_bindTexture(SPECULAR_TEXTURES_OFFSET + numSpecularMaps, mesh.textures[i].id);
             ++numSpecularMaps;
         }
+        else if (type == NORMAL && numNormalMaps == 0)
+        {
+            glstate_bindTexture(NORMAL_TEXTURES_OFFSET + numNormalMaps, mesh.textures[i].id);
+            ++numNormalMaps;
+        }
+    }
+
+    shader_uniformBool(uniforms.hasNormalMap, numNormalMaps > 0);
+
+    // dequantization, identity for unquantized meshes
+    shader_uniformV3(uniforms.posScale, mesh.posScale);
+    shader_uniformV3(uniforms.posOffset, mesh.posOffset);
+    shader_uniformV2(uniforms.texCoordsScale, mesh.texCoordsScale);
+    shader_uniformV2(uniforms.texCoordsOffset, mesh.texCoordsOffset);
+
+    glstate_bindVertexArray(mesh.VAO);
+}
+
+// draws a mesh bound with mesh_bind, so repeated draws of it skip the binding
+void mesh_draw(mesh_t mesh)
+{
+    mesh_drawLod(mesh, 0);
+}
+
+void mesh_drawLod(mesh_t mesh, int lod)
+{
+    glDrawElements(GL_TRIANGLES, mesh.lods[lod].indicesLen, mesh.indexType, lodOffset(mesh, lod));
+    RENDERSTATS_COUNT_GL_CALLS(1);
+    RENDERSTATS_COUNT_TRIANGLES(mesh.lods[lod].indicesLen / 3);
+}
+
+// the VAO is left bound, glstate skips rebinding it for the next draw of the
+// same mesh
+void mesh_render(mesh_t mesh, mesh_uniforms_t uniforms)
+{
+    mesh_bind(mesh, uniforms);
+    mesh_draw(mesh);
+}
+
+meshInstance_t mesh_createInstance(mat4x4_t model, mat4x4_t normalMatrix)
+{
+    meshInstance_t result;
+    memcpy(result.model.m, model.m, sizeof(result.model.m));
+    memcpy(result.normalMatrix.m, normalMatrix.m, sizeof(result.normalMatrix.m));
+    return result;
+}
 
-        glBindTexture(GL_TEXTURE_2D, mesh.textures[i].id);
+// the instance rows of translate * rotation * scale, built from the quaternion
+// without going through a mat4x4. the normal matrix, the inverse transpose of
+// rotation * scale, is rotation * inverse scale. rotation must be a unit quaternion
+meshInstance_t mesh_createInstanceTRS(v3_t translation, quat_t rotation, v3_t scale)
+{
+    meshInstance_t result;
+    result.model = mat3x4_createTRS(translation, rotation, scale);
+    result.normalMatrix = mat3x4_createTRS(
+        v3_create(0.0f, 0.0f, 0.0f), rotation, v3_create(1.0f / scale.x, 1.0f / scale.y, 1.0f / scale.z));
+    return result;
+}
+
+unsigned int mesh_createInstanceBuffer(void)
+{
+    unsigned int instanceBuffer;
+    glGenBuffers(1, &instanceBuffer);
+    return instanceBuffer;
+}
+
+// replaces the buffer's contents, orphaning the old storage so draws still
+// reading it don't stall the upload
+void mesh_updateInstanceBuffer(unsigned int instanceBuffer, meshInstance_t *instances, int instancesLen)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, instancesLen * sizeof(meshInstance_t), instances, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    RENDERSTATS_COUNT_GL_CALLS(3);
+}
+
+// draws count instances of the mesh in one call. the instances' matrices come
+// from instanceBuffer as attributes 4 to 9, see object_instanced.vs
+void mesh_renderInstanced(mesh_t mesh, mesh_uniforms_t uniforms, unsigned int instanceBuffer, int count)
+{
+    mesh_renderInstancedLod(mesh, uniforms, instanceBuffer, 0, count, 0);
+}
+
+// mesh_renderInstanced for the instances from firstInstance on, at one level
+// of detail. GL 3.3 has no base instance, so the attributes start there instead
+void mesh_renderInstancedLod(mesh_t mesh, mesh_uniforms_t uniforms, unsigned int instanceBuffer, int firstInstance, int count, int lod)
+{
+    mesh_bind(mesh, uniforms);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    // model rows at 4 to 6, normal matrix rows at 7 to 9
+    size_t first = (size_t)firstInstance * sizeof(meshInstance_t);
+    for (int row = 0; row < 3; ++row)
+    {
+        glVertexAttribPointer(4 + row, 4, GL_FLOAT, GL_FALSE, sizeof(meshInstance_t), (void *)(first + offsetof(meshInstance_t, model) + row * 4 * sizeof(float)));
+        glVertexAttribPointer(7 + row, 4, GL_FLOAT, GL_FALSE, sizeof(meshInstance_t), (void *)(first + offsetof(meshInstance_t, normalMatrix) + row * 4 * sizeof(float)));
+    }
+    for (int location = 4; location < 10; ++location)
+    {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
     }
 
-    glActiveTexture(GL_TEXTURE0);
+    glDrawElementsInstanced(GL_TRIANGLES, mesh.lods[lod].indicesLen, mesh.indexType, lodOffset(mesh, lod), count);
+    RENDERSTATS_COUNT_TRIANGLES((long)count * mesh.lods[lod].indicesLen / 3);
+
+    // the VAO is shared with mesh_render, which has no instance buffer
+    for (int location = 4; location < 10; ++location)
+    {
+        glDisableVertexAttribArray(location);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    RENDERSTATS_COUNT_GL_CALLS(3 + 6 * 4);
+}
+
+// how much indexing saved over drawing one vertex per face corner
+void mesh_printStats(mesh_t mesh, char *name)
+{
+    int indexSize = mesh.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    long unindexedBytes = (long)mesh.indicesLen * sizeof(vertex_t);
+    long indexedBytes = (long)mesh.verticesLen * sizeof(vertex_t) + (long)mesh.indicesLen * indexSize;
+    float dedupRatio = mesh.verticesLen > 0 ? (float)mesh.indicesLen / mesh.verticesLen : 0.0f;
+    float acmr = meshopt_calcACMR(mesh.indices, mesh.indicesLen, mesh.verticesLen, STATS_CACHE_SIZE);
 
-    // render
-    glBindVertexArray(mesh.VAO);
-    glDrawArrays(GL_TRIANGLES, 0, mesh.verticesLen);
-    glBindVertexArray(0);
+    printf(
+        "%s: %d vertices, %d indices, dedup ratio %.2f, %ld bytes (saved %ld), ACMR %.3f\n",
+        name, mesh.verticesLen, mesh.indicesLen, dedupRatio, indexedBytes, unindexedBytes - indexedBytes, acmr);
 }
\ No newline at end of file
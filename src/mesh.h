@@ -1,35 +1,159 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "v2.h"
 #include "v3.h"
 #include "texture.h"
 #include "shader.h"
+#include "mat3x4.h"
 
 typedef struct vertex
 {
     v3_t pos;
     v3_t normal;
     v2_t texCoords;
+    // bitangent = bitangentSign * cross(normal, tangent)
+    v3_t tangent;
+    float bitangentSign;
 } vertex_t;
 
+// compact layout for mesh_createQuantized
+typedef struct packedVertex
+{
+    // snorm16 relative to the mesh bounds, w is padding
+    int16_t pos[4];
+    // snorm 10_10_10_2
+    uint32_t normal;
+    // unorm16 relative to the tex coord range
+    uint16_t texCoords[2];
+    // snorm 10_10_10_2, bitangent sign in w
+    uint32_t tangent;
+} packedVertex_t;
+
+// the ranges packedVertex_t positions and tex coords are relative to
+typedef struct meshQuantization
+{
+    v3_t posScale;
+    v3_t posOffset;
+    v2_t texCoordsScale;
+    v2_t texCoordsOffset;
+} meshQuantization_t;
+
+// per instance data for mesh_renderInstanced, the top 3 rows of each matrix
+typedef struct meshInstance
+{
+    mat3x4_t model;
+    // w is unused
+    mat3x4_t normalMatrix;
+} meshInstance_t;
+
+#define MESH_MAX_LODS 4
+
+// the uniforms mesh_bind sets, looked up once per program
+typedef struct mesh_uniforms
+{
+    shader_uniform_t hasNormalMap;
+    shader_uniform_t posScale;
+    shader_uniform_t posOffset;
+    shader_uniform_t texCoordsScale;
+    shader_uniform_t texCoordsOffset;
+} mesh_uniforms_t;
+
+// a level of detail's range in the mesh's index buffer. error is how far, in
+// model space, the simplified surface strays from the original
+typedef struct mesh_lod
+{
+    int firstIndex;
+    int indicesLen;
+    float error;
+} mesh_lod_t;
+
 typedef struct mesh
 {
     vertex_t *vertices;
     int verticesLen;
+    unsigned int *indices;
+    int indicesLen;
     texture_t *textures;
     int texturesLen;
 
     unsigned int VAO;
     unsigned int VBO;
+    unsigned int EBO;
+    unsigned int indexType;
+
+    bool isQuantized;
+    v3_t posScale;
+    v3_t posOffset;
+    v2_t texCoordsScale;
+    v2_t texCoordsOffset;
+
+    // lods[0] is the full mesh, the rest share its vertices
+    mesh_lod_t lods[MESH_MAX_LODS];
+    int lodsLen;
+
+    // model space bounds, for culling
+    v3_t boundsMin;
+    v3_t boundsMax;
+    v3_t boundsCenter;
+    float boundsRadius;
 } mesh_t;
 
-int mesh_loadVerts(vertex_t **verts, char *path);
+int mesh_loadVerts(vertex_t **verts, unsigned int **indices, int *indicesLen, char *path);
+
+int mesh_loadVertsParallel(vertex_t **verts, unsigned int **indices, int *indicesLen, char *path, int numThreads);
+
+void mesh_setVertexLayout(void);
 
 mesh_t mesh_create(
     vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen,
+    texture_t *textures, int texturesLen);
+
+mesh_t mesh_createQuantized(
+    vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen,
     texture_t *textures, int texturesLen);
 
-void mesh_render(mesh_t mesh, shader_t shader);
+meshQuantization_t mesh_quantize(vertex_t *vertices, int verticesLen, packedVertex_t *packed);
+
+mesh_t mesh_createPacked(
+    vertex_t *vertices, packedVertex_t *packed, int verticesLen, meshQuantization_t quantization,
+    unsigned int *indices, int indicesLen,
+    texture_t *textures, int texturesLen);
+
+void mesh_printQuantizationStats(vertex_t *vertices, int verticesLen, char *name);
+
+void mesh_generateLods(mesh_t *mesh, int numThreads);
+
+int mesh_selectLod(mesh_t mesh, float distance, float scale, float screenHeight, float fov);
+
+void mesh_bindSamplers(shader_t shader);
+
+mesh_uniforms_t mesh_getUniforms(shader_t shader);
+
+void mesh_bind(mesh_t mesh, mesh_uniforms_t uniforms);
+
+void mesh_draw(mesh_t mesh);
+
+void mesh_drawLod(mesh_t mesh, int lod);
+
+void mesh_render(mesh_t mesh, mesh_uniforms_t uniforms);
+
+meshInstance_t mesh_createInstance(mat4x4_t model, mat4x4_t normalMatrix);
+
+meshInstance_t mesh_createInstanceTRS(v3_t translation, quat_t rotation, v3_t scale);
+
+unsigned int mesh_createInstanceBuffer(void);
+
+void mesh_updateInstanceBuffer(unsigned int instanceBuffer, meshInstance_t *instances, int instancesLen);
+
+void mesh_renderInstanced(mesh_t mesh, mesh_uniforms_t uniforms, unsigned int instanceBuffer, int count);
+
+void mesh_renderInstancedLod(mesh_t mesh, mesh_uniforms_t uniforms, unsigned int instanceBuffer, int firstInstance, int count, int lod);
+
+void mesh_printStats(mesh_t mesh, char *name);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <glad/glad.h>
+#include "mesharena.h"
+#include "glstate.h"
+#include "renderstats.h"
+#include "utils.h"
+
+// the buffers are allocated once at their full size, meshes are appended with
+// glBufferSubData
+mesharena_t mesharena_create(int verticesCap, int indicesCap)
+{
+    mesharena_t arena = {0};
+    arena.verticesCap = verticesCap;
+    arena.indicesCap = indicesCap;
+
+    mesh_t *mesh = &arena.mesh;
+    mesh->posScale = v3_create(1.0f, 1.0f, 1.0f);
+    mesh->posOffset = v3_create(0.0f, 0.0f, 0.0f);
+    mesh->texCoordsScale = v2_create(1.0f, 1.0f);
+    mesh->texCoordsOffset = v2_create(0.0f, 0.0f);
+    mesh->indexType = GL_UNSIGNED_INT;
+
+    glGenVertexArrays(1, &mesh->VAO);
+    glGenBuffers(1, &mesh->VBO);
+    glGenBuffers(1, &mesh->EBO);
+
+    glstate_bindVertexArray(mesh->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->VBO);
+    glBufferData(GL_ARRAY_BUFFER, (size_t)verticesCap * sizeof(vertex_t), NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (size_t)indicesCap * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+    mesh_setVertexLayout();
+    glstate_bindVertexArray(0);
+    return arena;
+}
+
+// copies a mesh into the arena. there is no per draw transform, so the mesh
+// is baked into world space with model. indices stay relative to the mesh's
+// own vertices, the draw adds baseVertex
+mesharena_range_t mesharena_add(
+    mesharena_t *arena,
+    vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen,
+    mat4x4_t model)
+{
+    mesh_t *mesh = &arena->mesh;
+    if (mesh->verticesLen + verticesLen > arena->verticesCap || mesh->indicesLen + indicesLen > arena->indicesCap)
+    {
+        printf("Mesh arena is full, %d vertices and %d indices\n", arena->verticesCap, arena->indicesCap);
+        exit(EXIT_FAILURE);
+    }
+
+    mat4x4_t normalMatrix = mat4x4_normalMatrix(model);
+    vertex_t *baked = utils_malloc(sizeof(vertex_t) * (verticesLen > 0 ? verticesLen : 1));
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        baked[i] = vertices[i];
+        baked[i].pos = mat4x4_transformPoint(model, vertices[i].pos);
+        baked[i].normal = v3_normalize(mat4x4_transformDir(normalMatrix, vertices[i].normal));
+        baked[i].tangent = v3_normalize(mat4x4_transformDir(model, vertices[i].tangent));
+    }
+
+    mesharena_range_t range;
+    range.firstIndex = mesh->indicesLen;
+    range.indicesLen = indicesLen;
+    range.baseVertex = mesh->verticesLen;
+
+    glstate_bindVertexArray(mesh->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->VBO);
+    glBufferSubData(
+        GL_ARRAY_BUFFER, (size_t)range.baseVertex * sizeof(vertex_t), (size_t)verticesLen * sizeof(vertex_t), baked);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
+    glBufferSubData(
+        GL_ELEMENT_ARRAY_BUFFER, (size_t)range.firstIndex * sizeof(unsigned int), (size_t)indicesLen * sizeof(unsigned int), indices);
+    glstate_bindVertexArray(0);
+    free(baked);
+
+    mesh->verticesLen += verticesLen;
+    mesh->indicesLen += indicesLen;
+    return range;
+}
+
+// the per draw arrays share one capacity
+static void reserveDraws(mesharena_t *arena, int drawsLen)
+{
+    int cap = arena->drawsCap;
+    arena->drawCounts = utils_reserve(arena->drawCounts, &cap, drawsLen, sizeof(int));
+    cap = arena->drawsCap;
+    arena->drawOffsets = utils_reserve(arena->drawOffsets, &cap, drawsLen, sizeof(void *));
+    cap = arena->drawsCap;
+    arena->drawBaseVertices = utils_reserve(arena->drawBaseVertices, &cap, drawsLen, sizeof(int));
+    arena->drawsCap = cap;
+}
+
+// draws every range with the same textures in one call, with a program that
+// takes its matrices per instance like object_instanced.vs. the meshes are
+// already in world space, so the instance attributes are held at identity rows
+// instead of read from a buffer
+void mesharena_draw(
+    mesharena_t *arena, mesh_uniforms_t uniforms,
+    texture_t *textures, int texturesLen,
+    mesharena_range_t *ranges, int rangesLen)
+{
+    if (rangesLen == 0)
+    {
+        return;
+    }
+
+    mesh_t material = arena->mesh;
+    material.textures = textures;
+    material.texturesLen = texturesLen;
+    mesh_bind(material, uniforms);
+    reserveDraws(arena, rangesLen);
+
+    // model rows at 4 to 6, normal matrix rows at 7 to 9, the arena's VAO
+    // never enables them as arrays
+    for (int row = 0; row < 3; ++row)
+    {
+        float identity[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        identity[row] = 1.0f;
+        glVertexAttrib4fv(4 + row, identity);
+        glVertexAttrib4fv(7 + row, identity);
+    }
+
+    for (int i = 0; i < rangesLen; ++i)
+    {
+        arena->drawCounts[i] = ranges[i].indicesLen;
+        arena->drawOffsets[i] = (void *)((size_t)ranges[i].firstIndex * sizeof(unsigned int));
+        arena->drawBaseVertices[i] = ranges[i].baseVertex;
+    }
+    glMultiDrawElementsBaseVertex(
+        GL_TRIANGLES, arena->drawCounts, GL_UNSIGNED_INT,
+        (const void *const *)arena->drawOffsets, rangesLen, arena->drawBaseVertices);
+    RENDERSTATS_COUNT_GL_CALLS(1 + 6);
+}
+
+void mesharena_free(mesharena_t arena)
+{
+    // keeps glstate from eliding a bind to a VAO that reuses the name
+    glstate_bindVertexArray(0);
+    glDeleteVertexArrays(1, &arena.mesh.VAO);
+    glDeleteBuffers(1, &arena.mesh.VBO);
+    glDeleteBuffers(1, &arena.mesh.EBO);
+    free(arena.drawCounts);
+    free(arena.drawOffsets);
+    free(arena.drawBaseVertices);
+}
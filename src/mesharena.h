@@ -0,0 +1,47 @@
+#ifndef MESHARENA_H
+#define MESHARENA_H
+
+#include "mat4x4.h"
+#include "mesh.h"
+#include "shader.h"
+#include "texture.h"
+
+// where a mesh was placed in its arena
+typedef struct mesharena_range
+{
+    int firstIndex;
+    int indicesLen;
+    int baseVertex;
+} mesharena_range_t;
+
+// static meshes suballocated from one shared vertex and index buffer, so any
+// number of them sharing a material draw with a single call
+typedef struct mesharena
+{
+    // the shared buffers, drawn through mesh_bind with the textures swapped in
+    mesh_t mesh;
+    int verticesCap;
+    int indicesCap;
+    // per draw arguments, kept between draws to avoid allocating
+    int *drawCounts;
+    void **drawOffsets;
+    int *drawBaseVertices;
+    int drawsCap;
+} mesharena_t;
+
+mesharena_t mesharena_create(int verticesCap, int indicesCap);
+
+mesharena_range_t mesharena_add(
+    mesharena_t *arena,
+    vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen,
+    mat4x4_t model);
+
+void mesharena_draw(
+    mesharena_t *arena, mesh_uniforms_t uniforms,
+    texture_t *textures, int texturesLen,
+    mesharena_range_t *ranges, int rangesLen);
+
+void mesharena_free(mesharena_t arena);
+
+#endif
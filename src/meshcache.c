@@ -0,0 +1,238 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <sys/stat.h>
+#include "meshcache.h"
+#include "meshopt.h"
+
+// bump whenever the header, vertex_t or packedVertex_t layout or encoding changes
+static const uint32_t MESHCACHE_VERSION = 5;
+static const char MESHCACHE_MAGIC[4] = {'M', 'E', 'S', 'H'};
+static const char *MESHCACHE_EXTENSION = ".mesh";
+static const int MESHCACHE_ALIGNMENT = 16;
+
+// file layout: header, then the vertex, packed vertex and index streams, each
+// starting on a 16 byte boundary. the packed stream is what gets uploaded, the
+// full one is kept for bounds and lods. everything is native endian
+typedef struct meshcache_header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexSize;
+    uint32_t packedVertexSize;
+    uint32_t indexSize;
+    uint32_t verticesLen;
+    uint32_t indicesLen;
+    uint64_t verticesOffset;
+    uint64_t packedVerticesOffset;
+    uint64_t indicesOffset;
+    float boundsMin[3];
+    float boundsMax[3];
+    // only floats, so it has no padding
+    meshQuantization_t quantization;
+} meshcache_header_t;
+
+static uint64_t alignOffset(uint64_t offset)
+{
+    return (offset + MESHCACHE_ALIGNMENT - 1) & ~(uint64_t)(MESHCACHE_ALIGNMENT - 1);
+}
+
+static bool writePadding(FILE *file, uint64_t from, uint64_t to)
+{
+    static const char zeros[16] = {0};
+    return fwrite(zeros, 1, to - from, file) == to - from;
+}
+
+bool meshcache_write(
+    char *path,
+    vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen)
+{
+    meshcache_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESHCACHE_MAGIC, sizeof(header.magic));
+    header.version = MESHCACHE_VERSION;
+    header.vertexSize = sizeof(vertex_t);
+    header.packedVertexSize = sizeof(packedVertex_t);
+    header.indexSize = sizeof(unsigned int);
+    header.verticesLen = verticesLen;
+    header.indicesLen = indicesLen;
+    header.verticesOffset = alignOffset(sizeof(header));
+    header.packedVerticesOffset = alignOffset(header.verticesOffset + (uint64_t)verticesLen * sizeof(vertex_t));
+    header.indicesOffset = alignOffset(header.packedVerticesOffset + (uint64_t)verticesLen * sizeof(packedVertex_t));
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        header.boundsMin[axis] = verticesLen > 0 ? INFINITY : 0.0f;
+        header.boundsMax[axis] = verticesLen > 0 ? -INFINITY : 0.0f;
+    }
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        float pos[3] = {vertices[i].pos.x, vertices[i].pos.y, vertices[i].pos.z};
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            header.boundsMin[axis] = fminf(header.boundsMin[axis], pos[axis]);
+            header.boundsMax[axis] = fmaxf(header.boundsMax[axis], pos[axis]);
+        }
+    }
+
+    packedVertex_t *packed = utils_malloc(sizeof(packedVertex_t) * (verticesLen > 0 ? verticesLen : 1));
+    header.quantization = mesh_quantize(vertices, verticesLen, packed);
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        free(packed);
+        return false;
+    }
+
+    uint64_t verticesEnd = header.verticesOffset + (uint64_t)verticesLen * sizeof(vertex_t);
+    uint64_t packedVerticesEnd = header.packedVerticesOffset + (uint64_t)verticesLen * sizeof(packedVertex_t);
+    bool success =
+        fwrite(&header, sizeof(header), 1, file) == 1 &&
+        writePadding(file, sizeof(header), header.verticesOffset) &&
+        fwrite(vertices, sizeof(vertex_t), verticesLen, file) == (size_t)verticesLen &&
+        writePadding(file, verticesEnd, header.packedVerticesOffset) &&
+        fwrite(packed, sizeof(packedVertex_t), verticesLen, file) == (size_t)verticesLen &&
+        writePadding(file, packedVerticesEnd, header.indicesOffset) &&
+        fwrite(indices, sizeof(unsigned int), indicesLen, file) == (size_t)indicesLen;
+    free(packed);
+
+    success = fclose(file) == 0 && success;
+    if (!success)
+    {
+        remove(path);
+    }
+    return success;
+}
+
+// maps a cache file, the arrays point straight into the mapping so the packed
+// vertices can be handed to glBufferData without any parsing or packing. returns false if the file isn't a
+// valid cache for this build, including when an index is out of range, so a
+// stale or damaged cache can't make draws read past the vertex buffer
+bool meshcache_load(meshcache_t *cache, char *path)
+{
+    struct stat info;
+    if (stat(path, &info) != 0 || (size_t)info.st_size < sizeof(meshcache_header_t))
+    {
+        return false;
+    }
+
+    mappedFile_t file = utils_mapFile(path);
+    meshcache_header_t header;
+    memcpy(&header, file.data, sizeof(header));
+
+    bool isValid =
+        file.len >= sizeof(header) &&
+        memcmp(header.magic, MESHCACHE_MAGIC, sizeof(header.magic)) == 0 &&
+        header.version == MESHCACHE_VERSION &&
+        header.vertexSize == sizeof(vertex_t) &&
+        header.packedVertexSize == sizeof(packedVertex_t) &&
+        header.indexSize == sizeof(unsigned int) &&
+        header.verticesLen <= INT_MAX &&
+        header.indicesLen <= INT_MAX &&
+        header.verticesOffset % MESHCACHE_ALIGNMENT == 0 &&
+        header.packedVerticesOffset % MESHCACHE_ALIGNMENT == 0 &&
+        header.indicesOffset % MESHCACHE_ALIGNMENT == 0 &&
+        header.verticesOffset + (uint64_t)header.verticesLen * sizeof(vertex_t) <= file.len &&
+        header.packedVerticesOffset + (uint64_t)header.verticesLen * sizeof(packedVertex_t) <= file.len &&
+        header.indicesOffset + (uint64_t)header.indicesLen * sizeof(unsigned int) <= file.len;
+
+    if (isValid)
+    {
+        // the largest index rather than an early exit, so the loop vectorizes
+        unsigned int *indices = (unsigned int *)(file.data + header.indicesOffset);
+        unsigned int maxIndex = 0;
+        for (uint32_t i = 0; i < header.indicesLen; ++i)
+        {
+            maxIndex = indices[i] > maxIndex ? indices[i] : maxIndex;
+        }
+        isValid = header.indicesLen == 0 || maxIndex < header.verticesLen;
+    }
+
+    if (!isValid)
+    {
+        utils_unmapFile(file);
+        return false;
+    }
+
+    cache->file = file;
+    cache->vertices = (vertex_t *)(file.data + header.verticesOffset);
+    cache->packedVertices = (packedVertex_t *)(file.data + header.packedVerticesOffset);
+    cache->verticesLen = header.verticesLen;
+    cache->indices = (unsigned int *)(file.data + header.indicesOffset);
+    cache->indicesLen = header.indicesLen;
+    cache->boundsMin = v3_create(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    cache->boundsMax = v3_create(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    cache->quantization = header.quantization;
+    return true;
+}
+
+// loads <objPath>.mesh when it is newer than the obj. otherwise the obj is parsed,
+// optimised and written out as the cache for next time
+meshcache_t meshcache_loadObj(char *objPath)
+{
+    size_t pathLen = strlen(objPath);
+    char *cachePath = utils_malloc(pathLen + strlen(MESHCACHE_EXTENSION) + 1);
+    strcpy(cachePath, objPath);
+    strcpy(cachePath + pathLen, MESHCACHE_EXTENSION);
+
+    meshcache_t cache;
+    struct stat objInfo;
+    struct stat cacheInfo;
+    bool isFresh =
+        stat(objPath, &objInfo) == 0 &&
+        stat(cachePath, &cacheInfo) == 0 &&
+        cacheInfo.st_mtime > objInfo.st_mtime;
+
+    if (isFresh && meshcache_load(&cache, cachePath))
+    {
+        free(cachePath);
+        return cache;
+    }
+
+    vertex_t *vertices;
+    unsigned int *indices;
+    int indicesLen;
+    int verticesLen = mesh_loadVertsParallel(&vertices, &indices, &indicesLen, objPath, utils_getNumCores());
+    meshopt_optimizeVertexCache(indices, indicesLen, verticesLen);
+    verticesLen = meshopt_optimizeVertexFetch(vertices, verticesLen, indices, indicesLen);
+
+    if (meshcache_write(cachePath, vertices, verticesLen, indices, indicesLen) &&
+        meshcache_load(&cache, cachePath))
+    {
+        free(vertices);
+        free(indices);
+    }
+    else
+    {
+        printf("failed to write mesh cache: %s\n", cachePath);
+        memset(&cache, 0, sizeof(cache));
+        cache.vertices = vertices;
+        cache.verticesLen = verticesLen;
+        cache.indices = indices;
+        cache.indicesLen = indicesLen;
+        cache.packedVertices = utils_malloc(sizeof(packedVertex_t) * (verticesLen > 0 ? verticesLen : 1));
+        cache.quantization = mesh_quantize(vertices, verticesLen, cache.packedVertices);
+    }
+
+    free(cachePath);
+    return cache;
+}
+
+void meshcache_free(meshcache_t cache)
+{
+    if (cache.file.data != NULL)
+    {
+        utils_unmapFile(cache.file);
+    }
+    else
+    {
+        free(cache.vertices);
+        free(cache.packedVertices);
+        free(cache.indices);
+    }
+}
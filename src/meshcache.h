@@ -0,0 +1,34 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <stdbool.h>
+#include "mesh.h"
+#include "utils.h"
+
+typedef struct meshcache
+{
+    // backing storage, the arrays below point into it when it's mapped
+    mappedFile_t file;
+    vertex_t *vertices;
+    // the same vertices packed for upload, relative to quantization
+    packedVertex_t *packedVertices;
+    meshQuantization_t quantization;
+    int verticesLen;
+    unsigned int *indices;
+    int indicesLen;
+    v3_t boundsMin;
+    v3_t boundsMax;
+} meshcache_t;
+
+bool meshcache_write(
+    char *path,
+    vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen);
+
+bool meshcache_load(meshcache_t *cache, char *path);
+
+meshcache_t meshcache_loadObj(char *objPath);
+
+void meshcache_free(meshcache_t cache);
+
+#endif
@@ -0,0 +1,717 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <float.h>
+#include <stdint.h>
+#include "meshopt.h"
+#include "utils.h"
+
+// scoring constants from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+static const int CACHE_SIZE = 32;
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRI_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+// each LOD aims for this fraction of the previous level's triangles
+static const float LOD_REDUCTION = 0.5f;
+// levels that save less than this over the previous one are dropped
+static const float MIN_LOD_SAVING = 0.1f;
+
+static float vertexScore(int cachePos, int remainingValence)
+{
+    if (remainingValence == 0)
+    {
+        // no triangles left to use this vertex
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePos >= 0)
+    {
+        if (cachePos < 3)
+        {
+            // the most recent triangle's vertices get a fixed score so it isn't
+            // simply repeated
+            score = LAST_TRI_SCORE;
+        }
+        else
+        {
+            float scaler = 1.0f / (CACHE_SIZE - 3);
+            score = powf(1.0f - (cachePos - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+
+    // favour vertices with few triangles left, to finish them off
+    score += VALENCE_BOOST_SCALE * powf((float)remainingValence, -VALENCE_BOOST_POWER);
+    return score;
+}
+
+// average cache miss ratio: transformed vertices per triangle, for a FIFO post
+// transform cache of cacheSize entries. 0.5 is ideal for a regular grid, 3 is worst
+float meshopt_calcACMR(unsigned int *indices, int indicesLen, int verticesLen, int cacheSize)
+{
+    if (indicesLen < 3)
+    {
+        return 0.0f;
+    }
+
+    // a vertex is in the cache while fewer than cacheSize misses happened since it was added
+    int *cacheTimestamps = utils_malloc(sizeof(int) * verticesLen);
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        cacheTimestamps[i] = -cacheSize - 1;
+    }
+
+    int misses = 0;
+    for (int i = 0; i < indicesLen; ++i)
+    {
+        unsigned int index = indices[i];
+        if (misses - cacheTimestamps[index] > cacheSize)
+        {
+            cacheTimestamps[index] = misses;
+            ++misses;
+        }
+    }
+
+    free(cacheTimestamps);
+    return (float)misses / (indicesLen / 3);
+}
+
+// reorders triangles, in place, so that consecutive triangles reuse recently
+// transformed vertices
+void meshopt_optimizeVertexCache(unsigned int *indices, int indicesLen, int verticesLen)
+{
+    int trisLen = indicesLen / 3;
+    if (trisLen < 2)
+    {
+        return;
+    }
+
+    // vertex -> triangles adjacency, as offsets into one array
+    int *valence = utils_malloc(sizeof(int) * verticesLen);
+    int *adjacencyOffsets = utils_malloc(sizeof(int) * (verticesLen + 1));
+    int *adjacency = utils_malloc(sizeof(int) * trisLen * 3);
+    memset(valence, 0, sizeof(int) * verticesLen);
+
+    for (int i = 0; i < trisLen * 3; ++i)
+    {
+        ++valence[indices[i]];
+    }
+    adjacencyOffsets[0] = 0;
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        adjacencyOffsets[i + 1] = adjacencyOffsets[i] + valence[i];
+        valence[i] = 0;
+    }
+    for (int i = 0; i < trisLen * 3; ++i)
+    {
+        unsigned int vert = indices[i];
+        adjacency[adjacencyOffsets[vert] + valence[vert]++] = i / 3;
+    }
+
+    int *cachePos = utils_malloc(sizeof(int) * verticesLen);
+    float *vertScores = utils_malloc(sizeof(float) * verticesLen);
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        cachePos[i] = -1;
+        vertScores[i] = vertexScore(-1, valence[i]);
+    }
+
+    float *triScores = utils_malloc(sizeof(float) * trisLen);
+    bool *triEmitted = utils_malloc(sizeof(bool) * trisLen);
+    for (int i = 0; i < trisLen; ++i)
+    {
+        triScores[i] = vertScores[indices[i * 3]] + vertScores[indices[i * 3 + 1]] + vertScores[indices[i * 3 + 2]];
+        triEmitted[i] = false;
+    }
+
+    unsigned int *result = utils_malloc(sizeof(unsigned int) * trisLen * 3);
+    // the cache can briefly hold 3 extra entries while a triangle is added
+    int cache[CACHE_SIZE + 3];
+    int cacheLen = 0;
+    int newCache[CACHE_SIZE + 3];
+
+    int bestTri = 0;
+    for (int i = 1; i < trisLen; ++i)
+    {
+        if (triScores[i] > triScores[bestTri])
+        {
+            bestTri = i;
+        }
+    }
+
+    int nextUnemitted = 0;
+
+    for (int emitted = 0; emitted < trisLen; ++emitted)
+    {
+        if (bestTri < 0)
+        {
+            // nothing in the cache connects to a remaining triangle, restart from
+            // the next one in the original order
+            while (triEmitted[nextUnemitted])
+            {
+                ++nextUnemitted;
+            }
+            bestTri = nextUnemitted;
+        }
+
+        triEmitted[bestTri] = true;
+        unsigned int *tri = &indices[bestTri * 3];
+        result[emitted * 3] = tri[0];
+        result[emitted * 3 + 1] = tri[1];
+        result[emitted * 3 + 2] = tri[2];
+
+        // remove the triangle from its vertices' adjacency
+        for (int j = 0; j < 3; ++j)
+        {
+            unsigned int vert = tri[j];
+            int *vertAdjacency = &adjacency[adjacencyOffsets[vert]];
+            for (int k = 0; k < valence[vert]; ++k)
+            {
+                if (vertAdjacency[k] == bestTri)
+                {
+                    vertAdjacency[k] = vertAdjacency[valence[vert] - 1];
+                    break;
+                }
+            }
+            --valence[vert];
+        }
+
+        // move the triangle's vertices to the front of the LRU cache
+        int newCacheLen = 0;
+        for (int j = 0; j < 3; ++j)
+        {
+            newCache[newCacheLen++] = tri[j];
+        }
+        for (int j = 0; j < cacheLen; ++j)
+        {
+            int vert = cache[j];
+            if (vert != (int)tri[0] && vert != (int)tri[1] && vert != (int)tri[2])
+            {
+                newCache[newCacheLen++] = vert;
+            }
+        }
+
+        // rescore everything that was in the cache, including evicted vertices
+        bestTri = -1;
+        float bestScore = -1.0f;
+        for (int j = 0; j < newCacheLen; ++j)
+        {
+            int vert = newCache[j];
+            cachePos[vert] = j < CACHE_SIZE ? j : -1;
+            float newScore = vertexScore(cachePos[vert], valence[vert]);
+            float scoreDelta = newScore - vertScores[vert];
+            vertScores[vert] = newScore;
+
+            int *vertAdjacency = &adjacency[adjacencyOffsets[vert]];
+            for (int k = 0; k < valence[vert]; ++k)
+            {
+                int adjTri = vertAdjacency[k];
+                triScores[adjTri] += scoreDelta;
+                if (j < CACHE_SIZE && triScores[adjTri] > bestScore)
+                {
+                    bestScore = triScores[adjTri];
+                    bestTri = adjTri;
+                }
+            }
+        }
+
+        cacheLen = newCacheLen < CACHE_SIZE ? newCacheLen : CACHE_SIZE;
+        memcpy(cache, newCache, sizeof(int) * cacheLen);
+    }
+
+    memcpy(indices, result, sizeof(unsigned int) * trisLen * 3);
+
+    free(result);
+    free(triEmitted);
+    free(triScores);
+    free(vertScores);
+    free(cachePos);
+    free(adjacency);
+    free(adjacencyOffsets);
+    free(valence);
+}
+
+// reorders vertices, in place, into the order the indices first reference them
+// so vertex fetches walk the buffer linearly. unreferenced vertices are dropped,
+// returns the new vertex count
+int meshopt_optimizeVertexFetch(vertex_t *vertices, int verticesLen, unsigned int *indices, int indicesLen)
+{
+    int *remap = utils_malloc(sizeof(int) * verticesLen);
+    memset(remap, -1, sizeof(int) * verticesLen);
+
+    vertex_t *reordered = utils_malloc(sizeof(vertex_t) * (verticesLen > 0 ? verticesLen : 1));
+    int reorderedLen = 0;
+
+    for (int i = 0; i < indicesLen; ++i)
+    {
+        unsigned int index = indices[i];
+        if (remap[index] == -1)
+        {
+            remap[index] = reorderedLen;
+            reordered[reorderedLen++] = vertices[index];
+        }
+        indices[i] = remap[index];
+    }
+
+    memcpy(vertices, reordered, sizeof(vertex_t) * reorderedLen);
+
+    free(reordered);
+    free(remap);
+    return reorderedLen;
+}
+
+// sum of squared distances to a set of planes, weighted by triangle area.
+// dividing by the weight gives the mean squared distance
+typedef struct quadric
+{
+    double a2, ab, ac, ad;
+    double b2, bc, bd;
+    double c2, cd;
+    double d2;
+    double weight;
+} quadric_t;
+
+typedef struct collapse
+{
+    float cost;
+    int from;
+    int to;
+} collapse_t;
+
+typedef struct lodJob
+{
+    vertex_t *vertices;
+    int verticesLen;
+    unsigned int *indices;
+    int indicesLen;
+    unsigned int **results;
+    int *resultsLen;
+    float *errors;
+} lodJob_t;
+
+static void addPlane(quadric_t *q, v3_t p0, v3_t p1, v3_t p2)
+{
+    v3_t n = v3_cross(v3_sub(p1, p0), v3_sub(p2, p0));
+    float len = v3_len(n);
+    if (len == 0.0f)
+    {
+        return;
+    }
+    double weight = 0.5 * len;
+    double a = n.x / len;
+    double b = n.y / len;
+    double c = n.z / len;
+    double d = -(a * p0.x + b * p0.y + c * p0.z);
+    q->a2 += weight * a * a;
+    q->ab += weight * a * b;
+    q->ac += weight * a * c;
+    q->ad += weight * a * d;
+    q->b2 += weight * b * b;
+    q->bc += weight * b * c;
+    q->bd += weight * b * d;
+    q->c2 += weight * c * c;
+    q->cd += weight * c * d;
+    q->d2 += weight * d * d;
+    q->weight += weight;
+}
+
+static void addQuadric(quadric_t *q, const quadric_t *r)
+{
+    q->a2 += r->a2;
+    q->ab += r->ab;
+    q->ac += r->ac;
+    q->ad += r->ad;
+    q->b2 += r->b2;
+    q->bc += r->bc;
+    q->bd += r->bd;
+    q->c2 += r->c2;
+    q->cd += r->cd;
+    q->d2 += r->d2;
+    q->weight += r->weight;
+}
+
+// mean squared distance from p to the planes of both quadrics
+static float collapseCost(const quadric_t *q, const quadric_t *r, v3_t p)
+{
+    quadric_t sum = *q;
+    addQuadric(&sum, r);
+    double x = p.x, y = p.y, z = p.z;
+    double error =
+        sum.a2 * x * x + 2.0 * sum.ab * x * y + 2.0 * sum.ac * x * z + 2.0 * sum.ad * x +
+        sum.b2 * y * y + 2.0 * sum.bc * y * z + 2.0 * sum.bd * y +
+        sum.c2 * z * z + 2.0 * sum.cd * z +
+        sum.d2;
+    return sum.weight > 0.0 ? (float)fabs(error / sum.weight) : 0.0f;
+}
+
+static uint32_t hashPos(v3_t pos)
+{
+    uint32_t words[3];
+    memcpy(words, &pos, sizeof(words));
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 3; ++i)
+    {
+        hash = (hash ^ words[i]) * 16777619u;
+        hash ^= hash >> 15;
+    }
+    return hash;
+}
+
+// the first vertex with each position. vertices split for normals or texture
+// coords share one
+static int *weldPositions(vertex_t *vertices, int verticesLen)
+{
+    int *canonical = utils_malloc(sizeof(int) * (verticesLen > 0 ? verticesLen : 1));
+    int tableCap = 1;
+    while (tableCap < verticesLen * 2)
+    {
+        tableCap *= 2;
+    }
+    int *table = utils_malloc(sizeof(int) * tableCap);
+    memset(table, -1, sizeof(int) * tableCap);
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        uint32_t slot = hashPos(vertices[i].pos) & (tableCap - 1);
+        while (table[slot] != -1 && memcmp(&vertices[table[slot]].pos, &vertices[i].pos, sizeof(v3_t)) != 0)
+        {
+            slot = (slot + 1) & (tableCap - 1);
+        }
+        if (table[slot] == -1)
+        {
+            table[slot] = i;
+        }
+        canonical[i] = table[slot];
+    }
+    free(table);
+    return canonical;
+}
+
+static int compareEdges(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int compareCollapses(const void *a, const void *b)
+{
+    float x = ((const collapse_t *)a)->cost;
+    float y = ((const collapse_t *)b)->cost;
+    return x < y ? -1 : x > y;
+}
+
+// positions on an attribute seam or an open border can't move without tearing
+// the mesh or shrinking its outline, so they're never collapsed away
+static bool *findLocked(int *canonical, int verticesLen, unsigned int *indices, int indicesLen)
+{
+    bool *locked = utils_malloc(sizeof(bool) * (verticesLen > 0 ? verticesLen : 1));
+    memset(locked, 0, sizeof(bool) * (verticesLen > 0 ? verticesLen : 1));
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        if (canonical[i] != i)
+        {
+            locked[i] = true;
+            locked[canonical[i]] = true;
+        }
+    }
+
+    // an edge only one triangle uses is on the border
+    uint64_t *edges = utils_malloc(sizeof(uint64_t) * (indicesLen > 0 ? indicesLen : 1));
+    for (int i = 0; i < indicesLen; ++i)
+    {
+        uint64_t a = canonical[indices[i]];
+        uint64_t b = canonical[indices[i - i % 3 + (i + 1) % 3]];
+        edges[i] = a < b ? (a << 32) | b : (b << 32) | a;
+    }
+    qsort(edges, indicesLen, sizeof(uint64_t), compareEdges);
+    for (int i = 0; i < indicesLen;)
+    {
+        int run = 1;
+        while (i + run < indicesLen && edges[i + run] == edges[i])
+        {
+            ++run;
+        }
+        if (run == 1)
+        {
+            locked[edges[i] >> 32] = true;
+            locked[edges[i] & 0xffffffff] = true;
+        }
+        i += run;
+    }
+    free(edges);
+
+    // seam siblings follow their canonical vertex
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        locked[i] = locked[canonical[i]];
+    }
+    return locked;
+}
+
+// whether tri has a corner at the same position as vertex
+static bool touchesPosition(unsigned int *tri, int *canonical, int vertex)
+{
+    return canonical[tri[0]] == canonical[vertex] || canonical[tri[1]] == canonical[vertex] || canonical[tri[2]] == canonical[vertex];
+}
+
+// true when moving from to to would turn any of from's remaining triangles over
+static bool collapseFlips(vertex_t *vertices, int *canonical, unsigned int *indices, int *tris, int trisLen, int from, int to)
+{
+    for (int i = 0; i < trisLen; ++i)
+    {
+        unsigned int *tri = &indices[tris[i] * 3];
+        if (touchesPosition(tri, canonical, to))
+        {
+            continue;
+        }
+        v3_t before[3];
+        v3_t after[3];
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            before[corner] = vertices[tri[corner]].pos;
+            after[corner] = (int)tri[corner] == from ? vertices[to].pos : before[corner];
+        }
+        v3_t n0 = v3_cross(v3_sub(before[1], before[0]), v3_sub(before[2], before[0]));
+        v3_t n1 = v3_cross(v3_sub(after[1], after[0]), v3_sub(after[2], after[0]));
+        if (v3_dot(n0, n1) <= 0.0f)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// quadric error metric simplification by half edge collapse: a vertex merges
+// into a neighbour and takes its attributes, so no new vertices are made and
+// the result indexes the same vertex buffer. works in passes, each collapsing
+// the cheapest edges whose neighbourhoods don't overlap, until at most
+// targetIndicesLen indices remain or the next collapse would move the surface
+// by more than maxError. result needs room for indicesLen indices, error gets
+// the largest distance moved. returns the number of indices written
+int meshopt_simplify(
+    vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen,
+    int targetIndicesLen, float maxError,
+    unsigned int *result, float *error)
+{
+    int *canonical = weldPositions(vertices, verticesLen);
+    bool *locked = findLocked(canonical, verticesLen, indices, indicesLen);
+
+    // quadrics are kept per position, so seam siblings share one
+    quadric_t *quadrics = utils_malloc(sizeof(quadric_t) * (verticesLen > 0 ? verticesLen : 1));
+    memset(quadrics, 0, sizeof(quadric_t) * (verticesLen > 0 ? verticesLen : 1));
+    for (int i = 0; i < indicesLen; i += 3)
+    {
+        quadric_t plane = {0};
+        addPlane(&plane, vertices[indices[i]].pos, vertices[indices[i + 1]].pos, vertices[indices[i + 2]].pos);
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            addQuadric(&quadrics[canonical[indices[i + corner]]], &plane);
+        }
+    }
+
+    memcpy(result, indices, sizeof(unsigned int) * indicesLen);
+    int resultLen = indicesLen;
+    float maxCost = maxError * maxError;
+    float reachedCost = 0.0f;
+
+    int *collapsedTo = utils_malloc(sizeof(int) * (verticesLen > 0 ? verticesLen : 1));
+    bool *isTouched = utils_malloc(sizeof(bool) * (verticesLen > 0 ? verticesLen : 1));
+    int *triOffsets = utils_malloc(sizeof(int) * (verticesLen + 1));
+    int *vertexTris = utils_malloc(sizeof(int) * (indicesLen > 0 ? indicesLen : 1));
+    collapse_t *collapses = utils_malloc(sizeof(collapse_t) * (indicesLen > 0 ? indicesLen * 2 : 1));
+
+    bool isDone = false;
+    while (!isDone && resultLen > targetIndicesLen)
+    {
+        // triangles around each vertex, bucketed with a counting sort
+        memset(triOffsets, 0, sizeof(int) * (verticesLen + 1));
+        for (int i = 0; i < resultLen; ++i)
+        {
+            ++triOffsets[result[i] + 1];
+        }
+        for (int v = 0; v < verticesLen; ++v)
+        {
+            triOffsets[v + 1] += triOffsets[v];
+        }
+        for (int i = 0; i < resultLen; ++i)
+        {
+            vertexTris[triOffsets[result[i]]++] = i / 3;
+        }
+        for (int v = verticesLen; v > 0; --v)
+        {
+            triOffsets[v] = triOffsets[v - 1];
+        }
+        triOffsets[0] = 0;
+
+        // both directions of every edge
+        int collapsesLen = 0;
+        for (int i = 0; i < resultLen; ++i)
+        {
+            int a = result[i];
+            int b = result[i - i % 3 + (i + 1) % 3];
+            if (!locked[a])
+            {
+                collapses[collapsesLen++] = (collapse_t){
+                    collapseCost(&quadrics[canonical[a]], &quadrics[canonical[b]], vertices[b].pos), a, b};
+            }
+            if (!locked[b])
+            {
+                collapses[collapsesLen++] = (collapse_t){
+                    collapseCost(&quadrics[canonical[b]], &quadrics[canonical[a]], vertices[a].pos), b, a};
+            }
+        }
+        qsort(collapses, collapsesLen, sizeof(collapse_t), compareCollapses);
+
+        for (int v = 0; v < verticesLen; ++v)
+        {
+            collapsedTo[v] = v;
+        }
+        memset(isTouched, 0, sizeof(bool) * (verticesLen > 0 ? verticesLen : 1));
+
+        // a collapse touches every vertex around it, so those that follow in
+        // the same pass see unchanged neighbourhoods
+        int trisLen = resultLen / 3;
+        int numCollapsed = 0;
+        for (int i = 0; i < collapsesLen && trisLen * 3 > targetIndicesLen; ++i)
+        {
+            collapse_t c = collapses[i];
+            if (c.cost > maxCost)
+            {
+                isDone = true;
+                break;
+            }
+            if (isTouched[c.from] || isTouched[c.to])
+            {
+                continue;
+            }
+            int *tris = &vertexTris[triOffsets[c.from]];
+            int fromTrisLen = triOffsets[c.from + 1] - triOffsets[c.from];
+            if (collapseFlips(vertices, canonical, result, tris, fromTrisLen, c.from, c.to))
+            {
+                continue;
+            }
+
+            for (int t = 0; t < fromTrisLen; ++t)
+            {
+                unsigned int *tri = &result[tris[t] * 3];
+                trisLen -= touchesPosition(tri, canonical, c.to);
+                isTouched[tri[0]] = true;
+                isTouched[tri[1]] = true;
+                isTouched[tri[2]] = true;
+            }
+            isTouched[c.to] = true;
+            collapsedTo[c.from] = c.to;
+            addQuadric(&quadrics[canonical[c.to]], &quadrics[canonical[c.from]]);
+            reachedCost = fmaxf(reachedCost, c.cost);
+            ++numCollapsed;
+        }
+        if (numCollapsed == 0)
+        {
+            break;
+        }
+
+        // drop the triangles the collapses folded flat
+        int writeLen = 0;
+        for (int i = 0; i < resultLen; i += 3)
+        {
+            unsigned int a = collapsedTo[result[i]];
+            unsigned int b = collapsedTo[result[i + 1]];
+            unsigned int c = collapsedTo[result[i + 2]];
+            if (canonical[a] != canonical[b] && canonical[b] != canonical[c] && canonical[c] != canonical[a])
+            {
+                result[writeLen++] = a;
+                result[writeLen++] = b;
+                result[writeLen++] = c;
+            }
+        }
+        resultLen = writeLen;
+    }
+
+    if (error != NULL)
+    {
+        *error = sqrtf(reachedCost);
+    }
+
+    free(collapses);
+    free(vertexTris);
+    free(triOffsets);
+    free(isTouched);
+    free(collapsedTo);
+    free(quadrics);
+    free(locked);
+    free(canonical);
+    return resultLen;
+}
+
+static void lodJob(void *ctx, int index)
+{
+    lodJob_t *job = ctx;
+    int target = job->indicesLen;
+    for (int level = 0; level <= index; ++level)
+    {
+        target = (int)(target * LOD_REDUCTION) / 3 * 3;
+    }
+    job->results[index] = utils_malloc(sizeof(unsigned int) * (job->indicesLen > 0 ? job->indicesLen : 1));
+    job->resultsLen[index] = meshopt_simplify(
+        job->vertices, job->verticesLen, job->indices, job->indicesLen,
+        target, FLT_MAX, job->results[index], &job->errors[index]);
+}
+
+// simplifies the mesh to a chain of up to maxLods levels, the first being the
+// mesh itself. every level is simplified from the full mesh on its own thread.
+// lodIndices gets the levels' indices one after another, starting with the
+// original ones, and lods where each level is. returns the number of levels
+int meshopt_generateLods(
+    vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen,
+    int maxLods, int numThreads,
+    unsigned int **lodIndices, mesh_lod_t *lods)
+{
+    int levelsLen = maxLods - 1;
+    lodJob_t job;
+    job.vertices = vertices;
+    job.verticesLen = verticesLen;
+    job.indices = indices;
+    job.indicesLen = indicesLen;
+    job.results = utils_malloc(sizeof(unsigned int *) * (levelsLen > 0 ? levelsLen : 1));
+    job.resultsLen = utils_malloc(sizeof(int) * (levelsLen > 0 ? levelsLen : 1));
+    job.errors = utils_malloc(sizeof(float) * (levelsLen > 0 ? levelsLen : 1));
+    utils_parallelFor(levelsLen, numThreads, lodJob, &job);
+
+    int totalLen = indicesLen;
+    for (int i = 0; i < levelsLen; ++i)
+    {
+        totalLen += job.resultsLen[i];
+    }
+    *lodIndices = utils_malloc(sizeof(unsigned int) * (totalLen > 0 ? totalLen : 1));
+    memcpy(*lodIndices, indices, sizeof(unsigned int) * indicesLen);
+    lods[0].firstIndex = 0;
+    lods[0].indicesLen = indicesLen;
+    lods[0].error = 0.0f;
+
+    // a level that barely simplified further, usually because what's left is
+    // locked, isn't worth a draw range
+    int lodsLen = 1;
+    int nextIndex = indicesLen;
+    for (int i = 0; i < levelsLen; ++i)
+    {
+        if (job.resultsLen[i] <= lods[lodsLen - 1].indicesLen * (1.0f - MIN_LOD_SAVING))
+        {
+            memcpy(*lodIndices + nextIndex, job.results[i], sizeof(unsigned int) * job.resultsLen[i]);
+            lods[lodsLen].firstIndex = nextIndex;
+            lods[lodsLen].indicesLen = job.resultsLen[i];
+            lods[lodsLen].error = job.errors[i];
+            nextIndex += job.resultsLen[i];
+            ++lodsLen;
+        }
+        free(job.results[i]);
+    }
+
+    free(job.results);
+    free(job.resultsLen);
+    free(job.errors);
+    return lodsLen;
+}
@@ -0,0 +1,24 @@
+#ifndef MESHOPT_H
+#define MESHOPT_H
+
+#include "mesh.h"
+
+float meshopt_calcACMR(unsigned int *indices, int indicesLen, int verticesLen, int cacheSize);
+
+void meshopt_optimizeVertexCache(unsigned int *indices, int indicesLen, int verticesLen);
+
+int meshopt_optimizeVertexFetch(vertex_t *vertices, int verticesLen, unsigned int *indices, int indicesLen);
+
+int meshopt_simplify(
+    vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen,
+    int targetIndicesLen, float maxError,
+    unsigned int *result, float *error);
+
+int meshopt_generateLods(
+    vertex_t *vertices, int verticesLen,
+    unsigned int *indices, int indicesLen,
+    int maxLods, int numThreads,
+    unsigned int **lodIndices, mesh_lod_t *lods);
+
+#endif
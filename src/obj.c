@@ -0,0 +1,785 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include "obj.h"
+#include "v3stream.h"
+#include "utils.h"
+
+// several chunks per thread so uneven chunks still balance out
+static const int CHUNKS_PER_THREAD = 4;
+static const size_t MIN_CHUNK_SIZE = 1 << 16;
+
+typedef struct parseJob
+{
+    obj_t *chunks;
+    const char **chunkStarts;
+    obj_t *obj;
+    int *positionsOffsets;
+    int *texCoordsOffsets;
+    int *normalsOffsets;
+    int *cornersOffsets;
+    int *polygonCornersOffsets;
+    int *polygonsOffsets;
+} parseJob_t;
+
+static const int NORMALS_BATCH_SIZE = 1 << 14;
+
+typedef struct normalsJob
+{
+    obj_t *obj;
+    float cosCrease;
+    v3_t *faceNormals;
+    float *cornerAngles;
+    // corners grouped by welded position, as offsets into groupCorners
+    int *groupOffsets;
+    int *groupCorners;
+    int *cornerGroups;
+    int normalsStart;
+} normalsJob_t;
+
+static inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+static inline const char *skipBlanks(const char *p, const char *end)
+{
+    while (p < end && isBlank(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+static inline const char *skipLine(const char *p, const char *end)
+{
+    const char *lineEnd = memchr(p, '\n', end - p);
+    return lineEnd != NULL ? lineEnd + 1 : end;
+}
+
+// a record normally ends right after its last field, so the newline is checked
+// for directly and only comments or trailing fields need the scan
+static inline const char *finishLine(const char *p, const char *end)
+{
+    while (p < end && (isBlank(*p) || *p == '\r'))
+    {
+        ++p;
+    }
+    if (p < end && *p == '\n')
+    {
+        return p + 1;
+    }
+    return skipLine(p, end);
+}
+
+// utils_reserve only when the array is full, which keeps the common case inline
+static inline void *reserve(void *array, int *capacity, int required, size_t elemSize)
+{
+    return required <= *capacity ? array : utils_reserve(array, capacity, required, elemSize);
+}
+
+static inline bool isLineEnd(char c)
+{
+    return c == '\n' || c == '\r' || c == '#';
+}
+
+// positive indices are 1-based from the start of the file, negative ones count
+// back from the latest record
+static int resolveIndex(int index, int len, unsigned char field, unsigned char *relativeFields)
+{
+    if (index < 0)
+    {
+        *relativeFields |= field;
+        return len + index;
+    }
+    return index - 1;
+}
+
+// parses v, v/vt, v//vn or v/vt/vn. relativeFields gets the fields that used
+// negative indices
+static const char *parseCorner(obj_t *obj, obj_corner_t *corner, unsigned char *relativeFields, const char *p, const char *end)
+{
+    *relativeFields = 0;
+    corner->pos = resolveIndex(utils_parseInt(&p, end), obj->positionsLen, OBJ_RELATIVE_POS, relativeFields);
+    corner->texCoord = OBJ_MISSING_INDEX;
+    corner->normal = OBJ_MISSING_INDEX;
+
+    if (p < end && *p == '/')
+    {
+        ++p;
+        if (p < end && *p != '/')
+        {
+            corner->texCoord = resolveIndex(utils_parseInt(&p, end), obj->texCoordsLen, OBJ_RELATIVE_TEX_COORD, relativeFields);
+        }
+        if (p < end && *p == '/')
+        {
+            ++p;
+            corner->normal = resolveIndex(utils_parseInt(&p, end), obj->normalsLen, OBJ_RELATIVE_NORMAL, relativeFields);
+        }
+    }
+
+    // skip anything unexpected so a malformed corner can't stall the line
+    while (p < end && !isBlank(*p) && *p != '\n')
+    {
+        ++p;
+    }
+
+    return p;
+}
+
+static void addRelativeRef(obj_t *obj, int corner, bool isPolygon, unsigned char fields)
+{
+    obj->relativeRefs = reserve(obj->relativeRefs, &obj->relativeRefsCap, obj->relativeRefsLen + 1, sizeof(obj_relativeRef_t));
+    obj_relativeRef_t *ref = &obj->relativeRefs[obj->relativeRefsLen++];
+    ref->corner = corner;
+    ref->isPolygon = isPolygon;
+    ref->fields = fields;
+}
+
+// corners are parsed onto the end of obj->corners. triangles are kept there, and
+// larger polygons are moved to obj->polygonCorners along with their relative refs
+static const char *parseFace(obj_t *obj, const char *p, const char *end)
+{
+    int first = obj->cornersLen;
+    int firstRef = obj->relativeRefsLen;
+    int numCorners = 0;
+
+    for (;;)
+    {
+        p = skipBlanks(p, end);
+        if (p >= end || isLineEnd(*p))
+        {
+            break;
+        }
+
+        obj->corners = reserve(obj->corners, &obj->cornersCap, first + numCorners + 1, sizeof(obj_corner_t));
+        unsigned char relativeFields;
+        p = parseCorner(obj, &obj->corners[first + numCorners], &relativeFields, p, end);
+        if (relativeFields)
+        {
+            addRelativeRef(obj, first + numCorners, false, relativeFields);
+        }
+        ++numCorners;
+    }
+
+    if (numCorners == 3)
+    {
+        obj->cornersLen += 3;
+    }
+    else if (numCorners > 3)
+    {
+        obj->polygonCorners = reserve(
+            obj->polygonCorners, &obj->polygonCornersCap, obj->polygonCornersLen + numCorners, sizeof(obj_corner_t));
+        memcpy(&obj->polygonCorners[obj->polygonCornersLen], &obj->corners[first], sizeof(obj_corner_t) * numCorners);
+        obj->polygonSizes = reserve(obj->polygonSizes, &obj->polygonsCap, obj->polygonsLen + 1, sizeof(int));
+        obj->polygonSizes[obj->polygonsLen++] = numCorners;
+
+        for (int i = firstRef; i < obj->relativeRefsLen; ++i)
+        {
+            obj->relativeRefs[i].corner += obj->polygonCornersLen - first;
+            obj->relativeRefs[i].isPolygon = true;
+        }
+        obj->polygonCornersLen += numCorners;
+    }
+    else
+    {
+        // points and lines aren't kept
+        obj->relativeRefsLen = firstRef;
+    }
+
+    return p;
+}
+
+obj_t obj_create(void)
+{
+    obj_t obj;
+    memset(&obj, 0, sizeof(obj));
+    return obj;
+}
+
+// scans the bytes in place, appending records to obj. data doesn't need to be
+// null terminated, so a read only mapping of the file can be passed directly.
+// faces with more than 3 corners need obj_triangulate before use
+void obj_parse(obj_t *obj, const char *data, const char *end)
+{
+    const char *p = data;
+
+    while (p < end)
+    {
+        p = skipBlanks(p, end);
+        if (p + 1 >= end)
+        {
+            break;
+        }
+
+        if (p[0] == 'v' && isBlank(p[1]))
+        {
+            p += 2;
+            float x = utils_parseFloat(&p, end);
+            float y = utils_parseFloat(&p, end);
+            float z = utils_parseFloat(&p, end);
+            obj->positions = reserve(obj->positions, &obj->positionsCap, obj->positionsLen + 1, sizeof(v3_t));
+            obj->positions[obj->positionsLen++] = v3_create(x, y, z);
+        }
+        else if (p[0] == 'v' && p[1] == 't' && p + 2 < end && isBlank(p[2]))
+        {
+            p += 3;
+            float x = utils_parseFloat(&p, end);
+            float y = utils_parseFloat(&p, end);
+            obj->texCoords = reserve(obj->texCoords, &obj->texCoordsCap, obj->texCoordsLen + 1, sizeof(v2_t));
+            obj->texCoords[obj->texCoordsLen++] = v2_create(x, y);
+        }
+        else if (p[0] == 'v' && p[1] == 'n' && p + 2 < end && isBlank(p[2]))
+        {
+            p += 3;
+            float x = utils_parseFloat(&p, end);
+            float y = utils_parseFloat(&p, end);
+            float z = utils_parseFloat(&p, end);
+            obj->normals = reserve(obj->normals, &obj->normalsCap, obj->normalsLen + 1, sizeof(v3_t));
+            obj->normals[obj->normalsLen++] = v3_create(x, y, z);
+        }
+        else if (p[0] == 'f' && isBlank(p[1]))
+        {
+            p = parseFace(obj, p + 2, end);
+        }
+
+        p = finishLine(p, end);
+    }
+}
+
+static void parseChunkJob(void *ctx, int index)
+{
+    parseJob_t *job = ctx;
+    obj_parse(&job->chunks[index], job->chunkStarts[index], job->chunkStarts[index + 1]);
+}
+
+static void stitchChunkJob(void *ctx, int index)
+{
+    parseJob_t *job = ctx;
+    obj_t *chunk = &job->chunks[index];
+    obj_t *obj = job->obj;
+
+    memcpy(obj->positions + job->positionsOffsets[index], chunk->positions, sizeof(v3_t) * chunk->positionsLen);
+    memcpy(obj->texCoords + job->texCoordsOffsets[index], chunk->texCoords, sizeof(v2_t) * chunk->texCoordsLen);
+    memcpy(obj->normals + job->normalsOffsets[index], chunk->normals, sizeof(v3_t) * chunk->normalsLen);
+    memcpy(obj->corners + job->cornersOffsets[index], chunk->corners, sizeof(obj_corner_t) * chunk->cornersLen);
+    memcpy(
+        obj->polygonCorners + job->polygonCornersOffsets[index],
+        chunk->polygonCorners, sizeof(obj_corner_t) * chunk->polygonCornersLen);
+    memcpy(obj->polygonSizes + job->polygonsOffsets[index], chunk->polygonSizes, sizeof(int) * chunk->polygonsLen);
+
+    // negative indices were resolved against the chunk's own counts
+    for (int i = 0; i < chunk->relativeRefsLen; ++i)
+    {
+        obj_relativeRef_t ref = chunk->relativeRefs[i];
+        obj_corner_t *corner = ref.isPolygon
+                                   ? &obj->polygonCorners[job->polygonCornersOffsets[index] + ref.corner]
+                                   : &obj->corners[job->cornersOffsets[index] + ref.corner];
+        if (ref.fields & OBJ_RELATIVE_POS)
+        {
+            corner->pos += job->positionsOffsets[index];
+        }
+        if (ref.fields & OBJ_RELATIVE_TEX_COORD)
+        {
+            corner->texCoord += job->texCoordsOffsets[index];
+        }
+        if (ref.fields & OBJ_RELATIVE_NORMAL)
+        {
+            corner->normal += job->normalsOffsets[index];
+        }
+    }
+
+    obj_free(chunk);
+}
+
+// splits the data into newline aligned chunks that are parsed concurrently, then
+// concatenated in file order. positive face indices are global in the file, so
+// they stay valid once each chunk's records are placed at their prefix sum
+// offset. negative ones are shifted by the same offsets
+void obj_parseParallel(obj_t *obj, const char *data, const char *end, int numThreads)
+{
+    size_t len = end - data;
+    int numChunks = numThreads * CHUNKS_PER_THREAD;
+    if (numThreads <= 1 || len < MIN_CHUNK_SIZE * 2)
+    {
+        obj_parse(obj, data, end);
+        return;
+    }
+    if (len / numChunks < MIN_CHUNK_SIZE)
+    {
+        numChunks = len / MIN_CHUNK_SIZE;
+    }
+
+    const char **chunkStarts = utils_malloc(sizeof(char *) * (numChunks + 1));
+    chunkStarts[0] = data;
+    for (int i = 1; i < numChunks; ++i)
+    {
+        const char *p = data + len / numChunks * i;
+        if (p < chunkStarts[i - 1])
+        {
+            p = chunkStarts[i - 1];
+        }
+        chunkStarts[i] = skipLine(p, end);
+    }
+    chunkStarts[numChunks] = end;
+
+    obj_t *chunks = utils_malloc(sizeof(obj_t) * numChunks);
+    for (int i = 0; i < numChunks; ++i)
+    {
+        chunks[i] = obj_create();
+    }
+
+    parseJob_t job;
+    job.chunks = chunks;
+    job.chunkStarts = chunkStarts;
+    job.obj = obj;
+    utils_parallelFor(numChunks, numThreads, parseChunkJob, &job);
+
+    // prefix sums give each chunk its place in the combined arrays, after anything
+    // already in obj
+    job.positionsOffsets = utils_malloc(sizeof(int) * numChunks);
+    job.texCoordsOffsets = utils_malloc(sizeof(int) * numChunks);
+    job.normalsOffsets = utils_malloc(sizeof(int) * numChunks);
+    job.cornersOffsets = utils_malloc(sizeof(int) * numChunks);
+    job.polygonCornersOffsets = utils_malloc(sizeof(int) * numChunks);
+    job.polygonsOffsets = utils_malloc(sizeof(int) * numChunks);
+    int positionsLen = obj->positionsLen;
+    int texCoordsLen = obj->texCoordsLen;
+    int normalsLen = obj->normalsLen;
+    int cornersLen = obj->cornersLen;
+    int polygonCornersLen = obj->polygonCornersLen;
+    int polygonsLen = obj->polygonsLen;
+    for (int i = 0; i < numChunks; ++i)
+    {
+        job.positionsOffsets[i] = positionsLen;
+        job.texCoordsOffsets[i] = texCoordsLen;
+        job.normalsOffsets[i] = normalsLen;
+        job.cornersOffsets[i] = cornersLen;
+        job.polygonCornersOffsets[i] = polygonCornersLen;
+        job.polygonsOffsets[i] = polygonsLen;
+        positionsLen += chunks[i].positionsLen;
+        texCoordsLen += chunks[i].texCoordsLen;
+        normalsLen += chunks[i].normalsLen;
+        cornersLen += chunks[i].cornersLen;
+        polygonCornersLen += chunks[i].polygonCornersLen;
+        polygonsLen += chunks[i].polygonsLen;
+    }
+
+    obj->positions = utils_reserve(obj->positions, &obj->positionsCap, positionsLen, sizeof(v3_t));
+    obj->texCoords = utils_reserve(obj->texCoords, &obj->texCoordsCap, texCoordsLen, sizeof(v2_t));
+    obj->normals = utils_reserve(obj->normals, &obj->normalsCap, normalsLen, sizeof(v3_t));
+    obj->corners = utils_reserve(obj->corners, &obj->cornersCap, cornersLen, sizeof(obj_corner_t));
+    obj->polygonCorners = utils_reserve(obj->polygonCorners, &obj->polygonCornersCap, polygonCornersLen, sizeof(obj_corner_t));
+    obj->polygonSizes = utils_reserve(obj->polygonSizes, &obj->polygonsCap, polygonsLen, sizeof(int));
+    obj->positionsLen = positionsLen;
+    obj->texCoordsLen = texCoordsLen;
+    obj->normalsLen = normalsLen;
+    obj->cornersLen = cornersLen;
+    obj->polygonCornersLen = polygonCornersLen;
+    obj->polygonsLen = polygonsLen;
+
+    utils_parallelFor(numChunks, numThreads, stitchChunkJob, &job);
+
+    free(job.positionsOffsets);
+    free(job.texCoordsOffsets);
+    free(job.normalsOffsets);
+    free(job.cornersOffsets);
+    free(job.polygonCornersOffsets);
+    free(job.polygonsOffsets);
+    free(chunks);
+    free(chunkStarts);
+}
+
+static float cross2(v2_t a, v2_t b, v2_t c)
+{
+    return (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+}
+
+static bool isInTriangle(v2_t p, v2_t a, v2_t b, v2_t c)
+{
+    return cross2(a, b, p) >= 0.0f && cross2(b, c, p) >= 0.0f && cross2(c, a, p) >= 0.0f;
+}
+
+static void addTriangle(obj_t *obj, obj_corner_t a, obj_corner_t b, obj_corner_t c)
+{
+    obj->corners = utils_reserve(obj->corners, &obj->cornersCap, obj->cornersLen + 3, sizeof(obj_corner_t));
+    obj->corners[obj->cornersLen++] = a;
+    obj->corners[obj->cornersLen++] = b;
+    obj->corners[obj->cornersLen++] = c;
+}
+
+// convex polygons are fanned. anything else is ear clipped in the polygon's
+// plane, which keeps the winding of the original polygon
+static void triangulatePolygon(obj_t *obj, obj_corner_t *polygon, int n, v2_t *projected, int *remaining)
+{
+    // newell's method gives a normal that is robust for non-planar polygons
+    v3_t normal = v3_create(0.0f, 0.0f, 0.0f);
+    for (int i = 0; i < n; ++i)
+    {
+        v3_t cur = obj->positions[polygon[i].pos];
+        v3_t next = obj->positions[polygon[(i + 1) % n].pos];
+        normal.x += (cur.y - next.y) * (cur.z + next.z);
+        normal.y += (cur.z - next.z) * (cur.x + next.x);
+        normal.z += (cur.x - next.x) * (cur.y + next.y);
+    }
+
+    // project onto the plane of the largest normal axis, flipped so the polygon is CCW
+    float absX = fabsf(normal.x);
+    float absY = fabsf(normal.y);
+    float absZ = fabsf(normal.z);
+    for (int i = 0; i < n; ++i)
+    {
+        v3_t pos = obj->positions[polygon[i].pos];
+        if (absX >= absY && absX >= absZ)
+        {
+            projected[i] = v2_create(pos.y, normal.x >= 0.0f ? pos.z : -pos.z);
+        }
+        else if (absY >= absZ)
+        {
+            projected[i] = v2_create(pos.z, normal.y >= 0.0f ? pos.x : -pos.x);
+        }
+        else
+        {
+            projected[i] = v2_create(pos.x, normal.z >= 0.0f ? pos.y : -pos.y);
+        }
+    }
+
+    bool isConvex = true;
+    for (int i = 0; i < n && isConvex; ++i)
+    {
+        isConvex = cross2(projected[i], projected[(i + 1) % n], projected[(i + 2) % n]) >= 0.0f;
+    }
+    if (isConvex)
+    {
+        for (int i = 1; i < n - 1; ++i)
+        {
+            addTriangle(obj, polygon[0], polygon[i], polygon[i + 1]);
+        }
+        return;
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        remaining[i] = i;
+    }
+    int remainingLen = n;
+
+    while (remainingLen > 3)
+    {
+        bool foundEar = false;
+
+        for (int i = 0; i < remainingLen && !foundEar; ++i)
+        {
+            int a = remaining[(i + remainingLen - 1) % remainingLen];
+            int b = remaining[i];
+            int c = remaining[(i + 1) % remainingLen];
+            if (cross2(projected[a], projected[b], projected[c]) <= 0.0f)
+            {
+                continue;
+            }
+
+            bool isEar = true;
+            for (int j = 0; j < remainingLen && isEar; ++j)
+            {
+                int other = remaining[j];
+                if (other != a && other != b && other != c)
+                {
+                    isEar = !isInTriangle(projected[other], projected[a], projected[b], projected[c]);
+                }
+            }
+
+            if (isEar)
+            {
+                addTriangle(obj, polygon[a], polygon[b], polygon[c]);
+                memmove(&remaining[i], &remaining[i + 1], sizeof(int) * (remainingLen - i - 1));
+                --remainingLen;
+                foundEar = true;
+            }
+        }
+
+        // degenerate or self intersecting, fan whatever is left
+        if (!foundEar)
+        {
+            break;
+        }
+    }
+
+    for (int i = 1; i < remainingLen - 1; ++i)
+    {
+        addTriangle(obj, polygon[remaining[0]], polygon[remaining[i]], polygon[remaining[i + 1]]);
+    }
+}
+
+// appends the triangulated polygons to obj->corners
+void obj_triangulate(obj_t *obj)
+{
+    int maxSize = 0;
+    for (int i = 0; i < obj->polygonsLen; ++i)
+    {
+        maxSize = obj->polygonSizes[i] > maxSize ? obj->polygonSizes[i] : maxSize;
+    }
+    if (maxSize == 0)
+    {
+        return;
+    }
+
+    v2_t *projected = utils_malloc(sizeof(v2_t) * maxSize);
+    int *remaining = utils_malloc(sizeof(int) * maxSize);
+
+    obj_corner_t *polygon = obj->polygonCorners;
+    for (int i = 0; i < obj->polygonsLen; ++i)
+    {
+        int n = obj->polygonSizes[i];
+        for (int j = 0; j < n; ++j)
+        {
+            if (polygon[j].pos < 0 || polygon[j].pos >= obj->positionsLen)
+            {
+                printf("invalid face index: polygon %d", i + 1);
+                exit(EXIT_FAILURE);
+            }
+        }
+        triangulatePolygon(obj, polygon, n, projected, remaining);
+        polygon += n;
+    }
+
+    free(remaining);
+    free(projected);
+
+    obj->polygonCornersLen = 0;
+    obj->polygonsLen = 0;
+}
+
+static uint32_t hashPosition(v3_t pos)
+{
+    uint32_t words[3];
+    memcpy(words, &pos, sizeof(words));
+    return (words[0] * 73856093u) ^ (words[1] * 19349663u) ^ (words[2] * 83492791u);
+}
+
+// gives each position the index of the first position with identical
+// coordinates, so seams that duplicate a position still share its normal
+static int *weldPositions(obj_t *obj)
+{
+    int tableCap = 1;
+    while (tableCap < obj->positionsLen * 2)
+    {
+        tableCap *= 2;
+    }
+    int *table = utils_malloc(sizeof(int) * tableCap);
+    memset(table, -1, sizeof(int) * tableCap);
+    int *welded = utils_malloc(sizeof(int) * (obj->positionsLen > 0 ? obj->positionsLen : 1));
+
+    for (int i = 0; i < obj->positionsLen; ++i)
+    {
+        uint32_t slot = hashPosition(obj->positions[i]) & (tableCap - 1);
+        while (table[slot] != -1 && memcmp(&obj->positions[table[slot]], &obj->positions[i], sizeof(v3_t)) != 0)
+        {
+            slot = (slot + 1) & (tableCap - 1);
+        }
+        if (table[slot] == -1)
+        {
+            table[slot] = i;
+        }
+        welded[i] = table[slot];
+    }
+
+    free(table);
+    return welded;
+}
+
+static void faceNormalsJob(void *ctx, int index)
+{
+    normalsJob_t *job = ctx;
+    obj_t *obj = job->obj;
+    int trisLen = obj->cornersLen / 3;
+    int start = index * NORMALS_BATCH_SIZE;
+    int end = start + NORMALS_BATCH_SIZE < trisLen ? start + NORMALS_BATCH_SIZE : trisLen;
+
+    // gather the batch's triangles into streams so the vector math runs over whole arrays
+    int len = end - start;
+    v3stream_t p0 = v3stream_create(len);
+    v3stream_t p1 = v3stream_create(len);
+    v3stream_t p2 = v3stream_create(len);
+    v3stream_t edge12 = v3stream_create(len);
+    for (int i = 0; i < len; ++i)
+    {
+        obj_corner_t *corners = obj->corners + (start + i) * 3;
+        v3stream_set(p0, i, obj->positions[corners[0].pos]);
+        v3stream_set(p1, i, obj->positions[corners[1].pos]);
+        v3stream_set(p2, i, obj->positions[corners[2].pos]);
+    }
+
+    // edges out of p0, the positions aren't needed after this
+    v3stream_sub(p2, p1, edge12);
+    v3stream_t edge01 = p1;
+    v3stream_t edge02 = p2;
+    v3stream_sub(p1, p0, edge01);
+    v3stream_sub(p2, p0, edge02);
+
+    // assume CCW winding
+    v3stream_t normals = p0;
+    v3stream_cross(edge01, edge02, normals);
+    v3stream_normalize(normals, normals);
+    v3stream_toV3s(normals, job->faceNormals + start);
+
+    // the angle at each corner weights its face's contribution. the kernels store
+    // whole vectors, so each array is aligned like a stream's
+    int padded = v3stream_paddedLen(len);
+    float *scratch = utils_alignedMalloc(V3STREAM_ALIGNMENT, sizeof(float) * padded * 6);
+    float *len01 = scratch, *len02 = len01 + padded, *len12 = len02 + padded;
+    float *dot0 = len12 + padded, *dot1 = dot0 + padded, *dot2 = dot1 + padded;
+    v3stream_len(edge01, len01);
+    v3stream_len(edge02, len02);
+    v3stream_len(edge12, len12);
+    v3stream_dot(edge01, edge02, dot0);
+    v3stream_dot(edge12, edge01, dot1);
+    v3stream_dot(edge02, edge12, dot2);
+
+    for (int i = 0; i < len; ++i)
+    {
+        // the edges at p1 are edge12 and -edge01, at p2 they are -edge02 and -edge12
+        float lenProducts[3] = {len01[i] * len02[i], len12[i] * len01[i], len02[i] * len12[i]};
+        float dots[3] = {dot0[i], -dot1[i], dot2[i]};
+        for (int j = 0; j < 3; ++j)
+        {
+            job->cornerAngles[(start + i) * 3 + j] = lenProducts[j] > 0.0f
+                                                         ? acosf(clampf(dots[j] / lenProducts[j], -1.0f, 1.0f))
+                                                         : 0.0f;
+        }
+    }
+
+    free(scratch);
+    v3stream_free(edge12);
+    v3stream_free(p2);
+    v3stream_free(p1);
+    v3stream_free(p0);
+}
+
+static void cornerNormalsJob(void *ctx, int index)
+{
+    normalsJob_t *job = ctx;
+    obj_t *obj = job->obj;
+    int start = index * NORMALS_BATCH_SIZE;
+    int end = start + NORMALS_BATCH_SIZE < obj->cornersLen ? start + NORMALS_BATCH_SIZE : obj->cornersLen;
+
+    for (int corner = start; corner < end; ++corner)
+    {
+        if (obj->corners[corner].normal != OBJ_MISSING_INDEX)
+        {
+            continue;
+        }
+
+        v3_t faceNormal = job->faceNormals[corner / 3];
+        v3_t normal = v3_create(0.0f, 0.0f, 0.0f);
+
+        // faces sharing this position, unless the angle between them is over the crease angle
+        int group = job->cornerGroups[corner];
+        for (int i = job->groupOffsets[group]; i < job->groupOffsets[group + 1]; ++i)
+        {
+            int other = job->groupCorners[i];
+            v3_t otherNormal = job->faceNormals[other / 3];
+            if (v3_dot(faceNormal, otherNormal) >= job->cosCrease)
+            {
+                normal = v3_add(normal, v3_mul(otherNormal, job->cornerAngles[other]));
+            }
+        }
+
+        float len = v3_len(normal);
+        obj->normals[job->normalsStart + corner] = len > 0.0f ? v3_div(normal, len) : faceNormal;
+    }
+}
+
+// fills in normals for corners that have none, as the angle weighted average of
+// the faces around the corner's position. faces further than creaseAngle from the
+// corner's face are left out, so hard edges stay hard
+void obj_generateNormals(obj_t *obj, float creaseAngle, int numThreads)
+{
+    bool hasMissing = false;
+    for (int i = 0; i < obj->cornersLen && !hasMissing; ++i)
+    {
+        hasMissing = obj->corners[i].normal == OBJ_MISSING_INDEX;
+    }
+    if (!hasMissing)
+    {
+        return;
+    }
+
+    int trisLen = obj->cornersLen / 3;
+    for (int i = 0; i < obj->cornersLen; ++i)
+    {
+        if (obj->corners[i].pos < 0 || obj->corners[i].pos >= obj->positionsLen)
+        {
+            printf("invalid face index: face %d", i / 3 + 1);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    normalsJob_t job;
+    job.obj = obj;
+    job.cosCrease = cosf(creaseAngle);
+    job.faceNormals = utils_malloc(sizeof(v3_t) * (trisLen > 0 ? trisLen : 1));
+    job.cornerAngles = utils_malloc(sizeof(float) * (obj->cornersLen > 0 ? obj->cornersLen : 1));
+
+    int numTriBatches = (trisLen + NORMALS_BATCH_SIZE - 1) / NORMALS_BATCH_SIZE;
+    utils_parallelFor(numTriBatches, numThreads, faceNormalsJob, &job);
+
+    // bucket corners by welded position with a counting sort
+    int *welded = weldPositions(obj);
+    job.cornerGroups = utils_malloc(sizeof(int) * (obj->cornersLen > 0 ? obj->cornersLen : 1));
+    job.groupOffsets = utils_malloc(sizeof(int) * (obj->positionsLen + 1));
+    job.groupCorners = utils_malloc(sizeof(int) * (obj->cornersLen > 0 ? obj->cornersLen : 1));
+    memset(job.groupOffsets, 0, sizeof(int) * (obj->positionsLen + 1));
+
+    for (int i = 0; i < obj->cornersLen; ++i)
+    {
+        job.cornerGroups[i] = welded[obj->corners[i].pos];
+        ++job.groupOffsets[job.cornerGroups[i] + 1];
+    }
+    for (int i = 0; i < obj->positionsLen; ++i)
+    {
+        job.groupOffsets[i + 1] += job.groupOffsets[i];
+    }
+    int *groupFill = welded;
+    memcpy(groupFill, job.groupOffsets, sizeof(int) * obj->positionsLen);
+    for (int i = 0; i < obj->cornersLen; ++i)
+    {
+        job.groupCorners[groupFill[job.cornerGroups[i]]++] = i;
+    }
+
+    // one generated normal per corner, appended after any normals from the file
+    job.normalsStart = obj->normalsLen;
+    obj->normals = utils_reserve(obj->normals, &obj->normalsCap, obj->normalsLen + obj->cornersLen, sizeof(v3_t));
+    obj->normalsLen += obj->cornersLen;
+
+    int numCornerBatches = (obj->cornersLen + NORMALS_BATCH_SIZE - 1) / NORMALS_BATCH_SIZE;
+    utils_parallelFor(numCornerBatches, numThreads, cornerNormalsJob, &job);
+
+    for (int i = 0; i < obj->cornersLen; ++i)
+    {
+        if (obj->corners[i].normal == OBJ_MISSING_INDEX)
+        {
+            obj->corners[i].normal = job.normalsStart + i;
+        }
+    }
+
+    free(groupFill);
+    free(job.groupCorners);
+    free(job.groupOffsets);
+    free(job.cornerGroups);
+    free(job.cornerAngles);
+    free(job.faceNormals);
+}
+
+void obj_free(obj_t *obj)
+{
+    free(obj->positions);
+    free(obj->texCoords);
+    free(obj->normals);
+    free(obj->corners);
+    free(obj->polygonCorners);
+    free(obj->polygonSizes);
+    free(obj->relativeRefs);
+    *obj = obj_create();
+}
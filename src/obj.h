@@ -0,0 +1,79 @@
+#ifndef OBJ_H
+#define OBJ_H
+
+#include <stdbool.h>
+#include <limits.h>
+#include "v2.h"
+#include "v3.h"
+
+// marks a corner field that wasn't in the file, e.g. the vt of v//vn. any other
+// negative index is invalid, as 0 or a relative index past the start would be
+#define OBJ_MISSING_INDEX INT_MIN
+
+// a face corner, indices are 0-based into the obj arrays and OBJ_MISSING_INDEX
+// when missing
+typedef struct obj_corner
+{
+    int pos;
+    int texCoord;
+    int normal;
+} obj_corner_t;
+
+// a corner with indices that were negative in the file, so they were resolved
+// against the counts of the obj being parsed into. fields is a mask of
+// OBJ_RELATIVE_POS/TEX_COORD/NORMAL
+typedef struct obj_relativeRef
+{
+    int corner;
+    bool isPolygon;
+    unsigned char fields;
+} obj_relativeRef_t;
+
+enum obj_relativeField
+{
+    OBJ_RELATIVE_POS = 0x01,
+    OBJ_RELATIVE_TEX_COORD = 0x02,
+    OBJ_RELATIVE_NORMAL = 0x04,
+};
+
+typedef struct obj
+{
+    v3_t *positions;
+    int positionsLen;
+    int positionsCap;
+    v2_t *texCoords;
+    int texCoordsLen;
+    int texCoordsCap;
+    v3_t *normals;
+    int normalsLen;
+    int normalsCap;
+    // 3 corners per triangle
+    obj_corner_t *corners;
+    int cornersLen;
+    int cornersCap;
+    // faces with more than 3 corners are kept apart, so triangles stay on the fast
+    // path. obj_triangulate turns them into triangles
+    obj_corner_t *polygonCorners;
+    int polygonCornersLen;
+    int polygonCornersCap;
+    int *polygonSizes;
+    int polygonsLen;
+    int polygonsCap;
+    obj_relativeRef_t *relativeRefs;
+    int relativeRefsLen;
+    int relativeRefsCap;
+} obj_t;
+
+obj_t obj_create(void);
+
+void obj_parse(obj_t *obj, const char *data, const char *end);
+
+void obj_parseParallel(obj_t *obj, const char *data, const char *end, int numThreads);
+
+void obj_triangulate(obj_t *obj);
+
+void obj_generateNormals(obj_t *obj, float creaseAngle, int numThreads);
+
+void obj_free(obj_t *obj);
+
+#endif
@@ -0,0 +1,163 @@
+#include <math.h>
+#include "quat.h"
+
+// below this angle slerp falls back to a normalized lerp
+static const float SLERP_LERP_THRESHOLD = 0.9995f;
+
+quat_t quat_createIdentity(void)
+{
+    quat_t result;
+    result.x = 0.0f;
+    result.y = 0.0f;
+    result.z = 0.0f;
+    result.w = 1.0f;
+    return result;
+}
+
+// axis must be normalized
+quat_t quat_createAxisAngle(v3_t axis, float theta)
+{
+    float s = sinf(theta * 0.5f);
+    quat_t result;
+    result.x = axis.x * s;
+    result.y = axis.y * s;
+    result.z = axis.z * s;
+    result.w = cosf(theta * 0.5f);
+    return result;
+}
+
+// x, y and z euler angles applied in the same order as mat4x4_composeTRS,
+// rotZ * rotY * rotX
+quat_t quat_createEuler(v3_t angles)
+{
+    float sx = sinf(angles.x * 0.5f), cx = cosf(angles.x * 0.5f);
+    float sy = sinf(angles.y * 0.5f), cy = cosf(angles.y * 0.5f);
+    float sz = sinf(angles.z * 0.5f), cz = cosf(angles.z * 0.5f);
+    quat_t result;
+    result.x = sx * cy * cz - cx * sy * sz;
+    result.y = cx * sy * cz + sx * cy * sz;
+    result.z = cx * cy * sz - sx * sy * cz;
+    result.w = cx * cy * cz + sx * sy * sz;
+    return result;
+}
+
+// rotates by b, then by a
+quat_t quat_mul(quat_t a, quat_t b)
+{
+    quat_t result;
+    result.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+    result.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+    result.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+    result.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+    return result;
+}
+
+// the inverse of a unit quaternion
+quat_t quat_conjugate(quat_t q)
+{
+    quat_t result;
+    result.x = -q.x;
+    result.y = -q.y;
+    result.z = -q.z;
+    result.w = q.w;
+    return result;
+}
+
+quat_t quat_inverse(quat_t q)
+{
+    float invLenSq = 1.0f / quat_dot(q, q);
+    quat_t result;
+    result.x = -q.x * invLenSq;
+    result.y = -q.y * invLenSq;
+    result.z = -q.z * invLenSq;
+    result.w = q.w * invLenSq;
+    return result;
+}
+
+quat_t quat_normalize(quat_t q)
+{
+    float invLen = 1.0f / sqrtf(quat_dot(q, q));
+    quat_t result;
+    result.x = q.x * invLen;
+    result.y = q.y * invLen;
+    result.z = q.z * invLen;
+    result.w = q.w * invLen;
+    return result;
+}
+
+float quat_dot(quat_t a, quat_t b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+// q must be a unit quaternion
+v3_t quat_rotate(quat_t q, v3_t v)
+{
+    // v + w * t + cross(q.xyz, t), where t = 2 * cross(q.xyz, v)
+    v3_t axis = v3_create(q.x, q.y, q.z);
+    v3_t t = v3_mul(v3_cross(axis, v), 2.0f);
+    return v3_add(v3_add(v, v3_mul(t, q.w)), v3_cross(axis, t));
+}
+
+// interpolates along the shorter arc between two unit quaternions
+quat_t quat_slerp(quat_t from, quat_t to, float t)
+{
+    float cosTheta = quat_dot(from, to);
+    if (cosTheta < 0.0f)
+    {
+        to = (quat_t){-to.x, -to.y, -to.z, -to.w};
+        cosTheta = -cosTheta;
+    }
+
+    float fromWeight, toWeight;
+    if (cosTheta > SLERP_LERP_THRESHOLD)
+    {
+        fromWeight = 1.0f - t;
+        toWeight = t;
+    }
+    else
+    {
+        float theta = acosf(cosTheta);
+        float invSinTheta = 1.0f / sinf(theta);
+        fromWeight = sinf((1.0f - t) * theta) * invSinTheta;
+        toWeight = sinf(t * theta) * invSinTheta;
+    }
+
+    quat_t result;
+    result.x = from.x * fromWeight + to.x * toWeight;
+    result.y = from.y * fromWeight + to.y * toWeight;
+    result.z = from.z * fromWeight + to.z * toWeight;
+    result.w = from.w * fromWeight + to.w * toWeight;
+    return quat_normalize(result);
+}
+
+// q must be a unit quaternion
+mat4x4_t quat_toMat4x4(quat_t q)
+{
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    mat4x4_t result;
+
+    result.m[0][0] = 1.0f - 2.0f * (yy + zz);
+    result.m[0][1] = 2.0f * (xy - wz);
+    result.m[0][2] = 2.0f * (xz + wy);
+    result.m[0][3] = 0;
+
+    result.m[1][0] = 2.0f * (xy + wz);
+    result.m[1][1] = 1.0f - 2.0f * (xx + zz);
+    result.m[1][2] = 2.0f * (yz - wx);
+    result.m[1][3] = 0;
+
+    result.m[2][0] = 2.0f * (xz - wy);
+    result.m[2][1] = 2.0f * (yz + wx);
+    result.m[2][2] = 1.0f - 2.0f * (xx + yy);
+    result.m[2][3] = 0;
+
+    result.m[3][0] = 0;
+    result.m[3][1] = 0;
+    result.m[3][2] = 0;
+    result.m[3][3] = 1;
+
+    return result;
+}
@@ -0,0 +1,38 @@
+#ifndef QUAT_H
+#define QUAT_H
+
+#include "v3.h"
+#include "mat4x4.h"
+
+// rotation quaternion, w is the scalar part
+typedef struct quat
+{
+    float x;
+    float y;
+    float z;
+    float w;
+} quat_t;
+
+quat_t quat_createIdentity(void);
+
+quat_t quat_createAxisAngle(v3_t axis, float theta);
+
+quat_t quat_createEuler(v3_t angles);
+
+quat_t quat_mul(quat_t a, quat_t b);
+
+quat_t quat_conjugate(quat_t q);
+
+quat_t quat_inverse(quat_t q);
+
+quat_t quat_normalize(quat_t q);
+
+float quat_dot(quat_t a, quat_t b);
+
+v3_t quat_rotate(quat_t q, v3_t v);
+
+quat_t quat_slerp(quat_t from, quat_t to, float t);
+
+mat4x4_t quat_toMat4x4(quat_t q);
+
+#endif
@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <string.h>
+#include <glad/glad.h>
+#include "renderqueue.h"
+#include "renderstats.h"
+#include "utils.h"
+
+// key layout from the top bit down. opaque draws group by program, then
+// material, then mesh, and go front to back within a group:
+// pass 4 | program 12 | material 12 | mesh 12 | depth 24
+// transparent draws have to go back to front, so inverted depth moves up:
+// pass 4 | depth 24 | program 12 | material 12 | mesh 12
+static const int DEPTH_BITS = 24;
+static const int ID_BITS = 12;
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define RADIX_PASSES (64 / RADIX_BITS)
+
+renderqueue_t renderqueue_create(void)
+{
+    renderqueue_t queue = {0};
+    return queue;
+}
+
+// positive floats order the same as their bits, the top bits keep the
+// exponent and the leading mantissa
+static uint32_t depthToBits(float depth)
+{
+    if (!(depth > 0.0f))
+    {
+        return 0;
+    }
+    uint32_t bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    return bits >> (32 - DEPTH_BITS);
+}
+
+uint64_t renderqueue_makeKey(enum renderqueue_pass pass, shader_t shader, mesh_t mesh, float depth)
+{
+    uint64_t idMask = (1u << ID_BITS) - 1;
+    uint64_t depthMask = (1u << DEPTH_BITS) - 1;
+    uint64_t program = shader.id & idMask;
+    // meshes sharing their first texture share a material
+    uint64_t material = (mesh.texturesLen > 0 ? mesh.textures[0].id : 0) & idMask;
+    uint64_t vao = mesh.VAO & idMask;
+    uint64_t depthBits = depthToBits(depth);
+    uint64_t ids = (program << (2 * ID_BITS)) | (material << ID_BITS) | vao;
+
+    uint64_t key = (uint64_t)pass << (DEPTH_BITS + 3 * ID_BITS);
+    if (pass == RENDERQUEUE_TRANSPARENT)
+    {
+        key |= ((~depthBits & depthMask) << (3 * ID_BITS)) | ids;
+    }
+    else
+    {
+        key |= (ids << DEPTH_BITS) | depthBits;
+    }
+    return key;
+}
+
+// depth is the draw's distance from the camera, lod the mesh's level of detail
+void renderqueue_push(renderqueue_t *queue, enum renderqueue_pass pass, mesh_t *mesh, shader_t *shader, meshInstance_t instance, int lod, float depth)
+{
+    int i = queue->itemsLen;
+    int entriesCap = queue->entriesCap;
+    queue->items = utils_reserve(queue->items, &queue->itemsCap, i + 1, sizeof(renderqueue_item_t));
+    queue->entries = utils_reserve(queue->entries, &queue->entriesCap, i + 1, sizeof(renderqueue_entry_t));
+    queue->scratch = utils_reserve(queue->scratch, &entriesCap, i + 1, sizeof(renderqueue_entry_t));
+
+    queue->items[i].mesh = mesh;
+    queue->items[i].shader = shader;
+    queue->items[i].instance = instance;
+    queue->items[i].lod = lod;
+    queue->entries[i].key = renderqueue_makeKey(pass, *shader, *mesh, depth);
+    queue->entries[i].item = i;
+    ++queue->itemsLen;
+}
+
+// least significant digit radix sort on the keys, one byte per pass. all the
+// histograms are counted up front, and a byte every key shares skips its pass
+void renderqueue_sort(renderqueue_t *queue)
+{
+    int len = queue->itemsLen;
+    int counts[RADIX_PASSES][RADIX_SIZE] = {0};
+    for (int i = 0; i < len; ++i)
+    {
+        uint64_t key = queue->entries[i].key;
+        for (int pass = 0; pass < RADIX_PASSES; ++pass)
+        {
+            ++counts[pass][(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)];
+        }
+    }
+
+    renderqueue_entry_t *src = queue->entries;
+    renderqueue_entry_t *dst = queue->scratch;
+    for (int pass = 0; pass < RADIX_PASSES; ++pass)
+    {
+        int shift = pass * RADIX_BITS;
+        if (len == 0 || counts[pass][(src[0].key >> shift) & (RADIX_SIZE - 1)] == len)
+        {
+            continue;
+        }
+
+        int offsets[RADIX_SIZE];
+        int offset = 0;
+        for (int digit = 0; digit < RADIX_SIZE; ++digit)
+        {
+            offsets[digit] = offset;
+            offset += counts[pass][digit];
+        }
+        for (int i = 0; i < len; ++i)
+        {
+            dst[offsets[(src[i].key >> shift) & (RADIX_SIZE - 1)]++] = src[i];
+        }
+
+        renderqueue_entry_t *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    queue->entries = src;
+    queue->scratch = dst;
+}
+
+static bool isSameRun(renderqueue_item_t *a, renderqueue_item_t *b)
+{
+    return a->shader->id == b->shader->id && a->mesh == b->mesh && a->lod == b->lod;
+}
+
+// the program and mesh switches submitting the entries in their current order
+// makes. switching program rebinds the mesh too, its uniforms belong to the
+// previous program
+long renderqueue_countStateChanges(renderqueue_t *queue)
+{
+    shader_t *shader = NULL;
+    mesh_t *mesh = NULL;
+    long stateChanges = 0;
+    for (int i = 0; i < queue->itemsLen; ++i)
+    {
+        renderqueue_item_t *item = &queue->items[queue->entries[i].item];
+        if (shader == NULL || item->shader->id != shader->id)
+        {
+            shader = item->shader;
+            mesh = NULL;
+            ++stateChanges;
+        }
+        if (item->mesh != mesh)
+        {
+            mesh = item->mesh;
+            ++stateChanges;
+        }
+    }
+    return stateChanges;
+}
+
+// draws in key order, one instanced draw per run of items sharing a program,
+// mesh and level of detail, only switching program or mesh when the next run
+// needs a different one. the programs take their matrices per instance, like
+// object_instanced.vs. opaque runs are front to back, so a mesh's levels of
+// detail each come out as one run
+void renderqueue_submit(renderqueue_t *queue)
+{
+    if (queue->itemsLen == 0)
+    {
+        return;
+    }
+
+    queue->instances = utils_reserve(queue->instances, &queue->instancesCap, queue->itemsLen, sizeof(meshInstance_t));
+    for (int i = 0; i < queue->itemsLen; ++i)
+    {
+        queue->instances[i] = queue->items[queue->entries[i].item].instance;
+    }
+    if (queue->instanceBuffer == 0)
+    {
+        queue->instanceBuffer = mesh_createInstanceBuffer();
+    }
+    mesh_updateInstanceBuffer(queue->instanceBuffer, queue->instances, queue->itemsLen);
+
+    shader_t *shader = NULL;
+    mesh_uniforms_t meshUniforms = {{-1}, {-1}, {-1}, {-1}, {-1}};
+
+    int first = 0;
+    while (first < queue->itemsLen)
+    {
+        renderqueue_item_t *item = &queue->items[queue->entries[first].item];
+        int last = first + 1;
+        while (last < queue->itemsLen && isSameRun(item, &queue->items[queue->entries[last].item]))
+        {
+            ++last;
+        }
+
+        if (shader == NULL || item->shader->id != shader->id)
+        {
+            shader = item->shader;
+            shader_use(*shader);
+            meshUniforms = mesh_getUniforms(*shader);
+        }
+        mesh_renderInstancedLod(*item->mesh, meshUniforms, queue->instanceBuffer, first, last - first, item->lod);
+        first = last;
+    }
+    RENDERSTATS_COUNT_STATE_CHANGES(renderqueue_countStateChanges(queue));
+}
+
+void renderqueue_clear(renderqueue_t *queue)
+{
+    queue->itemsLen = 0;
+}
+
+void renderqueue_free(renderqueue_t queue)
+{
+    free(queue.items);
+    free(queue.entries);
+    free(queue.scratch);
+    free(queue.instances);
+    if (queue.instanceBuffer != 0)
+    {
+        glDeleteBuffers(1, &queue.instanceBuffer);
+    }
+}
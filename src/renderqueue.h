@@ -0,0 +1,62 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <stdint.h>
+#include "mesh.h"
+#include "shader.h"
+
+// passes are drawn in this order
+enum renderqueue_pass
+{
+    RENDERQUEUE_OPAQUE,
+    RENDERQUEUE_TRANSPARENT,
+};
+
+typedef struct renderqueue_item
+{
+    mesh_t *mesh;
+    shader_t *shader;
+    meshInstance_t instance;
+    int lod;
+} renderqueue_item_t;
+
+typedef struct renderqueue_entry
+{
+    uint64_t key;
+    int item;
+} renderqueue_entry_t;
+
+// draws pushed in any order, sorted by a key so submitting them changes as
+// little state as possible
+typedef struct renderqueue
+{
+    renderqueue_item_t *items;
+    int itemsLen;
+    int itemsCap;
+    // sorted by key, scratch is the radix sort's second buffer
+    renderqueue_entry_t *entries;
+    renderqueue_entry_t *scratch;
+    int entriesCap;
+    // the items' instance rows in key order, uploaded once per submit
+    meshInstance_t *instances;
+    int instancesCap;
+    unsigned int instanceBuffer;
+} renderqueue_t;
+
+renderqueue_t renderqueue_create(void);
+
+uint64_t renderqueue_makeKey(enum renderqueue_pass pass, shader_t shader, mesh_t mesh, float depth);
+
+void renderqueue_push(renderqueue_t *queue, enum renderqueue_pass pass, mesh_t *mesh, shader_t *shader, meshInstance_t instance, int lod, float depth);
+
+void renderqueue_sort(renderqueue_t *queue);
+
+long renderqueue_countStateChanges(renderqueue_t *queue);
+
+void renderqueue_submit(renderqueue_t *queue);
+
+void renderqueue_clear(renderqueue_t *queue);
+
+void renderqueue_free(renderqueue_t queue);
+
+#endif
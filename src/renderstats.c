@@ -0,0 +1,38 @@
+#include <stdio.h>
+#include "renderstats.h"
+
+#ifdef RENDER_STATS
+static const double REPORT_INTERVAL = 1.0;
+
+long renderstats_glCalls = 0;
+long renderstats_elidedGlCalls = 0;
+long renderstats_stateChanges = 0;
+long renderstats_triangles = 0;
+static long framesSinceReport = 0;
+static double lastReport = 0.0;
+#endif
+
+void renderstats_endFrame(double time)
+{
+#ifdef RENDER_STATS
+    ++framesSinceReport;
+    if (time - lastReport >= REPORT_INTERVAL)
+    {
+        printf(
+            "gl calls/frame: %.1f, elided: %.1f, state changes: %.1f, triangles: %.0f (%ld frames)\n",
+            (double)renderstats_glCalls / framesSinceReport,
+            (double)renderstats_elidedGlCalls / framesSinceReport,
+            (double)renderstats_stateChanges / framesSinceReport,
+            (double)renderstats_triangles / framesSinceReport,
+            framesSinceReport);
+        renderstats_glCalls = 0;
+        renderstats_elidedGlCalls = 0;
+        renderstats_stateChanges = 0;
+        renderstats_triangles = 0;
+        framesSinceReport = 0;
+        lastReport = time;
+    }
+#else
+    (void)time;
+#endif
+}
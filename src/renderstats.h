@@ -0,0 +1,26 @@
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+// counts the GL calls the renderer makes, the ones glstate found redundant and
+// skipped, the program and mesh switches renderqueue made and the triangles
+// drawn, printed as per frame averages about once a second. compiles to nothing
+// unless RENDER_STATS is defined
+#ifdef RENDER_STATS
+extern long renderstats_glCalls;
+extern long renderstats_elidedGlCalls;
+extern long renderstats_stateChanges;
+extern long renderstats_triangles;
+#define RENDERSTATS_COUNT_GL_CALLS(n) (renderstats_glCalls += (n))
+#define RENDERSTATS_COUNT_ELIDED_GL_CALLS(n) (renderstats_elidedGlCalls += (n))
+#define RENDERSTATS_COUNT_STATE_CHANGES(n) (renderstats_stateChanges += (n))
+#define RENDERSTATS_COUNT_TRIANGLES(n) (renderstats_triangles += (n))
+#else
+#define RENDERSTATS_COUNT_GL_CALLS(n) ((void)0)
+#define RENDERSTATS_COUNT_ELIDED_GL_CALLS(n) ((void)0)
+#define RENDERSTATS_COUNT_STATE_CHANGES(n) ((void)0)
+#define RENDERSTATS_COUNT_TRIANGLES(n) ((void)0)
+#endif
+
+void renderstats_endFrame(double time);
+
+#endif
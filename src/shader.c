@@ -1,10 +1,98 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <glad/glad.h>
 #include "utils.h"
 #include "shader.h"
+#include "glstate.h"
+#include "renderstats.h"
 
 static const int INFO_LOG_LEN = 512;
+static const int MAX_UNIFORM_SEEDS = 256;
+
+static uint32_t hashName(const char *name, uint32_t seed)
+{
+    // FNV-1a, then a murmur finalizer so every seed spreads into the low bits
+    uint32_t hash = 2166136261u ^ seed;
+    for (; *name != '\0'; ++name)
+    {
+        hash ^= (unsigned char)*name;
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+// introspects the linked program's active uniforms into a table that maps every
+// name to its own slot. seeds are tried until one has no collisions, so lookups
+// are one hash and one compare
+static void buildUniformTable(shader_t *program)
+{
+    int uniformsLen, maxNameLen;
+    glGetProgramiv(program->id, GL_ACTIVE_UNIFORMS, &uniformsLen);
+    glGetProgramiv(program->id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLen);
+
+    char *names = utils_malloc((size_t)(uniformsLen > 0 ? uniformsLen : 1) * (maxNameLen + 1));
+    int *locations = utils_malloc(sizeof(int) * (uniformsLen > 0 ? uniformsLen : 1));
+    int namesLen = 0;
+    for (int i = 0; i < uniformsLen; ++i)
+    {
+        char *name = names + (size_t)namesLen * (maxNameLen + 1);
+        int nameLen, size;
+        GLenum type;
+        glGetActiveUniform(program->id, i, maxNameLen + 1, &nameLen, &size, &type, name);
+
+        // arrays are reported as their first element, keep the bare name
+        if (nameLen > 3 && strcmp(name + nameLen - 3, "[0]") == 0)
+        {
+            name[nameLen - 3] = '\0';
+        }
+        // uniforms in blocks have no location
+        locations[namesLen] = glGetUniformLocation(program->id, name);
+        if (locations[namesLen] >= 0)
+        {
+            ++namesLen;
+        }
+    }
+
+    int cap = 4;
+    while (cap < namesLen * 2)
+    {
+        cap *= 2;
+    }
+    for (;;)
+    {
+        program->uniformNames = utils_malloc(sizeof(char *) * cap);
+        program->uniformLocations = utils_malloc(sizeof(int) * cap);
+        for (uint32_t seed = 0; seed < (uint32_t)MAX_UNIFORM_SEEDS; ++seed)
+        {
+            memset(program->uniformNames, 0, sizeof(char *) * cap);
+            bool isPerfect = true;
+            for (int i = 0; i < namesLen && isPerfect; ++i)
+            {
+                char *name = names + (size_t)i * (maxNameLen + 1);
+                uint32_t slot = hashName(name, seed) & (cap - 1);
+                isPerfect = program->uniformNames[slot] == NULL;
+                program->uniformNames[slot] = name;
+                program->uniformLocations[slot] = locations[i];
+            }
+            if (isPerfect)
+            {
+                program->uniformsCap = cap;
+                program->uniformsSeed = seed;
+                free(locations);
+                return;
+            }
+        }
+        free(program->uniformNames);
+        free(program->uniformLocations);
+        cap *= 2;
+    }
+}
 
 shader_t shader_create(char *vertexPath, char *fragmentPath)
 {
@@ -52,40 +140,122 @@ shader_t shader_create(char *vertexPath, char *fragmentPath)
     glDeleteShader(vertexShaderId);
     glDeleteShader(fragmentShaderId);
 
+    buildUniformTable(&program);
+
     return program;
 }
 
 void shader_use(shader_t program)
 {
-    glUseProgram(program.id);
+    glstate_useProgram(program.id);
+}
+
+shader_uniform_t shader_getUniform(shader_t program, char *name)
+{
+    shader_uniform_t result;
+    uint32_t slot = hashName(name, program.uniformsSeed) & (program.uniformsCap - 1);
+    char *entry = program.uniformNames[slot];
+    if (entry != NULL && strcmp(entry, name) == 0)
+    {
+        result.location = program.uniformLocations[slot];
+    }
+    else if (strchr(name, '[') != NULL)
+    {
+        // only the first element of an array is in the table
+        result.location = glGetUniformLocation(program.id, name);
+        RENDERSTATS_COUNT_GL_CALLS(1);
+    }
+    else
+    {
+        result.location = -1;
+    }
+    return result;
 }
 
+void shader_uniformBool(shader_uniform_t uniform, bool value)
+{
+    glUniform1i(uniform.location, (int)value);
+    RENDERSTATS_COUNT_GL_CALLS(1);
+}
+
+void shader_uniformInt(shader_uniform_t uniform, int value)
+{
+    glUniform1i(uniform.location, value);
+    RENDERSTATS_COUNT_GL_CALLS(1);
+}
+
+void shader_uniformFloat(shader_uniform_t uniform, float value)
+{
+    glUniform1f(uniform.location, value);
+    RENDERSTATS_COUNT_GL_CALLS(1);
+}
+
+void shader_uniformMat4x4(shader_uniform_t uniform, mat4x4_t mat)
+{
+    glUniformMatrix4fv(uniform.location, 1, GL_TRUE, (float *)(mat.m));
+    RENDERSTATS_COUNT_GL_CALLS(1);
+}
+
+// sets a mat3 uniform from the upper 3x3 of mat
+void shader_uniformMat3x3(shader_uniform_t uniform, mat4x4_t mat)
+{
+    float upper[9];
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            upper[row * 3 + col] = mat.m[row][col];
+        }
+    }
+    glUniformMatrix3fv(uniform.location, 1, GL_TRUE, upper);
+    RENDERSTATS_COUNT_GL_CALLS(1);
+}
+
+void shader_uniformV3(shader_uniform_t uniform, v3_t v)
+{
+    glUniform3f(uniform.location, v.x, v.y, v.z);
+    RENDERSTATS_COUNT_GL_CALLS(1);
+}
+
+void shader_uniformV2(shader_uniform_t uniform, v2_t v)
+{
+    glUniform2f(uniform.location, v.x, v.y);
+    RENDERSTATS_COUNT_GL_CALLS(1);
+}
+
+// the by name setters look the uniform up in the table, no GL query is made
+
 void shader_setBool(shader_t program, char *name, bool value)
 {
-    int location = glGetUniformLocation(program.id, name);
-    glUniform1i(location, (int)value);
+    shader_uniformBool(shader_getUniform(program, name), value);
 }
 
 void shader_setInt(shader_t program, char *name, int value)
 {
-    int location = glGetUniformLocation(program.id, name);
-    glUniform1i(location, value);
+    shader_uniformInt(shader_getUniform(program, name), value);
 }
 
 void shader_setFloat(shader_t program, char *name, float value)
 {
-    int location = glGetUniformLocation(program.id, name);
-    glUniform1f(location, value);
+    shader_uniformFloat(shader_getUniform(program, name), value);
 }
 
 void shader_setMat4x4(shader_t program, char *name, mat4x4_t mat)
 {
-    int location = glGetUniformLocation(program.id, name);
-    glUniformMatrix4fv(location, 1, GL_TRUE, (float *)(mat.m));
+    shader_uniformMat4x4(shader_getUniform(program, name), mat);
+}
+
+void shader_setMat3x3(shader_t program, char *name, mat4x4_t mat)
+{
+    shader_uniformMat3x3(shader_getUniform(program, name), mat);
 }
 
 void shader_setV3(shader_t program, char *name, v3_t v)
 {
-    int location = glGetUniformLocation(program.id, name);
-    glUniform3f(location, v.x, v.y, v.z);
+    shader_uniformV3(shader_getUniform(program, name), v);
+}
+
+void shader_setV2(shader_t program, char *name, v2_t v)
+{
+    shader_uniformV2(shader_getUniform(program, name), v);
 }
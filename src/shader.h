@@ -2,18 +2,47 @@
 #define SHADER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "mat4x4.h"
+#include "v2.h"
 #include "v3.h"
 
 typedef struct shader
 {
     unsigned int id;
+    // the active uniforms, in a table with no collisions for the names it holds
+    char **uniformNames;
+    int *uniformLocations;
+    int uniformsCap;
+    uint32_t uniformsSeed;
 } shader_t;
 
+// a resolved uniform location, -1 when the program has no such active uniform
+typedef struct shader_uniform
+{
+    int location;
+} shader_uniform_t;
+
 shader_t shader_create(char *vertexPath, char *fragmentPath);
 
 void shader_use(shader_t program);
 
+shader_uniform_t shader_getUniform(shader_t program, char *name);
+
+void shader_uniformBool(shader_uniform_t uniform, bool value);
+
+void shader_uniformInt(shader_uniform_t uniform, int value);
+
+void shader_uniformFloat(shader_uniform_t uniform, float value);
+
+void shader_uniformMat4x4(shader_uniform_t uniform, mat4x4_t mat);
+
+void shader_uniformMat3x3(shader_uniform_t uniform, mat4x4_t mat);
+
+void shader_uniformV3(shader_uniform_t uniform, v3_t v);
+
+void shader_uniformV2(shader_uniform_t uniform, v2_t v);
+
 void shader_setBool(shader_t program, char *name, bool value);
 
 void shader_setInt(shader_t program, char *name, int value);
@@ -22,6 +51,10 @@ void shader_setFloat(shader_t program, char *name, float value);
 
 void shader_setMat4x4(shader_t program, char *name, mat4x4_t mat);
 
+void shader_setMat3x3(shader_t program, char *name, mat4x4_t mat);
+
 void shader_setV3(shader_t program, char *name, v3_t v);
 
+void shader_setV2(shader_t program, char *name, v2_t v);
+
 #endif
\ No newline at end of file
@@ -1,8 +1,12 @@
 #version 330 core
 
+layout (std140, row_major) uniform PerFrame {
+  mat4 view;
+  mat4 projection;
+  vec3 viewPos;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 layout (location = 0) in vec3 vertPos;
 
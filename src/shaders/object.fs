@@ -1,9 +1,5 @@
 #version 330 core
 
-struct Material {
-  float shininess;
-};
-
 struct DirectionalLight {
   vec3 dir;
   vec3 ambient;
@@ -28,13 +24,27 @@ uniform sampler2D diffuse3;
 uniform sampler2D specular1;
 uniform sampler2D specular2;
 
-uniform vec3 viewPos;
-uniform Material material;
-uniform DirectionalLight sunlight;
+uniform sampler2D normal1;
+uniform bool hasNormalMap;
+
+layout (std140, row_major) uniform PerFrame {
+  mat4 view;
+  mat4 projection;
+  vec3 viewPos;
+};
+
+layout (std140) uniform Lights {
+  DirectionalLight sunlight;
+};
+
+layout (std140) uniform Material {
+  float shininess;
+} material;
 
 in vec3 fragPos;
 in vec3 fragNormal;
 in vec2 fragTexCoords;
+in vec4 fragTangent;
 
 out vec4 fragColor;
 
@@ -42,8 +52,10 @@ vec3 calcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir);
 
 vec3 calcPointLight(PointLight light, vec3 normal, vec3 viewDir);
 
+vec3 calcNormal();
+
 void main() {
-  vec3 normal = normalize(fragNormal);
+  vec3 normal = calcNormal();
   vec3 viewDir = normalize(fragPos - viewPos);
   vec3 result = vec3(0.0);
 
@@ -52,6 +64,19 @@ void main() {
   fragColor = vec4(result, 1.0);
 }
 
+vec3 calcNormal() {
+  vec3 normal = normalize(fragNormal);
+  if (!hasNormalMap) {
+    return normal;
+  }
+
+  // re-orthogonalize after interpolation, the bitangent sign is in w
+  vec3 tangent = normalize(fragTangent.xyz - normal * dot(normal, fragTangent.xyz));
+  vec3 bitangent = fragTangent.w * cross(normal, tangent);
+  vec3 tangentNormal = texture(normal1, fragTexCoords).rgb * 2.0 - 1.0;
+  return normalize(mat3(tangent, bitangent, normal) * tangentNormal);
+}
+
 vec3 calcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir) {
   vec3 lightDir = normalize(light.dir);
 
@@ -1,25 +1,39 @@
 #version 330 core
 
+layout (std140, row_major) uniform PerFrame {
+  mat4 view;
+  mat4 projection;
+  vec3 viewPos;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// inverse transpose of model's upper 3x3, computed on the cpu
+uniform mat3 normalMatrix;
+// maps quantized attributes back to model space
+uniform vec3 posScale;
+uniform vec3 posOffset;
+uniform vec2 texCoordsScale;
+uniform vec2 texCoordsOffset;
 
 layout (location = 0) in vec3 vertPos;
 layout (location = 1) in vec3 vertNormal;
 layout (location = 2) in vec2 vertTexCoords;
+layout (location = 3) in vec4 vertTangent;
 
 out vec3 fragPos;
 out vec3 fragNormal;
 out vec2 fragTexCoords;
+out vec4 fragTangent;
 
 void main() {
-  fragPos = vec3(model * vec4(vertPos, 1.0));
-  fragTexCoords = vertTexCoords;
+  vec3 pos = vertPos * posScale + posOffset;
+  fragPos = vec3(model * vec4(pos, 1.0));
+  fragTexCoords = vertTexCoords * texCoordsScale + texCoordsOffset;
 
-  // inversing a matrix is expensive, and only needs to be calculated once per model
-  // ideally do it on the cpu and pass it as a uniform
-  fragNormal = mat3(transpose(inverse(model))) * vertNormal;
+  fragNormal = normalMatrix * vertNormal;
+  // tangents lie in the surface, so they transform like positions
+  fragTangent = vec4(mat3(model) * vertTangent.xyz, vertTangent.w);
 
-  gl_Position = projection * view * model * vec4(vertPos, 1.0);
+  gl_Position = projection * view * model * vec4(pos, 1.0);
 }
 
@@ -0,0 +1,46 @@
+#version 330 core
+
+layout (std140, row_major) uniform PerFrame {
+  mat4 view;
+  mat4 projection;
+  vec3 viewPos;
+};
+
+// maps quantized attributes back to model space
+uniform vec3 posScale;
+uniform vec3 posOffset;
+uniform vec2 texCoordsScale;
+uniform vec2 texCoordsOffset;
+
+layout (location = 0) in vec3 vertPos;
+layout (location = 1) in vec3 vertNormal;
+layout (location = 2) in vec2 vertTexCoords;
+layout (location = 3) in vec4 vertTangent;
+// per instance, the top 3 rows of the model and normal matrices
+layout (location = 4) in vec4 instanceModel0;
+layout (location = 5) in vec4 instanceModel1;
+layout (location = 6) in vec4 instanceModel2;
+layout (location = 7) in vec4 instanceNormalMatrix0;
+layout (location = 8) in vec4 instanceNormalMatrix1;
+layout (location = 9) in vec4 instanceNormalMatrix2;
+
+out vec3 fragPos;
+out vec3 fragNormal;
+out vec2 fragTexCoords;
+out vec4 fragTangent;
+
+void main() {
+  // glsl constructors take columns
+  mat4 model = transpose(mat4(instanceModel0, instanceModel1, instanceModel2, vec4(0.0, 0.0, 0.0, 1.0)));
+  mat3 normalMatrix = transpose(mat3(instanceNormalMatrix0.xyz, instanceNormalMatrix1.xyz, instanceNormalMatrix2.xyz));
+
+  vec3 pos = vertPos * posScale + posOffset;
+  fragPos = vec3(model * vec4(pos, 1.0));
+  fragTexCoords = vertTexCoords * texCoordsScale + texCoordsOffset;
+
+  fragNormal = normalMatrix * vertNormal;
+  // tangents lie in the surface, so they transform like positions
+  fragTangent = vec4(mat3(model) * vertTangent.xyz, vertTangent.w);
+
+  gl_Position = projection * view * vec4(fragPos, 1.0);
+}
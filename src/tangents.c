@@ -0,0 +1,157 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tangents.h"
+#include "utils.h"
+
+static const int TANGENTS_BATCH_SIZE = 1 << 14;
+
+typedef struct tangentsJob
+{
+    vertex_t *vertices;
+    int verticesLen;
+    unsigned int *indices;
+    int trisLen;
+    // per triangle, already weighted by the corner angle
+    v3_t *cornerTangents;
+    v3_t *cornerBitangents;
+    // vertex -> corners adjacency, as offsets into vertexCorners
+    int *vertexOffsets;
+    int *vertexCorners;
+} tangentsJob_t;
+
+// the handedness of a triangle's tangent frame, from the sign of its uv area.
+// triangles with no uv area count as right handed
+float tangents_triangleSign(v2_t texCoords0, v2_t texCoords1, v2_t texCoords2)
+{
+    float det = (texCoords1.x - texCoords0.x) * (texCoords2.y - texCoords0.y) -
+                (texCoords2.x - texCoords0.x) * (texCoords1.y - texCoords0.y);
+    return det < 0.0f ? -1.0f : 1.0f;
+}
+
+static void triangleTangentsJob(void *ctx, int index)
+{
+    tangentsJob_t *job = ctx;
+    int start = index * TANGENTS_BATCH_SIZE;
+    int end = start + TANGENTS_BATCH_SIZE < job->trisLen ? start + TANGENTS_BATCH_SIZE : job->trisLen;
+
+    for (int tri = start; tri < end; ++tri)
+    {
+        vertex_t *v[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            v[j] = &job->vertices[job->indices[tri * 3 + j]];
+        }
+
+        v3_t edge1 = v3_sub(v[1]->pos, v[0]->pos);
+        v3_t edge2 = v3_sub(v[2]->pos, v[0]->pos);
+        float du1 = v[1]->texCoords.x - v[0]->texCoords.x;
+        float dv1 = v[1]->texCoords.y - v[0]->texCoords.y;
+        float du2 = v[2]->texCoords.x - v[0]->texCoords.x;
+        float dv2 = v[2]->texCoords.y - v[0]->texCoords.y;
+
+        // the sign of the uv area decides handedness, its magnitude cancels on normalizing
+        float sign = tangents_triangleSign(v[0]->texCoords, v[1]->texCoords, v[2]->texCoords);
+        v3_t tangent = v3_mul(v3_sub(v3_mul(edge1, dv2), v3_mul(edge2, dv1)), sign);
+        v3_t bitangent = v3_mul(v3_sub(v3_mul(edge2, du1), v3_mul(edge1, du2)), sign);
+
+        for (int j = 0; j < 3; ++j)
+        {
+            // project into the corner's tangent plane and weight by the corner angle
+            v3_t normal = v[j]->normal;
+            v3_t t = v3_sub(tangent, v3_mul(normal, v3_dot(normal, tangent)));
+            v3_t b = v3_sub(bitangent, v3_mul(normal, v3_dot(normal, bitangent)));
+            float tLen = v3_len(t);
+            float bLen = v3_len(b);
+
+            v3_t edgeA = v3_sub(v[(j + 1) % 3]->pos, v[j]->pos);
+            v3_t edgeB = v3_sub(v[(j + 2) % 3]->pos, v[j]->pos);
+            float lenProduct = v3_len(edgeA) * v3_len(edgeB);
+            float angle = lenProduct > 0.0f ? acosf(clampf(v3_dot(edgeA, edgeB) / lenProduct, -1.0f, 1.0f)) : 0.0f;
+
+            job->cornerTangents[tri * 3 + j] = tLen > 0.0f ? v3_mul(t, angle / tLen) : v3_create(0.0f, 0.0f, 0.0f);
+            job->cornerBitangents[tri * 3 + j] = bLen > 0.0f ? v3_mul(b, angle / bLen) : v3_create(0.0f, 0.0f, 0.0f);
+        }
+    }
+}
+
+// any unit vector perpendicular to n, for vertices with no usable uv gradient
+static v3_t perpendicular(v3_t n)
+{
+    v3_t axis = fabsf(n.x) < 0.9f ? v3_create(1.0f, 0.0f, 0.0f) : v3_create(0.0f, 1.0f, 0.0f);
+    return v3_normalize(v3_cross(axis, n));
+}
+
+static void vertexTangentsJob(void *ctx, int index)
+{
+    tangentsJob_t *job = ctx;
+    int start = index * TANGENTS_BATCH_SIZE;
+    int end = start + TANGENTS_BATCH_SIZE < job->verticesLen ? start + TANGENTS_BATCH_SIZE : job->verticesLen;
+
+    for (int vert = start; vert < end; ++vert)
+    {
+        v3_t tangent = v3_create(0.0f, 0.0f, 0.0f);
+        v3_t bitangent = v3_create(0.0f, 0.0f, 0.0f);
+        for (int i = job->vertexOffsets[vert]; i < job->vertexOffsets[vert + 1]; ++i)
+        {
+            tangent = v3_add(tangent, job->cornerTangents[job->vertexCorners[i]]);
+            bitangent = v3_add(bitangent, job->cornerBitangents[job->vertexCorners[i]]);
+        }
+
+        // gram-schmidt against the normal, the bitangent is only kept as a sign
+        vertex_t *v = &job->vertices[vert];
+        v3_t normal = v->normal;
+        tangent = v3_sub(tangent, v3_mul(normal, v3_dot(normal, tangent)));
+        float len = v3_len(tangent);
+        v->tangent = len > 0.0f ? v3_div(tangent, len) : perpendicular(normal);
+        v->bitangentSign = v3_dot(v3_cross(normal, v->tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+    }
+}
+
+// fills in vertex tangents in the MikkTSpace style: per corner tangents projected
+// into the normal's plane and weighted by corner angle, summed per vertex, then
+// orthonormalized. a vertex's corners should share a handedness, otherwise the
+// tangents of mirrored uv islands cancel where they meet. triangles and vertices are both processed in parallel, the
+// per corner results are gathered per vertex so no accumulation is shared
+void tangents_generate(vertex_t *vertices, int verticesLen, unsigned int *indices, int indicesLen, int numThreads)
+{
+    tangentsJob_t job;
+    job.vertices = vertices;
+    job.verticesLen = verticesLen;
+    job.indices = indices;
+    job.trisLen = indicesLen / 3;
+    int cornersLen = job.trisLen * 3;
+    job.cornerTangents = utils_malloc(sizeof(v3_t) * (cornersLen > 0 ? cornersLen : 1));
+    job.cornerBitangents = utils_malloc(sizeof(v3_t) * (cornersLen > 0 ? cornersLen : 1));
+
+    int numTriBatches = (job.trisLen + TANGENTS_BATCH_SIZE - 1) / TANGENTS_BATCH_SIZE;
+    utils_parallelFor(numTriBatches, numThreads, triangleTangentsJob, &job);
+
+    // bucket corners by vertex with a counting sort
+    job.vertexOffsets = utils_malloc(sizeof(int) * (verticesLen + 1));
+    job.vertexCorners = utils_malloc(sizeof(int) * (cornersLen > 0 ? cornersLen : 1));
+    memset(job.vertexOffsets, 0, sizeof(int) * (verticesLen + 1));
+    for (int i = 0; i < cornersLen; ++i)
+    {
+        ++job.vertexOffsets[indices[i] + 1];
+    }
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        job.vertexOffsets[i + 1] += job.vertexOffsets[i];
+    }
+    int *fill = utils_malloc(sizeof(int) * (verticesLen > 0 ? verticesLen : 1));
+    memcpy(fill, job.vertexOffsets, sizeof(int) * verticesLen);
+    for (int i = 0; i < cornersLen; ++i)
+    {
+        job.vertexCorners[fill[indices[i]]++] = i;
+    }
+    free(fill);
+
+    int numVertexBatches = (verticesLen + TANGENTS_BATCH_SIZE - 1) / TANGENTS_BATCH_SIZE;
+    utils_parallelFor(numVertexBatches, numThreads, vertexTangentsJob, &job);
+
+    free(job.vertexCorners);
+    free(job.vertexOffsets);
+    free(job.cornerBitangents);
+    free(job.cornerTangents);
+}
@@ -0,0 +1,10 @@
+#ifndef TANGENTS_H
+#define TANGENTS_H
+
+#include "mesh.h"
+
+float tangents_triangleSign(v2_t texCoords0, v2_t texCoords1, v2_t texCoords2);
+
+void tangents_generate(vertex_t *vertices, int verticesLen, unsigned int *indices, int indicesLen, int numThreads);
+
+#endif
@@ -3,6 +3,7 @@
 #include <stb/stb_image.h>
 #include <stdbool.h>
 #include "texture.h"
+#include "glstate.h"
 
 texture_t texture_load(char *path, enum texture_type type)
 {
@@ -33,7 +34,7 @@ texture_t texture_load(char *path, enum texture_type type)
         format = GL_RGBA;
     }
 
-    glBindTexture(GL_TEXTURE_2D, texture.id);
+    glstate_bindTexture(0, texture.id);
     glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
     glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -5,6 +5,7 @@ enum texture_type
 {
     DIFFUSE,
     SPECULAR,
+    NORMAL,
 };
 
 typedef struct texture
@@ -0,0 +1,52 @@
+#include <stddef.h>
+#include <glad/glad.h>
+#include "ubo.h"
+#include "renderstats.h"
+
+static char *BLOCK_NAMES[] = {
+    [UBO_PER_FRAME] = "PerFrame",
+    [UBO_LIGHTS] = "Lights",
+    [UBO_MATERIAL] = "Material",
+};
+static const int BLOCKS_LEN = sizeof(BLOCK_NAMES) / sizeof(BLOCK_NAMES[0]);
+
+// std140 offsets the shaders rely on
+_Static_assert(offsetof(ubo_perFrame_t, projection) == 64, "PerFrame layout");
+_Static_assert(offsetof(ubo_perFrame_t, viewPos) == 128, "PerFrame layout");
+_Static_assert(sizeof(ubo_directionalLight_t) == 64, "DirectionalLight layout");
+_Static_assert(sizeof(ubo_material_t) == 16, "Material layout");
+
+// the buffer stays bound to its binding point, so shaders only need
+// ubo_bindBlocks once
+ubo_t ubo_create(enum ubo_binding binding, int size)
+{
+    ubo_t result;
+    result.size = size;
+    glGenBuffers(1, &result.id);
+    glBindBuffer(GL_UNIFORM_BUFFER, result.id);
+    glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_STREAM_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, result.id);
+    return result;
+}
+
+// replaces the whole block. glBufferData orphans the old storage, so this never
+// waits on draws still reading the previous contents
+void ubo_update(ubo_t ubo, void *data)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo.id);
+    glBufferData(GL_UNIFORM_BUFFER, ubo.size, data, GL_STREAM_DRAW);
+    RENDERSTATS_COUNT_GL_CALLS(2);
+}
+
+// points every shared block the program declares at its binding
+void ubo_bindBlocks(shader_t program)
+{
+    for (int binding = 0; binding < BLOCKS_LEN; ++binding)
+    {
+        unsigned int index = glGetUniformBlockIndex(program.id, BLOCK_NAMES[binding]);
+        if (index != GL_INVALID_INDEX)
+        {
+            glUniformBlockBinding(program.id, index, binding);
+        }
+    }
+}
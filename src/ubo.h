@@ -0,0 +1,60 @@
+#ifndef UBO_H
+#define UBO_H
+
+#include "mat4x4.h"
+#include "v3.h"
+#include "shader.h"
+
+// binding points of the uniform blocks shared by every shader
+enum ubo_binding
+{
+    UBO_PER_FRAME = 0,
+    UBO_LIGHTS = 1,
+    UBO_MATERIAL = 2,
+};
+
+// the structs below mirror the std140 blocks in the shaders, vec3s take 16 bytes
+typedef struct ubo_perFrame
+{
+    mat4x4_t view;
+    mat4x4_t projection;
+    v3_t viewPos;
+    float pad0;
+} ubo_perFrame_t;
+
+typedef struct ubo_directionalLight
+{
+    v3_t dir;
+    float pad0;
+    v3_t ambient;
+    float pad1;
+    v3_t diffuse;
+    float pad2;
+    v3_t specular;
+    float pad3;
+} ubo_directionalLight_t;
+
+typedef struct ubo_lights
+{
+    ubo_directionalLight_t sunlight;
+} ubo_lights_t;
+
+typedef struct ubo_material
+{
+    float shininess;
+    float pad0[3];
+} ubo_material_t;
+
+typedef struct ubo
+{
+    unsigned int id;
+    int size;
+} ubo_t;
+
+ubo_t ubo_create(enum ubo_binding binding, int size);
+
+void ubo_update(ubo_t ubo, void *data);
+
+void ubo_bindBlocks(shader_t program);
+
+#endif
@@ -1,7 +1,23 @@
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "utils.h"
 
+static const size_t STREAM_BLOCK_SIZE = 1 << 20;
+
+// exactly representable powers of ten, larger exponents are applied in steps
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+    1e21, 1e22};
+static const int POW10_MAX = 22;
+
 void *utils_malloc(size_t size)
 {
     void *result = malloc(size);
@@ -13,6 +29,49 @@ void *utils_malloc(size_t size)
     return result;
 }
 
+// alignment must be a power of two. free the result with free
+void *utils_alignedMalloc(size_t alignment, size_t size)
+{
+    // aligned_alloc wants a size that is a multiple of the alignment
+    size = (size + alignment - 1) / alignment * alignment;
+    void *result = aligned_alloc(alignment, size > 0 ? size : alignment);
+    if (result == NULL)
+    {
+        printf("failed to allocate memory");
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+void *utils_realloc(void *ptr, size_t size)
+{
+    void *result = realloc(ptr, size);
+    if (result == NULL)
+    {
+        printf("failed to allocate memory");
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+// grows an array geometrically so that it can hold at least `required` elements
+void *utils_reserve(void *array, int *capacity, int required, size_t elemSize)
+{
+    if (required <= *capacity)
+    {
+        return array;
+    }
+
+    int newCapacity = *capacity > 0 ? *capacity : 16;
+    while (newCapacity < required)
+    {
+        newCapacity *= 2;
+    }
+
+    *capacity = newCapacity;
+    return utils_realloc(array, newCapacity * elemSize);
+}
+
 int utils_getToken(char *str, char delim, char *token, char **tokenEnd)
 {
     int tokenLength = 0;
@@ -56,6 +115,286 @@ char *utils_getFileContent(char *path)
     return content;
 }
 
+static mappedFile_t readStream(int fd)
+{
+    mappedFile_t result;
+    result.data = NULL;
+    result.len = 0;
+    result.isMapped = false;
+
+    size_t cap = 0;
+    ssize_t bytesRead;
+    do
+    {
+        if (result.len == cap)
+        {
+            cap += STREAM_BLOCK_SIZE;
+            result.data = utils_realloc(result.data, cap);
+        }
+        bytesRead = read(fd, result.data + result.len, cap - result.len);
+        if (bytesRead > 0)
+        {
+            result.len += bytesRead;
+        }
+    } while (bytesRead > 0);
+
+    return result;
+}
+
+// maps a file read-only into memory. "-" reads stdin, and anything that can't be
+// mapped (pipes, fifos) is read into a heap buffer instead
+mappedFile_t utils_mapFile(char *path)
+{
+    bool isStdin = path[0] == '-' && path[1] == '\0';
+    int fd = isStdin ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        printf("failed to open file: %s", path);
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat info;
+    mappedFile_t result;
+
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        result.len = info.st_size;
+        result.data = mmap(NULL, result.len, PROT_READ, MAP_PRIVATE, fd, 0);
+        result.isMapped = result.data != MAP_FAILED;
+        if (result.isMapped)
+        {
+            madvise(result.data, result.len, MADV_SEQUENTIAL);
+        }
+        else
+        {
+            result = readStream(fd);
+        }
+    }
+    else
+    {
+        result = readStream(fd);
+    }
+
+    if (!isStdin)
+    {
+        close(fd);
+    }
+    return result;
+}
+
+void utils_unmapFile(mappedFile_t file)
+{
+    if (file.isMapped)
+    {
+        munmap(file.data, file.len);
+    }
+    else
+    {
+        free(file.data);
+    }
+}
+
+static inline bool isDigit(char c)
+{
+    return (unsigned char)(c - '0') < 10;
+}
+
+// locale independent float parser that reads in place, without needing the input
+// to be null terminated. skips leading blanks and leaves *str after the number.
+// up to 19 significant digits are accumulated as an integer, then scaled by an
+// exact power of ten in double precision
+float utils_parseFloat(const char **str, const char *end)
+{
+    const char *p = *str;
+    while (p < end && (*p == ' ' || *p == '\t'))
+    {
+        ++p;
+    }
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int numDigits = 0;
+    int exponent = 0;
+
+    while (p < end && isDigit(*p))
+    {
+        if (numDigits < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            numDigits += mantissa != 0;
+        }
+        else
+        {
+            ++exponent;
+        }
+        ++p;
+    }
+
+    if (p < end && *p == '.')
+    {
+        ++p;
+        while (p < end && isDigit(*p))
+        {
+            if (numDigits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                numDigits += mantissa != 0;
+                --exponent;
+            }
+            ++p;
+        }
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char *expStart = p;
+        ++p;
+        bool expNegative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            expNegative = *p == '-';
+            ++p;
+        }
+        if (p < end && isDigit(*p))
+        {
+            int expValue = 0;
+            while (p < end && isDigit(*p))
+            {
+                if (expValue < 10000)
+                {
+                    expValue = expValue * 10 + (*p - '0');
+                }
+                ++p;
+            }
+            exponent += expNegative ? -expValue : expValue;
+        }
+        else
+        {
+            // not an exponent, e.g. "1e" followed by something else
+            p = expStart;
+        }
+    }
+
+    double value = (double)mantissa;
+    while (exponent > POW10_MAX && value != 0.0)
+    {
+        value *= POW10[POW10_MAX];
+        exponent -= POW10_MAX;
+    }
+    while (exponent < -POW10_MAX && value != 0.0)
+    {
+        value /= POW10[POW10_MAX];
+        exponent += POW10_MAX;
+    }
+    if (exponent > 0)
+    {
+        value *= POW10[exponent];
+    }
+    else if (exponent < 0)
+    {
+        value /= POW10[-exponent];
+    }
+
+    *str = p;
+    return (float)(negative ? -value : value);
+}
+
+// locale independent integer parser, see utils_parseFloat
+int utils_parseInt(const char **str, const char *end)
+{
+    const char *p = *str;
+    while (p < end && (*p == ' ' || *p == '\t'))
+    {
+        ++p;
+    }
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+
+    int value = 0;
+    while (p < end && isDigit(*p))
+    {
+        value = value * 10 + (*p - '0');
+        ++p;
+    }
+
+    *str = p;
+    return negative ? -value : value;
+}
+
+typedef struct parallelForState
+{
+    atomic_int next;
+    int count;
+    void (*job)(void *ctx, int index);
+    void *ctx;
+} parallelForState_t;
+
+static void *parallelForWorker(void *arg)
+{
+    parallelForState_t *state = arg;
+    int index;
+    while ((index = atomic_fetch_add(&state->next, 1)) < state->count)
+    {
+        state->job(state->ctx, index);
+    }
+    return NULL;
+}
+
+int utils_getNumCores(void)
+{
+    long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+    return numCores > 0 ? (int)numCores : 1;
+}
+
+// runs job(ctx, i) for every i in [0, count) across numThreads threads, including
+// the calling thread. returns once every job has finished
+void utils_parallelFor(int count, int numThreads, void (*job)(void *ctx, int index), void *ctx)
+{
+    parallelForState_t state;
+    atomic_init(&state.next, 0);
+    state.count = count;
+    state.job = job;
+    state.ctx = ctx;
+
+    if (numThreads > count)
+    {
+        numThreads = count;
+    }
+
+    pthread_t *threads = NULL;
+    int numSpawned = 0;
+    if (numThreads > 1)
+    {
+        threads = utils_malloc(sizeof(pthread_t) * (numThreads - 1));
+        for (int i = 0; i < numThreads - 1; ++i)
+        {
+            if (pthread_create(&threads[numSpawned], NULL, parallelForWorker, &state) == 0)
+            {
+                ++numSpawned;
+            }
+        }
+    }
+
+    parallelForWorker(&state);
+
+    for (int i = 0; i < numSpawned; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
 float clampf(float val, float lower, float upper)
 {
     if (val < lower)
@@ -2,13 +2,39 @@
 #define UTILS_H
 
 #include <stdio.h>
+#include <stdbool.h>
+
+typedef struct mappedFile
+{
+    char *data;
+    size_t len;
+    bool isMapped;
+} mappedFile_t;
 
 void *utils_malloc(size_t size);
 
+void *utils_alignedMalloc(size_t alignment, size_t size);
+
+void *utils_realloc(void *ptr, size_t size);
+
+void *utils_reserve(void *array, int *capacity, int required, size_t elemSize);
+
 int utils_getToken(char *str, char delim, char *token, char **tokenEnd);
 
 char *utils_getFileContent(char *path);
 
+mappedFile_t utils_mapFile(char *path);
+
+void utils_unmapFile(mappedFile_t file);
+
+float utils_parseFloat(const char **str, const char *end);
+
+int utils_parseInt(const char **str, const char *end);
+
+int utils_getNumCores(void);
+
+void utils_parallelFor(int count, int numThreads, void (*job)(void *ctx, int index), void *ctx);
+
 float clampf(float val, float lower, float upper);
 
 #endif
\ No newline at end of file
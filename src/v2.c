@@ -1,9 +1,4 @@
 #include "v2.h"
-
-v2_t v2_create(float x, float y)
-{
-    v2_t result;
-    result.x = x;
-    result.y = y;
-    return result;
-}
\ No newline at end of file
+#ifndef MATH_HEADER_ONLY
+#include "v2inline.h"
+#endif
@@ -1,12 +1,21 @@
 #ifndef V2_H
 #define V2_H
 
+#include "mathinline.h"
+
 typedef struct v2
 {
     float x;
     float y;
 } v2_t;
 
-v2_t v2_create(float x, float y);
+// constant initializer for static and const data
+#define V2_INIT(x, y) {(x), (y)}
+
+MATH_API v2_t v2_create(float x, float y);
+
+#ifdef MATH_HEADER_ONLY
+#include "v2inline.h"
+#endif
 
 #endif
\ No newline at end of file
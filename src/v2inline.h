@@ -0,0 +1,17 @@
+#ifndef V2INLINE_H
+#define V2INLINE_H
+
+// the v2 functions. compiled into v2.c, or included by v2.h as static inline
+// definitions when MATH_HEADER_ONLY is defined
+
+#include "v2.h"
+
+MATH_API v2_t v2_create(float x, float y)
+{
+    v2_t result;
+    result.x = x;
+    result.y = y;
+    return result;
+}
+
+#endif
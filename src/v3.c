@@ -1,76 +1,43 @@
 #include <math.h>
 #include "v3.h"
-
-v3_t v3_create(float x, float y, float z)
-{
-    v3_t result;
-    result.x = x;
-    result.y = y;
-    result.z = z;
-    return result;
-}
-
-v3_t v3_add(v3_t a, v3_t b)
-{
-    v3_t result;
-    result.x = a.x + b.x;
-    result.y = a.y + b.y;
-    result.z = a.z + b.z;
-    return result;
-}
-
-v3_t v3_sub(v3_t a, v3_t b)
-{
-    v3_t result;
-    result.x = a.x - b.x;
-    result.y = a.y - b.y;
-    result.z = a.z - b.z;
-    return result;
-}
-
-v3_t v3_mul(v3_t a, float b)
-{
-    v3_t result;
-    result.x = a.x * b;
-    result.y = a.y * b;
-    result.z = a.z * b;
-    return result;
-};
-
-v3_t v3_div(v3_t a, float b)
-{
-    v3_t result;
-    result.x = a.x / b;
-    result.y = a.y / b;
-    result.z = a.z / b;
-    return result;
-}
-
-v3_t v3_cross(v3_t a, v3_t b)
-{
-    v3_t result;
-    result.x = a.y * b.z - a.z * b.y;
-    result.y = a.z * b.x - a.x * b.z;
-    result.z = a.x * b.y - a.y * b.x;
-    return result;
-}
-
-float v3_dot(v3_t a, v3_t b)
-{
-    return a.x * b.x + a.y * b.y + a.z * b.z;
-}
-
-float v3_len(v3_t a)
-{
-    return sqrtf(a.x * a.x + a.y * a.y + a.z * a.z);
-}
-
-v3_t v3_normalize(v3_t a)
-{
-    return v3_div(a, v3_len(a));
-}
-
-v3_t v3_interpolate(v3_t from, v3_t to, float t)
-{
-    return v3_add(from, v3_mul(v3_sub(to, from), t));
+#include "mat4x4.h"
+#ifndef MATH_HEADER_ONLY
+#include "v3inline.h"
+#endif
+
+#if defined(MAT4X4_SSE)
+#include <immintrin.h>
+#endif
+
+// transforms points (w = 1) held as separate x, y and z arrays. the result
+// arrays may be the input arrays
+void v3_transformBatch(const struct mat4x4 *m, float *x, float *y, float *z, float *resultX, float *resultY, float *resultZ, int len)
+{
+    int i = 0;
+
+#if defined(MAT4X4_SSE)
+    __m128 m00 = _mm_set1_ps(m->m[0][0]), m01 = _mm_set1_ps(m->m[0][1]), m02 = _mm_set1_ps(m->m[0][2]), m03 = _mm_set1_ps(m->m[0][3]);
+    __m128 m10 = _mm_set1_ps(m->m[1][0]), m11 = _mm_set1_ps(m->m[1][1]), m12 = _mm_set1_ps(m->m[1][2]), m13 = _mm_set1_ps(m->m[1][3]);
+    __m128 m20 = _mm_set1_ps(m->m[2][0]), m21 = _mm_set1_ps(m->m[2][1]), m22 = _mm_set1_ps(m->m[2][2]), m23 = _mm_set1_ps(m->m[2][3]);
+    for (; i + 4 <= len; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 pz = _mm_loadu_ps(z + i);
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, px), _mm_mul_ps(m01, py)), _mm_add_ps(_mm_mul_ps(m02, pz), m03));
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, px), _mm_mul_ps(m11, py)), _mm_add_ps(_mm_mul_ps(m12, pz), m13));
+        __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, px), _mm_mul_ps(m21, py)), _mm_add_ps(_mm_mul_ps(m22, pz), m23));
+        _mm_storeu_ps(resultX + i, rx);
+        _mm_storeu_ps(resultY + i, ry);
+        _mm_storeu_ps(resultZ + i, rz);
+    }
+#endif
+
+    for (; i < len; ++i)
+    {
+        float px = x[i], py = y[i], pz = z[i];
+        resultX[i] = m->m[0][0] * px + m->m[0][1] * py + m->m[0][2] * pz + m->m[0][3];
+        resultY[i] = m->m[1][0] * px + m->m[1][1] * py + m->m[1][2] * pz + m->m[1][3];
+        resultZ[i] = m->m[2][0] * px + m->m[2][1] * py + m->m[2][2] * pz + m->m[2][3];
+    }
 }
@@ -2,6 +2,7 @@
 #define V3_H
 
 #include <stdbool.h>
+#include "mathinline.h"
 
 typedef struct v3
 {
@@ -10,24 +11,35 @@ typedef struct v3
     float z;
 } v3_t;
 
-v3_t v3_create(float x, float y, float z);
+// constant initializer for static and const data
+#define V3_INIT(x, y, z) {(x), (y), (z)}
 
-v3_t v3_add(v3_t a, v3_t b);
+MATH_API v3_t v3_create(float x, float y, float z);
 
-v3_t v3_sub(v3_t a, v3_t b);
+MATH_API v3_t v3_add(v3_t a, v3_t b);
 
-v3_t v3_mul(v3_t a, float b);
+MATH_API v3_t v3_sub(v3_t a, v3_t b);
 
-v3_t v3_div(v3_t a, float b);
+MATH_API v3_t v3_mul(v3_t a, float b);
 
-v3_t v3_cross(v3_t a, v3_t b);
+MATH_API v3_t v3_div(v3_t a, float b);
 
-float v3_dot(v3_t a, v3_t b);
+MATH_API v3_t v3_cross(v3_t a, v3_t b);
 
-float v3_len(v3_t a);
+MATH_API float v3_dot(v3_t a, v3_t b);
 
-v3_t v3_normalize(v3_t a);
+MATH_API float v3_len(v3_t a);
 
-v3_t v3_interpolate(v3_t from, v3_t to, float t);
+MATH_API v3_t v3_normalize(v3_t a);
+
+MATH_API v3_t v3_interpolate(v3_t from, v3_t to, float t);
+
+struct mat4x4;
+
+void v3_transformBatch(const struct mat4x4 *m, float *x, float *y, float *z, float *resultX, float *resultY, float *resultZ, int len);
+
+#ifdef MATH_HEADER_ONLY
+#include "v3inline.h"
+#endif
 
 #endif
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef V3INLINE_H
+#define V3INLINE_H
+
+// the small v3 functions. compiled into v3.c, or included by v3.h as static
+// inline definitions when MATH_HEADER_ONLY is defined
+
+#include <math.h>
+#include "v3.h"
+
+MATH_API v3_t v3_create(float x, float y, float z)
+{
+    v3_t result;
+    result.x = x;
+    result.y = y;
+    result.z = z;
+    return result;
+}
+
+MATH_API v3_t v3_add(v3_t a, v3_t b)
+{
+    v3_t result;
+    result.x = a.x + b.x;
+    result.y = a.y + b.y;
+    result.z = a.z + b.z;
+    return result;
+}
+
+MATH_API v3_t v3_sub(v3_t a, v3_t b)
+{
+    v3_t result;
+    result.x = a.x - b.x;
+    result.y = a.y - b.y;
+    result.z = a.z - b.z;
+    return result;
+}
+
+MATH_API v3_t v3_mul(v3_t a, float b)
+{
+    v3_t result;
+    result.x = a.x * b;
+    result.y = a.y * b;
+    result.z = a.z * b;
+    return result;
+}
+
+MATH_API v3_t v3_div(v3_t a, float b)
+{
+    v3_t result;
+    result.x = a.x / b;
+    result.y = a.y / b;
+    result.z = a.z / b;
+    return result;
+}
+
+MATH_API v3_t v3_cross(v3_t a, v3_t b)
+{
+    v3_t result;
+    result.x = a.y * b.z - a.z * b.y;
+    result.y = a.z * b.x - a.x * b.z;
+    result.z = a.x * b.y - a.y * b.x;
+    return result;
+}
+
+MATH_API float v3_dot(v3_t a, v3_t b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+MATH_API float v3_len(v3_t a)
+{
+    return sqrtf(a.x * a.x + a.y * a.y + a.z * a.z);
+}
+
+MATH_API v3_t v3_normalize(v3_t a)
+{
+    return v3_div(a, v3_len(a));
+}
+
+MATH_API v3_t v3_interpolate(v3_t from, v3_t to, float t)
+{
+    return v3_add(from, v3_mul(v3_sub(to, from), t));
+}
+
+#endif
@@ -0,0 +1,258 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "v3stream.h"
+#include "utils.h"
+
+// define V3STREAM_SCALAR to force the plain C kernels
+#if !defined(V3STREAM_SCALAR) && defined(__AVX__)
+#include <immintrin.h>
+typedef __m256 vf_t;
+#define VF_WIDTH 8
+#define vfLoad(p) _mm256_load_ps(p)
+#define vfStore(p, a) _mm256_store_ps(p, a)
+#define vfSet(a) _mm256_set1_ps(a)
+#define vfAdd(a, b) _mm256_add_ps(a, b)
+#define vfSub(a, b) _mm256_sub_ps(a, b)
+#define vfMul(a, b) _mm256_mul_ps(a, b)
+#define vfMin(a, b) _mm256_min_ps(a, b)
+#define vfMax(a, b) _mm256_max_ps(a, b)
+#define vfSqrt(a) _mm256_sqrt_ps(a)
+#define vfSafeRecip(a) _mm256_and_ps(_mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_div_ps(vfSet(1.0f), a))
+#elif !defined(V3STREAM_SCALAR) && (defined(__SSE2__) || defined(_M_X64))
+#include <immintrin.h>
+typedef __m128 vf_t;
+#define VF_WIDTH 4
+#define vfLoad(p) _mm_load_ps(p)
+#define vfStore(p, a) _mm_store_ps(p, a)
+#define vfSet(a) _mm_set1_ps(a)
+#define vfAdd(a, b) _mm_add_ps(a, b)
+#define vfSub(a, b) _mm_sub_ps(a, b)
+#define vfMul(a, b) _mm_mul_ps(a, b)
+#define vfMin(a, b) _mm_min_ps(a, b)
+#define vfMax(a, b) _mm_max_ps(a, b)
+#define vfSqrt(a) _mm_sqrt_ps(a)
+#define vfSafeRecip(a) _mm_and_ps(_mm_cmpgt_ps(a, _mm_setzero_ps()), _mm_div_ps(vfSet(1.0f), a))
+#elif !defined(V3STREAM_SCALAR) && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+typedef float32x4_t vf_t;
+#define VF_WIDTH 4
+#define vfLoad(p) vld1q_f32(p)
+#define vfStore(p, a) vst1q_f32(p, a)
+#define vfSet(a) vdupq_n_f32(a)
+#define vfAdd(a, b) vaddq_f32(a, b)
+#define vfSub(a, b) vsubq_f32(a, b)
+#define vfMul(a, b) vmulq_f32(a, b)
+#define vfMin(a, b) vminq_f32(a, b)
+#define vfMax(a, b) vmaxq_f32(a, b)
+#define vfSqrt(a) vsqrtq_f32(a)
+#define vfSafeRecip(a) vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(a, vdupq_n_f32(0.0f)), vreinterpretq_u32_f32(vdivq_f32(vdupq_n_f32(1.0f), a))))
+#else
+typedef float vf_t;
+#define VF_WIDTH 1
+#define vfLoad(p) (*(p))
+#define vfStore(p, a) (*(p) = (a))
+#define vfSet(a) (a)
+#define vfAdd(a, b) ((a) + (b))
+#define vfSub(a, b) ((a) - (b))
+#define vfMul(a, b) ((a) * (b))
+#define vfMin(a, b) fminf(a, b)
+#define vfMax(a, b) fmaxf(a, b)
+#define vfSqrt(a) sqrtf(a)
+#define vfSafeRecip(a) ((a) > 0.0f ? 1.0f / (a) : 0.0f)
+#endif
+
+static const int STREAM_PADDING = 16;
+
+v3stream_t v3stream_create(int len)
+{
+    v3stream_t result;
+    int padded = v3stream_paddedLen(len > 0 ? len : 1);
+
+    // one block for all three components, padded lanes are zeroed so they stay finite
+    float *block = utils_alignedMalloc(V3STREAM_ALIGNMENT, sizeof(float) * padded * 3);
+    memset(block, 0, sizeof(float) * padded * 3);
+    result.x = block;
+    result.y = block + padded;
+    result.z = block + padded * 2;
+    result.len = len;
+    return result;
+}
+
+// length of each component array, scalar outputs of the kernels need this much room
+int v3stream_paddedLen(int len)
+{
+    return (len + STREAM_PADDING - 1) / STREAM_PADDING * STREAM_PADDING;
+}
+
+v3stream_t v3stream_fromV3s(v3_t *vs, int len)
+{
+    v3stream_t result = v3stream_create(len);
+    for (int i = 0; i < len; ++i)
+    {
+        result.x[i] = vs[i].x;
+        result.y[i] = vs[i].y;
+        result.z[i] = vs[i].z;
+    }
+    return result;
+}
+
+void v3stream_toV3s(v3stream_t s, v3_t *result)
+{
+    for (int i = 0; i < s.len; ++i)
+    {
+        result[i] = v3_create(s.x[i], s.y[i], s.z[i]);
+    }
+}
+
+v3_t v3stream_get(v3stream_t s, int i)
+{
+    return v3_create(s.x[i], s.y[i], s.z[i]);
+}
+
+void v3stream_set(v3stream_t s, int i, v3_t v)
+{
+    s.x[i] = v.x;
+    s.y[i] = v.y;
+    s.z[i] = v.z;
+}
+
+// the kernels below run over a's length, any result stream must be at least as
+// long. results may be the same stream as an input
+
+void v3stream_add(v3stream_t a, v3stream_t b, v3stream_t result)
+{
+    for (int i = 0; i < a.len; i += VF_WIDTH)
+    {
+        vfStore(result.x + i, vfAdd(vfLoad(a.x + i), vfLoad(b.x + i)));
+        vfStore(result.y + i, vfAdd(vfLoad(a.y + i), vfLoad(b.y + i)));
+        vfStore(result.z + i, vfAdd(vfLoad(a.z + i), vfLoad(b.z + i)));
+    }
+}
+
+void v3stream_sub(v3stream_t a, v3stream_t b, v3stream_t result)
+{
+    for (int i = 0; i < a.len; i += VF_WIDTH)
+    {
+        vfStore(result.x + i, vfSub(vfLoad(a.x + i), vfLoad(b.x + i)));
+        vfStore(result.y + i, vfSub(vfLoad(a.y + i), vfLoad(b.y + i)));
+        vfStore(result.z + i, vfSub(vfLoad(a.z + i), vfLoad(b.z + i)));
+    }
+}
+
+void v3stream_scale(v3stream_t a, float b, v3stream_t result)
+{
+    vf_t scale = vfSet(b);
+    for (int i = 0; i < a.len; i += VF_WIDTH)
+    {
+        vfStore(result.x + i, vfMul(vfLoad(a.x + i), scale));
+        vfStore(result.y + i, vfMul(vfLoad(a.y + i), scale));
+        vfStore(result.z + i, vfMul(vfLoad(a.z + i), scale));
+    }
+}
+
+// result needs v3stream_paddedLen(a.len) floats, aligned like the streams
+void v3stream_dot(v3stream_t a, v3stream_t b, float *result)
+{
+    for (int i = 0; i < a.len; i += VF_WIDTH)
+    {
+        vf_t dot = vfMul(vfLoad(a.x + i), vfLoad(b.x + i));
+        dot = vfAdd(dot, vfMul(vfLoad(a.y + i), vfLoad(b.y + i)));
+        dot = vfAdd(dot, vfMul(vfLoad(a.z + i), vfLoad(b.z + i)));
+        vfStore(result + i, dot);
+    }
+}
+
+void v3stream_cross(v3stream_t a, v3stream_t b, v3stream_t result)
+{
+    for (int i = 0; i < a.len; i += VF_WIDTH)
+    {
+        vf_t ax = vfLoad(a.x + i), ay = vfLoad(a.y + i), az = vfLoad(a.z + i);
+        vf_t bx = vfLoad(b.x + i), by = vfLoad(b.y + i), bz = vfLoad(b.z + i);
+        vfStore(result.x + i, vfSub(vfMul(ay, bz), vfMul(az, by)));
+        vfStore(result.y + i, vfSub(vfMul(az, bx), vfMul(ax, bz)));
+        vfStore(result.z + i, vfSub(vfMul(ax, by), vfMul(ay, bx)));
+    }
+}
+
+// result needs v3stream_paddedLen(a.len) floats, aligned like the streams
+void v3stream_len(v3stream_t a, float *result)
+{
+    for (int i = 0; i < a.len; i += VF_WIDTH)
+    {
+        vf_t x = vfLoad(a.x + i), y = vfLoad(a.y + i), z = vfLoad(a.z + i);
+        vfStore(result + i, vfSqrt(vfAdd(vfMul(x, x), vfAdd(vfMul(y, y), vfMul(z, z)))));
+    }
+}
+
+// zero length vectors stay zero
+void v3stream_normalize(v3stream_t a, v3stream_t result)
+{
+    for (int i = 0; i < a.len; i += VF_WIDTH)
+    {
+        vf_t x = vfLoad(a.x + i), y = vfLoad(a.y + i), z = vfLoad(a.z + i);
+        vf_t invLen = vfSafeRecip(vfSqrt(vfAdd(vfMul(x, x), vfAdd(vfMul(y, y), vfMul(z, z)))));
+        vfStore(result.x + i, vfMul(x, invLen));
+        vfStore(result.y + i, vfMul(y, invLen));
+        vfStore(result.z + i, vfMul(z, invLen));
+    }
+}
+
+void v3stream_interpolate(v3stream_t from, v3stream_t to, float t, v3stream_t result)
+{
+    vf_t weight = vfSet(t);
+    for (int i = 0; i < from.len; i += VF_WIDTH)
+    {
+        vf_t x = vfLoad(from.x + i), y = vfLoad(from.y + i), z = vfLoad(from.z + i);
+        vfStore(result.x + i, vfAdd(x, vfMul(vfSub(vfLoad(to.x + i), x), weight)));
+        vfStore(result.y + i, vfAdd(y, vfMul(vfSub(vfLoad(to.y + i), y), weight)));
+        vfStore(result.z + i, vfAdd(z, vfMul(vfSub(vfLoad(to.z + i), z), weight)));
+    }
+}
+
+// an empty stream gives min = +inf and max = -inf
+void v3stream_bounds(v3stream_t a, v3_t *min, v3_t *max)
+{
+    float lower[3] = {INFINITY, INFINITY, INFINITY};
+    float upper[3] = {-INFINITY, -INFINITY, -INFINITY};
+    float *components[3] = {a.x, a.y, a.z};
+
+    // padded lanes would count as zeros, so only whole vectors go through SIMD
+    int vectorEnd = a.len / VF_WIDTH * VF_WIDTH;
+    for (int c = 0; c < 3; ++c)
+    {
+        float *values = components[c];
+        if (vectorEnd > 0)
+        {
+            vf_t vecMin = vfLoad(values);
+            vf_t vecMax = vecMin;
+            for (int i = VF_WIDTH; i < vectorEnd; i += VF_WIDTH)
+            {
+                vf_t v = vfLoad(values + i);
+                vecMin = vfMin(vecMin, v);
+                vecMax = vfMax(vecMax, v);
+            }
+            _Alignas(32) float lanes[2][VF_WIDTH];
+            vfStore(lanes[0], vecMin);
+            vfStore(lanes[1], vecMax);
+            for (int j = 0; j < VF_WIDTH; ++j)
+            {
+                lower[c] = fminf(lower[c], lanes[0][j]);
+                upper[c] = fmaxf(upper[c], lanes[1][j]);
+            }
+        }
+        for (int i = vectorEnd; i < a.len; ++i)
+        {
+            lower[c] = fminf(lower[c], values[i]);
+            upper[c] = fmaxf(upper[c], values[i]);
+        }
+    }
+
+    *min = v3_create(lower[0], lower[1], lower[2]);
+    *max = v3_create(upper[0], upper[1], upper[2]);
+}
+
+void v3stream_free(v3stream_t s)
+{
+    free(s.x);
+}
@@ -0,0 +1,53 @@
+#ifndef V3STREAM_H
+#define V3STREAM_H
+
+#include "v3.h"
+
+#define V3STREAM_ALIGNMENT 64
+
+// structure of arrays storage for v3s so whole arrays can be processed with SIMD.
+// each component array is 64 byte aligned and zero padded to a multiple of 16
+// floats, so kernels never need a scalar tail
+typedef struct v3stream
+{
+    float *x;
+    float *y;
+    float *z;
+    int len;
+} v3stream_t;
+
+v3stream_t v3stream_create(int len);
+
+int v3stream_paddedLen(int len);
+
+v3stream_t v3stream_fromV3s(v3_t *vs, int len);
+
+void v3stream_toV3s(v3stream_t s, v3_t *result);
+
+v3_t v3stream_get(v3stream_t s, int i);
+
+void v3stream_set(v3stream_t s, int i, v3_t v);
+
+void v3stream_add(v3stream_t a, v3stream_t b, v3stream_t result);
+
+void v3stream_sub(v3stream_t a, v3stream_t b, v3stream_t result);
+
+void v3stream_scale(v3stream_t a, float b, v3stream_t result);
+
+// result needs v3stream_paddedLen(a.len) floats, V3STREAM_ALIGNMENT aligned
+void v3stream_dot(v3stream_t a, v3stream_t b, float *result);
+
+void v3stream_cross(v3stream_t a, v3stream_t b, v3stream_t result);
+
+// result needs v3stream_paddedLen(a.len) floats, V3STREAM_ALIGNMENT aligned
+void v3stream_len(v3stream_t a, float *result);
+
+void v3stream_normalize(v3stream_t a, v3stream_t result);
+
+void v3stream_interpolate(v3stream_t from, v3stream_t to, float t, v3stream_t result);
+
+void v3stream_bounds(v3stream_t a, v3_t *min, v3_t *max);
+
+void v3stream_free(v3stream_t s);
+
+#endif
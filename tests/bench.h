@@ -0,0 +1,29 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <time.h>
+
+static inline double bench_now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+// the fastest of runs calls, in seconds. the minimum is the least disturbed by
+// other work on the machine
+static inline double bench_best(int runs, void (*fn)(void *ctx), void *ctx)
+{
+    double best = 1e30;
+    for (int i = 0; i < runs; ++i)
+    {
+        double start = bench_now();
+        fn(ctx);
+        double elapsed = bench_now() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+#endif
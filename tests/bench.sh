@@ -0,0 +1,29 @@
+# builds every tests/*_bench.c with the production flags and runs it. set CC to
+# use a compiler other than clang
+
+CC=${CC:-clang}
+SOURCES="$(ls ./libs/**/*.c) $(ls ./src/*.c | grep -v '/main\.c$')"
+
+mkdir -p build/tests
+
+for bench in ./tests/*_bench.c; do
+    name=$(basename "$bench" .c)
+    if [ "$name" = mat4x4_bench ]; then
+        continue
+    fi
+    $CC -flto -O3 -Wall -DMATH_HEADER_ONLY -I ./libs -I ./src -I ./tests \
+        $SOURCES "$bench" -lm -pthread -o "./build/tests/$name" &&
+        "./build/tests/$name"
+done
+
+# the math functions are either static inline in their headers or ordinary
+# functions in the .c files, so the mat4x4 benchmark is built both ways, with
+# the debug flags of build.sh and the production flags of build-prod.sh
+for config in "-g" "-flto -O3"; do
+    for math in "-DMATH_HEADER_ONLY" ""; do
+        $CC $config -Wall $math -I ./libs -I ./src -I ./tests \
+            $SOURCES ./tests/mat4x4_bench.c -lm -pthread -o ./build/tests/mat4x4_bench &&
+            echo "$config build:" &&
+            ./build/tests/mat4x4_bench
+    done
+done
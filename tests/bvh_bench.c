@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bvh.h"
+#include "utils.h"
+#include "bench.h"
+#include "test.h"
+
+// instances spread over a volume that keeps their density the same at every
+// count, moved a little between frames the way main.c's cubes are
+static const int INSTANCES_LENS[] = {10000, 100000, 1000000};
+static const int RUNS = 5;
+static const float INSTANCE_SPACING = 4.0f;
+static const float MAX_HALF_SIZE = 1.0f;
+static const float MAX_MOVE = 0.5f;
+
+typedef struct bvhBench
+{
+    v3_t *mins;
+    v3_t *maxs;
+    int len;
+    bvh_t bvh;
+    int numThreads;
+} bvhBench_t;
+
+static void buildJob(void *ctx)
+{
+    bvhBench_t *bench = ctx;
+    bvh_free(bench->bvh);
+    bench->bvh = bvh_build(bench->mins, bench->maxs, bench->len);
+}
+
+static void refitJob(void *ctx)
+{
+    bvhBench_t *bench = ctx;
+    bvh_refit(&bench->bvh, bench->mins, bench->maxs, bench->numThreads);
+}
+
+static void benchInstances(unsigned long long *seed, int len)
+{
+    bvhBench_t bench;
+    bench.len = len;
+    bench.mins = utils_malloc(sizeof(v3_t) * len);
+    bench.maxs = utils_malloc(sizeof(v3_t) * len);
+    float sceneSize = INSTANCE_SPACING * cbrtf((float)len) * 0.5f;
+    for (int i = 0; i < len; ++i)
+    {
+        v3_t center = v3_create(
+            test_randomFloat(seed, -sceneSize, sceneSize), test_randomFloat(seed, -sceneSize, sceneSize), test_randomFloat(seed, -sceneSize, sceneSize));
+        v3_t halfSize = v3_create(
+            test_randomFloat(seed, 0.1f, MAX_HALF_SIZE), test_randomFloat(seed, 0.1f, MAX_HALF_SIZE), test_randomFloat(seed, 0.1f, MAX_HALF_SIZE));
+        bench.mins[i] = v3_sub(center, halfSize);
+        bench.maxs[i] = v3_add(center, halfSize);
+    }
+    bench.bvh = bvh_build(bench.mins, bench.maxs, len);
+
+    double build = bench_best(RUNS, buildJob, &bench);
+    for (int i = 0; i < len; ++i)
+    {
+        v3_t move = v3_create(
+            test_randomFloat(seed, -MAX_MOVE, MAX_MOVE), test_randomFloat(seed, -MAX_MOVE, MAX_MOVE), test_randomFloat(seed, -MAX_MOVE, MAX_MOVE));
+        bench.mins[i] = v3_add(bench.mins[i], move);
+        bench.maxs[i] = v3_add(bench.maxs[i], move);
+    }
+    bench.numThreads = 1;
+    double refit = bench_best(RUNS, refitJob, &bench);
+    bench.numThreads = utils_getNumCores();
+    double refitParallel = bench_best(RUNS, refitJob, &bench);
+
+    printf("  %8d instances  build %8.2f ms  refit %7.2f ms, %7.2f ms on %d threads  %d nodes\n",
+           len, build * 1e3, refit * 1e3, refitParallel * 1e3, bench.numThreads, bench.bvh.nodesLen);
+
+    bvh_free(bench.bvh);
+    free(bench.maxs);
+    free(bench.mins);
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    printf("bvh build and refit\n");
+    for (size_t i = 0; i < sizeof(INSTANCES_LENS) / sizeof(INSTANCES_LENS[0]); ++i)
+    {
+        benchInstances(&seed, INSTANCES_LENS[i]);
+    }
+    return EXIT_SUCCESS;
+}
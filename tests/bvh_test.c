@@ -0,0 +1,252 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bvh.h"
+#include "camera.h"
+#include "utils.h"
+#include "test.h"
+
+static const int LENS[] = {0, 1, 5, 17, 1000, 10007};
+static const int FRUSTUMS_LEN = 16;
+static const int RAYS_LEN = 256;
+static const int REFIT_THREADS = 4;
+static const float SCENE_SIZE = 100.0f;
+static const float MAX_HALF_SIZE = 3.0f;
+// how far boxes move between build and refit, enough to cross many leaves
+static const float MAX_MOVE = 20.0f;
+static const float FOV = M_PI_2;
+static const float Z_NEAR = 0.1f;
+static const float Z_FAR = 100.0f;
+static const float ASPECT_RATIO = 16.0f / 9.0f;
+
+typedef struct scene
+{
+    v3_t *mins;
+    v3_t *maxs;
+    int len;
+} scene_t;
+
+static v3_t randomV3(unsigned long long *seed, float min, float max)
+{
+    return v3_create(test_randomFloat(seed, min, max), test_randomFloat(seed, min, max), test_randomFloat(seed, min, max));
+}
+
+static int compareInts(const void *a, const void *b)
+{
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static bool containsBox(v3_t outerMin, v3_t outerMax, v3_t min, v3_t max)
+{
+    return outerMin.x <= min.x && outerMin.y <= min.y && outerMin.z <= min.z &&
+           outerMax.x >= max.x && outerMax.y >= max.y && outerMax.z >= max.z;
+}
+
+// every item sits in exactly one leaf, and every node holds what's below it
+static void checkTree(bvh_t *bvh, scene_t *scene, const char *stage)
+{
+    int *items = utils_malloc(sizeof(int) * (scene->len > 0 ? scene->len : 1));
+    memcpy(items, bvh->items, sizeof(int) * scene->len);
+    qsort(items, scene->len, sizeof(int), compareInts);
+    for (int i = 0; i < scene->len; ++i)
+    {
+        if (items[i] != i)
+        {
+            TEST_CHECK(false, "%d items %s: item %d is missing or repeated", scene->len, stage, i);
+            break;
+        }
+    }
+    free(items);
+
+    for (int n = 0; n < bvh->nodesLen && scene->len > 0; ++n)
+    {
+        bvh_node_t *node = &bvh->nodes[n];
+        bool isContained = true;
+        if (node->count > 0)
+        {
+            for (int i = node->first; i < node->first + node->count; ++i)
+            {
+                int item = bvh->items[i];
+                isContained = isContained && containsBox(node->min, node->max, scene->mins[item], scene->maxs[item]);
+            }
+        }
+        else
+        {
+            for (int child = node->first; child < node->first + 2; ++child)
+            {
+                isContained = isContained && containsBox(node->min, node->max, bvh->nodes[child].min, bvh->nodes[child].max);
+            }
+        }
+        if (!isContained)
+        {
+            TEST_CHECK(false, "%d items %s: node %d doesn't contain what's below it", scene->len, stage, n);
+            break;
+        }
+    }
+}
+
+static void checkCull(bvh_t *bvh, scene_t *scene, unsigned long long *seed, const char *stage)
+{
+    int *visible = utils_malloc(sizeof(int) * (scene->len > 0 ? scene->len : 1));
+    int *expected = utils_malloc(sizeof(int) * (scene->len > 0 ? scene->len : 1));
+    for (int query = 0; query < FRUSTUMS_LEN; ++query)
+    {
+        camera_t camera = camera_create(
+            randomV3(seed, -SCENE_SIZE, SCENE_SIZE),
+            test_randomFloat(seed, -(float)M_PI, (float)M_PI), test_randomFloat(seed, -1.0f, 1.0f));
+        mat4x4_t proj = mat4x4_createProj(ASPECT_RATIO, FOV, Z_NEAR, Z_FAR);
+        frustum_t frustum = frustum_create(mat4x4_mul(proj, camera_getViewTransform(camera)));
+
+        int visibleLen = bvh_cullFrustum(bvh, frustum, scene->mins, scene->maxs, visible);
+        int expectedLen = 0;
+        for (int i = 0; i < scene->len; ++i)
+        {
+            if (frustum_testAabb(frustum, scene->mins[i], scene->maxs[i]))
+            {
+                expected[expectedLen++] = i;
+            }
+        }
+        qsort(visible, visibleLen, sizeof(int), compareInts);
+        if (visibleLen != expectedLen || memcmp(visible, expected, sizeof(int) * visibleLen) != 0)
+        {
+            TEST_CHECK(false, "%d items %s, frustum %d: bvh_cullFrustum found %d visible, frustum_testAabb %d",
+                       scene->len, stage, query, visibleLen, expectedLen);
+            break;
+        }
+    }
+    free(expected);
+    free(visible);
+}
+
+// the same slab test bvh_raycast uses, so the distances compare exactly
+static bool rayHitsBox(v3_t origin, v3_t invDir, v3_t min, v3_t max, float *entry)
+{
+    float t0 = (min.x - origin.x) * invDir.x;
+    float t1 = (max.x - origin.x) * invDir.x;
+    float tMin = fminf(t0, t1);
+    float tMax = fmaxf(t0, t1);
+    t0 = (min.y - origin.y) * invDir.y;
+    t1 = (max.y - origin.y) * invDir.y;
+    tMin = fmaxf(tMin, fminf(t0, t1));
+    tMax = fminf(tMax, fmaxf(t0, t1));
+    t0 = (min.z - origin.z) * invDir.z;
+    t1 = (max.z - origin.z) * invDir.z;
+    tMin = fmaxf(tMin, fminf(t0, t1));
+    tMax = fminf(tMax, fmaxf(t0, t1));
+    *entry = fmaxf(tMin, 0.0f);
+    return *entry <= tMax;
+}
+
+// rays start outside the scene and aim somewhere inside it. boxes overlap, so
+// two can share the nearest distance and only the distance is compared
+static void checkRaycast(bvh_t *bvh, scene_t *scene, unsigned long long *seed, const char *stage)
+{
+    for (int query = 0; query < RAYS_LEN; ++query)
+    {
+        v3_t origin = v3_mul(v3_normalize(randomV3(seed, -1.0f, 1.0f)), 3.0f * SCENE_SIZE);
+        v3_t dir = v3_normalize(v3_sub(randomV3(seed, -SCENE_SIZE, SCENE_SIZE), origin));
+        // some rays go straight along x, where the slab test divides by zero
+        if (query % 4 == 0)
+        {
+            origin = v3_create(3.0f * SCENE_SIZE, test_randomFloat(seed, -SCENE_SIZE, SCENE_SIZE), test_randomFloat(seed, -SCENE_SIZE, SCENE_SIZE));
+            dir = v3_create(-1.0f, 0.0f, 0.0f);
+        }
+        v3_t invDir = v3_create(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+
+        int expected = -1;
+        float expectedDist = INFINITY;
+        for (int i = 0; i < scene->len; ++i)
+        {
+            float entry;
+            if (rayHitsBox(origin, invDir, scene->mins[i], scene->maxs[i], &entry) && entry < expectedDist)
+            {
+                expected = i;
+                expectedDist = entry;
+            }
+        }
+
+        float hitDist = INFINITY;
+        int hit = bvh_raycast(bvh, origin, dir, scene->mins, scene->maxs, &hitDist);
+        float itemDist = INFINITY;
+        bool isHitValid = hit < 0 || rayHitsBox(origin, invDir, scene->mins[hit], scene->maxs[hit], &itemDist);
+        if ((hit < 0) != (expected < 0) || (hit >= 0 && (hitDist != expectedDist || !isHitValid || itemDist != hitDist)))
+        {
+            TEST_CHECK(false, "%d items %s, ray %d: bvh_raycast hit %d at %g, nearest is %d at %g",
+                       scene->len, stage, query, hit, hitDist, expected, expectedDist);
+            break;
+        }
+    }
+}
+
+static void checkScene(unsigned long long *seed, int len)
+{
+    scene_t scene;
+    scene.len = len;
+    scene.mins = utils_malloc(sizeof(v3_t) * (len > 0 ? len : 1));
+    scene.maxs = utils_malloc(sizeof(v3_t) * (len > 0 ? len : 1));
+    for (int i = 0; i < len; ++i)
+    {
+        v3_t center = randomV3(seed, -SCENE_SIZE, SCENE_SIZE);
+        v3_t halfSize = randomV3(seed, 0.1f, MAX_HALF_SIZE);
+        scene.mins[i] = v3_sub(center, halfSize);
+        scene.maxs[i] = v3_add(center, halfSize);
+    }
+
+    bvh_t bvh = bvh_build(scene.mins, scene.maxs, len);
+    checkTree(&bvh, &scene, "after build");
+    checkCull(&bvh, &scene, seed, "after build");
+    checkRaycast(&bvh, &scene, seed, "after build");
+
+    // moved and resized, the way the rotating cubes change their bounds
+    for (int i = 0; i < len; ++i)
+    {
+        v3_t move = randomV3(seed, -MAX_MOVE, MAX_MOVE);
+        v3_t grow = randomV3(seed, 0.0f, 1.0f);
+        scene.mins[i] = v3_sub(v3_add(scene.mins[i], move), grow);
+        scene.maxs[i] = v3_add(v3_add(scene.maxs[i], move), grow);
+    }
+    bvh_refit(&bvh, scene.mins, scene.maxs, REFIT_THREADS);
+    checkTree(&bvh, &scene, "after refit");
+    checkCull(&bvh, &scene, seed, "after refit");
+    checkRaycast(&bvh, &scene, seed, "after refit");
+
+    bvh_free(bvh);
+    free(scene.maxs);
+    free(scene.mins);
+}
+
+// items in the same place can't be split, the build has to stop rather than
+// recurse forever
+static void checkCoincident(void)
+{
+    int len = 1000;
+    v3_t *mins = utils_malloc(sizeof(v3_t) * len);
+    v3_t *maxs = utils_malloc(sizeof(v3_t) * len);
+    for (int i = 0; i < len; ++i)
+    {
+        mins[i] = v3_create(-1.0f, -1.0f, -1.0f);
+        maxs[i] = v3_create(1.0f, 1.0f, 1.0f);
+    }
+    bvh_t bvh = bvh_build(mins, maxs, len);
+    TEST_CHECK(bvh.nodesLen == 1 && bvh.nodes[0].count == len, "%d coincident items: %d nodes", len, bvh.nodesLen);
+    float hitDist;
+    int hit = bvh_raycast(&bvh, v3_create(-10.0f, 0.0f, 0.0f), v3_create(1.0f, 0.0f, 0.0f), mins, maxs, &hitDist);
+    TEST_CHECK(hit >= 0 && hitDist == 9.0f, "%d coincident items: ray hit %d at %g", len, hit, hitDist);
+    bvh_free(bvh);
+    free(maxs);
+    free(mins);
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    for (size_t i = 0; i < sizeof(LENS) / sizeof(LENS[0]); ++i)
+    {
+        checkScene(&seed, LENS[i]);
+    }
+    checkCoincident();
+    return test_finish("bvh_test");
+}
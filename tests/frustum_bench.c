@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "frustum.h"
+#include "camera.h"
+#include "utils.h"
+#include "bench.h"
+#include "test.h"
+
+// 1M spheres scattered around the camera, about a tenth of them in view with
+// the projection main.c uses
+#define OBJECTS_LEN 1000000
+static const int RUNS = 20;
+static const float FOV = M_PI_2;
+static const float Z_NEAR = 0.1f;
+static const float Z_FAR = 100.0f;
+static const float ASPECT_RATIO = 16.0f / 9.0f;
+static const float MAX_RADIUS = 2.0f;
+
+typedef struct frustumBench
+{
+    frustum_t frustum;
+    v3_t *centers;
+    v3stream_t centerStream;
+    float *radii;
+    unsigned char *isVisible;
+    int visibleLen;
+} frustumBench_t;
+
+static void testSphereJob(void *ctx)
+{
+    frustumBench_t *bench = ctx;
+    int visibleLen = 0;
+    for (int i = 0; i < OBJECTS_LEN; ++i)
+    {
+        bool isVisible = frustum_testSphere(bench->frustum, bench->centers[i], bench->radii[i]);
+        bench->isVisible[i] = isVisible;
+        visibleLen += isVisible;
+    }
+    bench->visibleLen = visibleLen;
+}
+
+static void cullSpheresJob(void *ctx)
+{
+    frustumBench_t *bench = ctx;
+    bench->visibleLen = frustum_cullSpheres(bench->frustum, bench->centerStream, bench->radii, bench->isVisible);
+}
+
+static void report(const char *name, void (*job)(void *ctx), frustumBench_t *bench)
+{
+    double elapsed = bench_best(RUNS, job, bench);
+    printf("  %-20s %8.0f objects/ms, %d visible\n", name, OBJECTS_LEN / (elapsed * 1e3), bench->visibleLen);
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    frustumBench_t bench;
+    int paddedLen = v3stream_paddedLen(OBJECTS_LEN);
+    bench.centers = utils_malloc(sizeof(v3_t) * OBJECTS_LEN);
+    bench.radii = utils_alignedMalloc(V3STREAM_ALIGNMENT, sizeof(float) * paddedLen);
+    bench.isVisible = utils_malloc(paddedLen);
+    memset(bench.radii, 0, sizeof(float) * paddedLen);
+    for (int i = 0; i < OBJECTS_LEN; ++i)
+    {
+        bench.centers[i] = v3_create(
+            test_randomFloat(&seed, -Z_FAR, Z_FAR), test_randomFloat(&seed, -Z_FAR, Z_FAR), test_randomFloat(&seed, -Z_FAR, Z_FAR));
+        bench.radii[i] = test_randomFloat(&seed, 0.1f, MAX_RADIUS);
+    }
+    bench.centerStream = v3stream_fromV3s(bench.centers, OBJECTS_LEN);
+
+    camera_t camera = camera_create(v3_create(0.0f, 0.0f, 0.0f), 0.0f, 0.0f);
+    mat4x4_t proj = mat4x4_createProj(ASPECT_RATIO, FOV, Z_NEAR, Z_FAR);
+    bench.frustum = frustum_create(mat4x4_mul(proj, camera_getViewTransform(camera)));
+
+    printf("frustum culling, %d spheres\n", OBJECTS_LEN);
+    report("frustum_testSphere", testSphereJob, &bench);
+    report("frustum_cullSpheres", cullSpheresJob, &bench);
+
+    v3stream_free(bench.centerStream);
+    free(bench.isVisible);
+    free(bench.radii);
+    free(bench.centers);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "frustum.h"
+#include "camera.h"
+#include "utils.h"
+#include "test.h"
+
+// tests/run.sh builds this with each of the scalar, SSE and AVX kernels. none
+// of the lengths are a multiple of 4 or 8, so every kernel runs into the padding
+static const int LENS[] = {1, 3, 7, 13, 17, 31, 100, 1001, 10007};
+static const float FOV = M_PI_2;
+static const float Z_NEAR = 0.1f;
+static const float Z_FAR = 100.0f;
+static const float ASPECT_RATIO = 16.0f / 9.0f;
+static const float MAX_RADIUS = 5.0f;
+// the kernels sum the plane distance in a different order than v3_dot, so
+// spheres this close to touching a plane may go either way
+static const float MAX_ERROR = 1e-3f;
+
+static const char *kernelName(void)
+{
+#if defined(MAT4X4_AVX)
+    return "avx";
+#elif defined(MAT4X4_SSE)
+    return "sse";
+#elif defined(MAT4X4_NEON) && defined(__aarch64__)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+static frustum_t createFrustum(camera_t camera)
+{
+    mat4x4_t proj = mat4x4_createProj(ASPECT_RATIO, FOV, Z_NEAR, Z_FAR);
+    return frustum_create(mat4x4_mul(proj, camera_getViewTransform(camera)));
+}
+
+static bool isNearPlane(frustum_t frustum, v3_t center, float radius)
+{
+    for (int i = 0; i < FRUSTUM_PLANES_LEN; ++i)
+    {
+        if (fabsf(v3_dot(frustum.normals[i], center) + frustum.distances[i] + radius) <= MAX_ERROR)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the camera sits at the origin looking down +x, the default yaw
+static void checkPlanes(void)
+{
+    frustum_t frustum = createFrustum(camera_create(v3_create(0.0f, 0.0f, 0.0f), 0.0f, 0.0f));
+    TEST_CHECK(frustum_testSphere(frustum, v3_create(10.0f, 0.0f, 0.0f), 1.0f), "sphere in front is culled");
+    TEST_CHECK(!frustum_testSphere(frustum, v3_create(-10.0f, 0.0f, 0.0f), 1.0f), "sphere behind is visible");
+    TEST_CHECK(!frustum_testSphere(frustum, v3_create(Z_FAR + 2.0f, 0.0f, 0.0f), 1.0f), "sphere past the far plane is visible");
+    TEST_CHECK(frustum_testSphere(frustum, v3_create(Z_FAR + 0.5f, 0.0f, 0.0f), 1.0f), "sphere straddling the far plane is culled");
+    // a 90 degree fov puts the side planes at 45 degrees
+    TEST_CHECK(!frustum_testSphere(frustum, v3_create(10.0f, 0.0f, 12.0f), 1.0f), "sphere right of the frustum is visible");
+    TEST_CHECK(frustum_testSphere(frustum, v3_create(10.0f, 0.0f, 10.5f), 1.0f), "sphere touching the right plane is culled");
+    TEST_CHECK(frustum_testAabb(frustum, v3_create(9.0f, -1.0f, -1.0f), v3_create(11.0f, 1.0f, 1.0f)), "box in front is culled");
+    TEST_CHECK(!frustum_testAabb(frustum, v3_create(-11.0f, -1.0f, -1.0f), v3_create(-9.0f, 1.0f, 1.0f)), "box behind is visible");
+}
+
+static void checkCullSpheres(unsigned long long *seed, int len)
+{
+    camera_t camera = camera_create(
+        v3_create(test_randomFloat(seed, -10.0f, 10.0f), test_randomFloat(seed, -10.0f, 10.0f), test_randomFloat(seed, -10.0f, 10.0f)),
+        test_randomFloat(seed, -(float)M_PI, (float)M_PI), test_randomFloat(seed, -1.0f, 1.0f));
+    frustum_t frustum = createFrustum(camera);
+
+    int paddedLen = v3stream_paddedLen(len);
+    v3stream_t centers = v3stream_create(len);
+    float *radii = utils_alignedMalloc(V3STREAM_ALIGNMENT, sizeof(float) * paddedLen);
+    unsigned char *isVisible = utils_malloc(paddedLen);
+    memset(radii, 0, sizeof(float) * paddedLen);
+    for (int i = 0; i < len; ++i)
+    {
+        v3stream_set(centers, i, v3_create(
+            test_randomFloat(seed, -Z_FAR, Z_FAR), test_randomFloat(seed, -Z_FAR, Z_FAR), test_randomFloat(seed, -Z_FAR, Z_FAR)));
+        radii[i] = test_randomFloat(seed, 0.0f, MAX_RADIUS);
+    }
+
+    int visibleLen = frustum_cullSpheres(frustum, centers, radii, isVisible);
+    int expectedLen = 0;
+    int isVisibleLen = 0;
+    for (int i = 0; i < len; ++i)
+    {
+        v3_t center = v3stream_get(centers, i);
+        bool expected = frustum_testSphere(frustum, center, radii[i]);
+        expectedLen += expected;
+        isVisibleLen += isVisible[i];
+        if (isVisible[i] != expected && !isNearPlane(frustum, center, radii[i]))
+        {
+            TEST_CHECK(false, "%s frustum_cullSpheres, len %d, [%d]: %d, frustum_testSphere has %d",
+                       kernelName(), len, i, isVisible[i], expected);
+            break;
+        }
+    }
+    // the count only covers real spheres, not the padding
+    TEST_CHECK(visibleLen == isVisibleLen, "%s frustum_cullSpheres, len %d: returned %d visible, flagged %d",
+               kernelName(), len, visibleLen, isVisibleLen);
+    TEST_CHECK(abs(visibleLen - expectedLen) <= len / 1000, "%s frustum_cullSpheres, len %d: %d visible, frustum_testSphere has %d",
+               kernelName(), len, visibleLen, expectedLen);
+
+    free(isVisible);
+    free(radii);
+    v3stream_free(centers);
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    checkPlanes();
+    for (size_t i = 0; i < sizeof(LENS) / sizeof(LENS[0]); ++i)
+    {
+        checkCullSpheres(&seed, LENS[i]);
+    }
+
+    printf("%s kernels: ", kernelName());
+    return test_finish("frustum_test");
+}
@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "mat4x4.h"
+#include "utils.h"
+#include "bench.h"
+#include "test.h"
+
+// enough matrices to stay in L1 and L2, so the kernels are timed rather than memory
+#define MATS_LEN 1024
+#define POINTS_LEN 4096
+static const int RUNS = 20;
+static const int REPEATS = 100;
+
+typedef struct mat4x4Bench
+{
+    mat4x4_t *a;
+    mat4x4_t *b;
+    mat4x4_t *result;
+    v3_t *translations;
+    v3_t *rotations;
+    v3_t *scales;
+    v3_t *points;
+    v3_t *transformed;
+} mat4x4Bench_t;
+
+static void mulJob(void *ctx)
+{
+    mat4x4Bench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < MATS_LEN; ++i)
+        {
+            bench->result[i] = mat4x4_mul(bench->a[i], bench->b[i]);
+        }
+    }
+}
+
+static void mulBatchJob(void *ctx)
+{
+    mat4x4Bench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        mat4x4_mulBatch(bench->a, bench->b, bench->result, MATS_LEN);
+    }
+}
+
+static void inverseJob(void *ctx)
+{
+    mat4x4Bench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < MATS_LEN; ++i)
+        {
+            bench->result[i] = mat4x4_inverse(bench->a[i]);
+        }
+    }
+}
+
+static void normalMatrixJob(void *ctx)
+{
+    mat4x4Bench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < MATS_LEN; ++i)
+        {
+            bench->result[i] = mat4x4_normalMatrix(bench->a[i]);
+        }
+    }
+}
+
+static void transformPointsJob(void *ctx)
+{
+    mat4x4Bench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        mat4x4_transformPoints(bench->a[repeat], bench->points, bench->transformed, POINTS_LEN);
+    }
+}
+
+static void composeTRSBatchJob(void *ctx)
+{
+    mat4x4Bench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        mat4x4_composeTRSBatch(bench->translations, bench->rotations, bench->scales, bench->result, MATS_LEN);
+    }
+}
+
+static void composeTRSJob(void *ctx)
+{
+    mat4x4Bench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < MATS_LEN; ++i)
+        {
+            bench->result[i] = mat4x4_composeTRS(bench->translations[i], bench->rotations[i], bench->scales[i]);
+        }
+    }
+}
+
+// translate * rotZ * rotY * rotX * scale as separate matrices, the way model
+// matrices were built before the batch functions
+static void composeChainedJob(void *ctx)
+{
+    mat4x4Bench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < MATS_LEN; ++i)
+        {
+            v3_t r = bench->rotations[i];
+            mat4x4_t model = mat4x4_mul(mat4x4_createTranslate(bench->translations[i]), mat4x4_createRotZ(r.z));
+            model = mat4x4_mul(model, mat4x4_createRotY(r.y));
+            model = mat4x4_mul(model, mat4x4_createRotX(r.x));
+            bench->result[i] = mat4x4_mul(model, mat4x4_createScale(bench->scales[i]));
+        }
+    }
+}
+
+static void report(const char *name, void (*job)(void *ctx), mat4x4Bench_t *bench, int opsLen)
+{
+    double elapsed = bench_best(RUNS, job, bench);
+    printf("  %-26s %7.2f ns/op\n", name, elapsed * 1e9 / ((double)opsLen * REPEATS));
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    mat4x4Bench_t bench;
+    bench.a = utils_alignedMalloc(64, sizeof(mat4x4_t) * MATS_LEN);
+    bench.b = utils_alignedMalloc(64, sizeof(mat4x4_t) * MATS_LEN);
+    bench.result = utils_alignedMalloc(64, sizeof(mat4x4_t) * MATS_LEN);
+    bench.translations = utils_malloc(sizeof(v3_t) * MATS_LEN);
+    bench.rotations = utils_malloc(sizeof(v3_t) * MATS_LEN);
+    bench.scales = utils_malloc(sizeof(v3_t) * MATS_LEN);
+    bench.points = utils_malloc(sizeof(v3_t) * POINTS_LEN);
+    bench.transformed = utils_malloc(sizeof(v3_t) * POINTS_LEN);
+
+    for (int i = 0; i < MATS_LEN; ++i)
+    {
+        bench.translations[i] = v3_create(test_randomFloat(&seed, -100.0f, 100.0f), test_randomFloat(&seed, -100.0f, 100.0f), 0.0f);
+        bench.rotations[i] = v3_create(test_randomFloat(&seed, -M_PI, M_PI), test_randomFloat(&seed, -M_PI, M_PI), test_randomFloat(&seed, -M_PI, M_PI));
+        bench.scales[i] = v3_create(test_randomFloat(&seed, 0.5f, 2.0f), 1.0f, 1.0f);
+    }
+    mat4x4_composeTRSBatch(bench.translations, bench.rotations, bench.scales, bench.a, MATS_LEN);
+    for (int i = 0; i < MATS_LEN; ++i)
+    {
+        bench.b[i] = mat4x4_transpose(bench.a[MATS_LEN - 1 - i]);
+    }
+    for (int i = 0; i < POINTS_LEN; ++i)
+    {
+        bench.points[i] = v3_create(test_randomFloat(&seed, -1.0f, 1.0f), test_randomFloat(&seed, -1.0f, 1.0f), 0.0f);
+    }
+
+#ifdef MATH_HEADER_ONLY
+    const char *math = "header only math";
+#else
+    const char *math = "linked math";
+#endif
+#if defined(MAT4X4_AVX)
+    printf("mat4x4, avx kernels, %s\n", math);
+#elif defined(MAT4X4_SSE)
+    printf("mat4x4, sse kernels, %s\n", math);
+#elif defined(MAT4X4_NEON)
+    printf("mat4x4, neon kernels, %s\n", math);
+#else
+    printf("mat4x4, scalar kernels, %s\n", math);
+#endif
+    report("mat4x4_mul per object", mulJob, &bench, MATS_LEN);
+    report("mat4x4_mulBatch", mulBatchJob, &bench, MATS_LEN);
+    report("mat4x4_inverse", inverseJob, &bench, MATS_LEN);
+    report("mat4x4_normalMatrix", normalMatrixJob, &bench, MATS_LEN);
+    report("mat4x4_transformPoints", transformPointsJob, &bench, POINTS_LEN);
+    report("chained TRS per object", composeChainedJob, &bench, MATS_LEN);
+    report("mat4x4_composeTRS", composeTRSJob, &bench, MATS_LEN);
+    report("mat4x4_composeTRSBatch", composeTRSBatchJob, &bench, MATS_LEN);
+
+    free(bench.a);
+    free(bench.b);
+    free(bench.result);
+    free(bench.translations);
+    free(bench.rotations);
+    free(bench.scales);
+    free(bench.points);
+    free(bench.transformed);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,455 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <string.h>
+#include <math.h>
+#include "mat4x4.h"
+#include "test.h"
+
+// every kernel is checked against a double precision scalar reference. errors
+// are counted in float ulps of the sum of the magnitudes that went into each
+// element, which bounds the rounding of a dot product however much it cancels.
+// tests/run.sh builds this with each of the scalar, SSE and AVX kernels
+
+static const int CASES = 10000;
+// 4 products and 3 sums, with some slack for fused or reordered arithmetic
+static const double MUL_MAX_ULPS = 4.0;
+static const double TRANSFORM_MAX_ULPS = 4.0;
+// the inverse goes through the determinant and cofactors, so its error is
+// measured against the magnitude of the inverse and the condition of the input
+static const double INVERSE_MAX_ULPS = 8.0;
+static const double NORMAL_MATRIX_MAX_ULPS = 4.0;
+// sinf and cosf against the polynomial in composeTRSBatch
+static const double COMPOSE_MAX_ULPS = 4.0;
+
+typedef struct refMat
+{
+    double m[4][4];
+} refMat_t;
+
+static const char *kernelName(void)
+{
+#if defined(MAT4X4_AVX)
+    return "avx";
+#elif defined(MAT4X4_SSE)
+    return "sse";
+#elif defined(MAT4X4_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+static mat4x4_t randomMat(unsigned long long *seed)
+{
+    mat4x4_t result;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            result.m[row][col] = test_randomFloat(seed, -1.0f, 1.0f);
+        }
+    }
+    return result;
+}
+
+static v3_t randomV3(unsigned long long *seed, float min, float max)
+{
+    return v3_create(test_randomFloat(seed, min, max), test_randomFloat(seed, min, max), test_randomFloat(seed, min, max));
+}
+
+// an affine transform like the ones objects use, with a non-uniform scale
+static mat4x4_t randomTRS(unsigned long long *seed)
+{
+    return mat4x4_composeTRS(randomV3(seed, -100.0f, 100.0f), randomV3(seed, -M_PI, M_PI), randomV3(seed, 0.25f, 4.0f));
+}
+
+static refMat_t refMul(mat4x4_t a, mat4x4_t b, refMat_t *magnitudes)
+{
+    refMat_t result;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            result.m[row][col] = 0.0;
+            magnitudes->m[row][col] = 0.0;
+            for (int k = 0; k < 4; ++k)
+            {
+                result.m[row][col] += (double)a.m[row][k] * b.m[k][col];
+                magnitudes->m[row][col] += fabs((double)a.m[row][k] * b.m[k][col]);
+            }
+        }
+    }
+    return result;
+}
+
+// gauss-jordan with partial pivoting
+static refMat_t refInverse(mat4x4_t a)
+{
+    double m[4][8];
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            m[row][col] = a.m[row][col];
+            m[row][col + 4] = row == col ? 1.0 : 0.0;
+        }
+    }
+    for (int col = 0; col < 4; ++col)
+    {
+        int pivot = col;
+        for (int row = col + 1; row < 4; ++row)
+        {
+            pivot = fabs(m[row][col]) > fabs(m[pivot][col]) ? row : pivot;
+        }
+        for (int k = 0; k < 8; ++k)
+        {
+            double swap = m[col][k];
+            m[col][k] = m[pivot][k];
+            m[pivot][k] = swap;
+        }
+        double invPivot = 1.0 / m[col][col];
+        for (int k = 0; k < 8; ++k)
+        {
+            m[col][k] *= invPivot;
+        }
+        for (int row = 0; row < 4; ++row)
+        {
+            double factor = row == col ? 0.0 : m[row][col];
+            for (int k = 0; k < 8; ++k)
+            {
+                m[row][k] -= factor * m[col][k];
+            }
+        }
+    }
+
+    refMat_t result;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            result.m[row][col] = m[row][col + 4];
+        }
+    }
+    return result;
+}
+
+static double maxAbs(const refMat_t *a)
+{
+    double result = 0.0;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            result = fmax(result, fabs(a->m[row][col]));
+        }
+    }
+    return result;
+}
+
+static double ulps(double actual, double expected, double magnitude)
+{
+    return fabs(actual - expected) / (magnitude * FLT_EPSILON);
+}
+
+// the largest error of a against the reference, each element scaled by its own
+// magnitude, or by scale when magnitudes is NULL
+static double maxUlps(mat4x4_t a, const refMat_t *expected, const refMat_t *magnitudes, double scale)
+{
+    double result = 0.0;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            double magnitude = magnitudes != NULL ? magnitudes->m[row][col] : scale;
+            magnitude = magnitude > 0.0 ? magnitude : FLT_MIN;
+            result = fmax(result, ulps(a.m[row][col], expected->m[row][col], magnitude));
+        }
+    }
+    return result;
+}
+
+static void checkMul(unsigned long long *seed)
+{
+    double worst = 0.0;
+    for (int i = 0; i < CASES; ++i)
+    {
+        mat4x4_t a = randomMat(seed);
+        mat4x4_t b = randomMat(seed);
+        refMat_t magnitudes;
+        refMat_t expected = refMul(a, b, &magnitudes);
+        worst = fmax(worst, maxUlps(mat4x4_mul(a, b), &expected, &magnitudes, 0.0));
+    }
+    TEST_CHECK(worst <= MUL_MAX_ULPS, "%s mat4x4_mul: %.2f ulps, bound %.0f", kernelName(), worst, MUL_MAX_ULPS);
+
+    // matrices are only 16 byte aligned, so wider kernels must not assume more
+    _Alignas(32) char buffer[16 + sizeof(mat4x4_t) * 3];
+    mat4x4_t *mats = (mat4x4_t *)(buffer + 16);
+    mats[0] = randomMat(seed);
+    mats[1] = randomMat(seed);
+    mats[2] = mat4x4_mul(mats[0], mats[1]);
+    refMat_t magnitudes;
+    refMat_t expected = refMul(mats[0], mats[1], &magnitudes);
+    TEST_CHECK(maxUlps(mats[2], &expected, &magnitudes, 0.0) <= MUL_MAX_ULPS, "%s mat4x4_mul: misaligned result differs", kernelName());
+}
+
+static void checkMulBatch(unsigned long long *seed)
+{
+    // odd, so any paired kernel has a tail
+    enum
+    {
+        BATCH_LEN = 33
+    };
+    mat4x4_t a[BATCH_LEN];
+    mat4x4_t b[BATCH_LEN];
+    mat4x4_t result[BATCH_LEN];
+    double worst = 0.0;
+    for (int i = 0; i < CASES / BATCH_LEN; ++i)
+    {
+        for (int j = 0; j < BATCH_LEN; ++j)
+        {
+            a[j] = randomMat(seed);
+            b[j] = randomMat(seed);
+        }
+        mat4x4_mulBatch(a, b, result, BATCH_LEN);
+        for (int j = 0; j < BATCH_LEN; ++j)
+        {
+            refMat_t magnitudes;
+            refMat_t expected = refMul(a[j], b[j], &magnitudes);
+            worst = fmax(worst, maxUlps(result[j], &expected, &magnitudes, 0.0));
+        }
+
+        // in place over either input
+        mat4x4_t copy[BATCH_LEN];
+        memcpy(copy, a, sizeof(a));
+        mat4x4_mulBatch(copy, b, copy, BATCH_LEN);
+        TEST_CHECK(memcmp(copy, result, sizeof(result)) == 0, "%s mat4x4_mulBatch: result aliasing a differs", kernelName());
+        memcpy(copy, b, sizeof(b));
+        mat4x4_mulBatch(a, copy, copy, BATCH_LEN);
+        TEST_CHECK(memcmp(copy, result, sizeof(result)) == 0, "%s mat4x4_mulBatch: result aliasing b differs", kernelName());
+    }
+    TEST_CHECK(worst <= MUL_MAX_ULPS, "%s mat4x4_mulBatch: %.2f ulps, bound %.0f", kernelName(), worst, MUL_MAX_ULPS);
+}
+
+static void checkTranspose(unsigned long long *seed)
+{
+    for (int i = 0; i < CASES; ++i)
+    {
+        mat4x4_t a = randomMat(seed);
+        mat4x4_t result = mat4x4_transpose(a);
+        bool isEqual = true;
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                isEqual &= result.m[row][col] == a.m[col][row];
+            }
+        }
+        TEST_CHECK(isEqual, "%s mat4x4_transpose: case %d differs", kernelName(), i);
+    }
+}
+
+static void checkInverse(unsigned long long *seed)
+{
+    double worst = 0.0;
+    for (int i = 0; i < CASES; ++i)
+    {
+        // alternate object transforms and general matrices kept away from
+        // singular by a dominant diagonal
+        mat4x4_t a = randomTRS(seed);
+        if (i % 2 == 1)
+        {
+            a = randomMat(seed);
+            for (int j = 0; j < 4; ++j)
+            {
+                a.m[j][j] += a.m[j][j] < 0.0f ? -4.0f : 4.0f;
+            }
+        }
+        refMat_t expected = refInverse(a);
+        // the error of an inverse grows with the condition number, ||a|| * ||a^-1||
+        refMat_t input;
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                input.m[row][col] = a.m[row][col];
+            }
+        }
+        double scale = maxAbs(&expected) * maxAbs(&input) * maxAbs(&expected);
+        worst = fmax(worst, maxUlps(mat4x4_inverse(a), &expected, NULL, scale));
+    }
+    TEST_CHECK(worst <= INVERSE_MAX_ULPS, "%s mat4x4_inverse: %.2f ulps, bound %.0f", kernelName(), worst, INVERSE_MAX_ULPS);
+}
+
+// the inverse transpose of the upper 3x3, the rest identity
+static refMat_t refNormalMatrix(mat4x4_t a)
+{
+    mat4x4_t upper = mat4x4_createIdentity();
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int col = 0; col < 3; ++col)
+        {
+            upper.m[row][col] = a.m[row][col];
+        }
+    }
+    refMat_t inverse = refInverse(upper);
+    refMat_t result;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            result.m[row][col] = inverse.m[col][row];
+        }
+    }
+    return result;
+}
+
+static void checkNormalMatrix(unsigned long long *seed)
+{
+    double worst = 0.0;
+    double worstUniform = 0.0;
+    for (int i = 0; i < CASES; ++i)
+    {
+        mat4x4_t a = randomTRS(seed);
+        refMat_t expected = refNormalMatrix(a);
+        worst = fmax(worst, maxUlps(mat4x4_normalMatrix(a), &expected, NULL, maxAbs(&expected)));
+
+        float scale = test_randomFloat(seed, 0.25f, 4.0f);
+        mat4x4_t uniform = mat4x4_composeTRS(randomV3(seed, -100.0f, 100.0f), randomV3(seed, -M_PI, M_PI), v3_create(scale, scale, scale));
+        expected = refNormalMatrix(uniform);
+        worstUniform = fmax(worstUniform, maxUlps(mat4x4_normalMatrixUniform(uniform), &expected, NULL, maxAbs(&expected)));
+    }
+    TEST_CHECK(worst <= NORMAL_MATRIX_MAX_ULPS, "%s mat4x4_normalMatrix: %.2f ulps, bound %.0f",
+               kernelName(), worst, NORMAL_MATRIX_MAX_ULPS);
+    TEST_CHECK(worstUniform <= NORMAL_MATRIX_MAX_ULPS, "%s mat4x4_normalMatrixUniform: %.2f ulps, bound %.0f",
+               kernelName(), worstUniform, NORMAL_MATRIX_MAX_ULPS);
+}
+
+static void checkTransformPoints(unsigned long long *seed)
+{
+    // an odd length, so any remainder loop is covered too
+    enum
+    {
+        POINTS_LEN = 37
+    };
+    v3_t points[POINTS_LEN];
+    v3_t result[POINTS_LEN];
+    double worst = 0.0;
+    for (int i = 0; i < CASES / POINTS_LEN; ++i)
+    {
+        mat4x4_t a = randomTRS(seed);
+        for (int j = 0; j < POINTS_LEN; ++j)
+        {
+            points[j] = randomV3(seed, -100.0f, 100.0f);
+        }
+        mat4x4_transformPoints(a, points, result, POINTS_LEN);
+
+        for (int j = 0; j < POINTS_LEN; ++j)
+        {
+            float p[4] = {points[j].x, points[j].y, points[j].z, 1.0f};
+            float r[3] = {result[j].x, result[j].y, result[j].z};
+            for (int row = 0; row < 3; ++row)
+            {
+                double expected = 0.0;
+                double magnitude = 0.0;
+                for (int k = 0; k < 4; ++k)
+                {
+                    expected += (double)a.m[row][k] * p[k];
+                    magnitude += fabs((double)a.m[row][k] * p[k]);
+                }
+                worst = fmax(worst, ulps(r[row], expected, magnitude));
+            }
+        }
+    }
+    TEST_CHECK(worst <= TRANSFORM_MAX_ULPS, "%s mat4x4_transformPoints: %.2f ulps, bound %.0f",
+               kernelName(), worst, TRANSFORM_MAX_ULPS);
+
+    // in place
+    mat4x4_t a = randomTRS(seed);
+    for (int j = 0; j < POINTS_LEN; ++j)
+    {
+        points[j] = randomV3(seed, -100.0f, 100.0f);
+    }
+    mat4x4_transformPoints(a, points, result, POINTS_LEN);
+    mat4x4_transformPoints(a, points, points, POINTS_LEN);
+    for (int j = 0; j < POINTS_LEN; ++j)
+    {
+        TEST_CHECK(points[j].x == result[j].x && points[j].y == result[j].y && points[j].z == result[j].z,
+                   "%s mat4x4_transformPoints: in place point %d differs", kernelName(), j);
+    }
+}
+
+// translate * rotZ * rotY * rotX * scale
+static refMat_t refComposeTRS(v3_t t, v3_t r, v3_t s)
+{
+    double sx = sin(r.x), cx = cos(r.x);
+    double sy = sin(r.y), cy = cos(r.y);
+    double sz = sin(r.z), cz = cos(r.z);
+    refMat_t result = {{
+        {cz * cy * s.x, (cz * sy * sx - sz * cx) * s.y, (cz * sy * cx + sz * sx) * s.z, t.x},
+        {sz * cy * s.x, (sz * sy * sx + cz * cx) * s.y, (sz * sy * cx - cz * sx) * s.z, t.y},
+        {-sy * s.x, cy * sx * s.y, cy * cx * s.z, t.z},
+        {0.0, 0.0, 0.0, 1.0},
+    }};
+    return result;
+}
+
+static void checkComposeTRSBatch(unsigned long long *seed, float maxAngle)
+{
+    // not a multiple of 4, so the scalar tail is covered too
+    enum
+    {
+        BATCH_LEN = 103
+    };
+    v3_t translations[BATCH_LEN];
+    v3_t rotations[BATCH_LEN];
+    v3_t scales[BATCH_LEN];
+    mat4x4_t result[BATCH_LEN];
+    double worst = 0.0;
+    for (int i = 0; i < CASES / BATCH_LEN; ++i)
+    {
+        for (int j = 0; j < BATCH_LEN; ++j)
+        {
+            translations[j] = randomV3(seed, -100.0f, 100.0f);
+            rotations[j] = randomV3(seed, -maxAngle, maxAngle);
+            scales[j] = randomV3(seed, 0.25f, 4.0f);
+        }
+        mat4x4_composeTRSBatch(translations, rotations, scales, result, BATCH_LEN);
+
+        for (int j = 0; j < BATCH_LEN; ++j)
+        {
+            refMat_t expected = refComposeTRS(translations[j], rotations[j], scales[j]);
+            // rotation terms are scaled by their column's scale, translations are exact
+            refMat_t magnitudes;
+            for (int row = 0; row < 4; ++row)
+            {
+                float columnScales[4] = {scales[j].x, scales[j].y, scales[j].z, 0.0f};
+                for (int col = 0; col < 4; ++col)
+                {
+                    magnitudes.m[row][col] = col < 3 ? columnScales[col] : fabs(expected.m[row][col]);
+                }
+            }
+            worst = fmax(worst, maxUlps(result[j], &expected, &magnitudes, 0.0));
+        }
+    }
+    TEST_CHECK(worst <= COMPOSE_MAX_ULPS, "%s mat4x4_composeTRSBatch, angles to %g: %.2f ulps, bound %.0f",
+               kernelName(), maxAngle, worst, COMPOSE_MAX_ULPS);
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    checkMul(&seed);
+    checkMulBatch(&seed);
+    checkTranspose(&seed);
+    checkInverse(&seed);
+    checkNormalMatrix(&seed);
+    checkTransformPoints(&seed);
+    checkComposeTRSBatch(&seed, M_PI);
+    // angles from an ever growing time, within and past the fast reduction's range
+    checkComposeTRSBatch(&seed, 8192.0f);
+    checkComposeTRSBatch(&seed, 1e6f);
+
+    printf("%s kernels: ", kernelName());
+    return test_finish("mat4x4_test");
+}
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "mesh.h"
+#include "utils.h"
+#include "bench.h"
+#include "test.h"
+
+// the same 512 x 512 grid written with each face layout, so the general face
+// path can be compared against plain triangles
+static const int GRID_SIZE = 512;
+static const char *BENCH_PATH = "./build/tests/mesh_bench.obj";
+static const int RUNS = 5;
+
+typedef enum faceLayout
+{
+    FACE_TRIANGLES,
+    FACE_QUADS,
+    FACE_NEGATIVE_TRIANGLES,
+    FACE_TRIANGLES_VN,
+} faceLayout_t;
+
+static const char *LAYOUT_NAMES[] = {
+    "v/vt triangles",
+    "v/vt quads",
+    "negative v/vt triangles",
+    "v/vt/vn triangles",
+};
+
+typedef struct loadBench
+{
+    int numThreads;
+    int indicesLen;
+} loadBench_t;
+
+static void writeGrid(faceLayout_t layout)
+{
+    FILE *file = fopen(BENCH_PATH, "w");
+    if (file == NULL)
+    {
+        printf("failed to open file: %s", BENCH_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned long long seed = 1;
+    int rowLen = GRID_SIZE + 1;
+    int verticesLen = rowLen * rowLen;
+    for (int y = 0; y < rowLen; ++y)
+    {
+        for (int x = 0; x < rowLen; ++x)
+        {
+            fprintf(file, "v %f %f %f\n", x * 0.01f, y * 0.01f, test_randomFloat(&seed, -0.01f, 0.01f));
+        }
+    }
+    for (int y = 0; y < rowLen; ++y)
+    {
+        for (int x = 0; x < rowLen; ++x)
+        {
+            fprintf(file, "vt %f %f\n", (float)x / GRID_SIZE, (float)y / GRID_SIZE);
+        }
+    }
+    fprintf(file, "vn 0 0 1\n");
+
+    for (int y = 0; y < GRID_SIZE; ++y)
+    {
+        for (int x = 0; x < GRID_SIZE; ++x)
+        {
+            int a = y * rowLen + x + 1;
+            int b = a + 1;
+            int c = a + rowLen;
+            int d = c + 1;
+            switch (layout)
+            {
+            case FACE_TRIANGLES:
+                fprintf(file, "f %d/%d %d/%d %d/%d\n", a, a, b, b, d, d);
+                fprintf(file, "f %d/%d %d/%d %d/%d\n", a, a, d, d, c, c);
+                break;
+            case FACE_QUADS:
+                fprintf(file, "f %d/%d %d/%d %d/%d %d/%d\n", a, a, b, b, d, d, c, c);
+                break;
+            case FACE_NEGATIVE_TRIANGLES:
+                a -= verticesLen + 1;
+                b -= verticesLen + 1;
+                c -= verticesLen + 1;
+                d -= verticesLen + 1;
+                fprintf(file, "f %d/%d %d/%d %d/%d\n", a, a, b, b, d, d);
+                fprintf(file, "f %d/%d %d/%d %d/%d\n", a, a, d, d, c, c);
+                break;
+            case FACE_TRIANGLES_VN:
+                fprintf(file, "f %d/%d/1 %d/%d/1 %d/%d/1\n", a, a, b, b, d, d);
+                fprintf(file, "f %d/%d/1 %d/%d/1 %d/%d/1\n", a, a, d, d, c, c);
+                break;
+            }
+        }
+    }
+    fclose(file);
+}
+
+static void loadJob(void *ctx)
+{
+    loadBench_t *bench = ctx;
+    vertex_t *verts;
+    unsigned int *indices;
+    mesh_loadVertsParallel(&verts, &indices, &bench->indicesLen, (char *)BENCH_PATH, bench->numThreads);
+    free(verts);
+    free(indices);
+}
+
+int main(void)
+{
+    int numCores = utils_getNumCores();
+    printf("mesh_loadVertsParallel, %d x %d grid\n", GRID_SIZE, GRID_SIZE);
+    for (int layout = 0; layout < (int)(sizeof(LAYOUT_NAMES) / sizeof(LAYOUT_NAMES[0])); ++layout)
+    {
+        writeGrid(layout);
+        loadBench_t bench = {0};
+        double baseline = 0.0;
+        for (int numThreads = 1; numThreads <= numCores; numThreads *= 2)
+        {
+            bench.numThreads = numThreads;
+            double elapsed = bench_best(RUNS, loadJob, &bench);
+            baseline = numThreads == 1 ? elapsed : baseline;
+            double megatris = bench.indicesLen / 3 / 1e6;
+            printf("  %-24s %2d thread(s): %7.1f ms  %6.2f Mtri/s  %5.1fx\n",
+                   LAYOUT_NAMES[layout], numThreads, elapsed * 1e3, megatris / elapsed, baseline / elapsed);
+        }
+    }
+
+    remove(BENCH_PATH);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "mesh.h"
+#include "utils.h"
+#include "test.h"
+
+static const char *OBJ_PATH = "./build/tests/mesh_test.obj";
+
+// a unit square in the z = 0 plane, with a tex coord per corner and a +z normal
+#define SQUARE                        \
+    "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n" \
+    "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"     \
+    "vn 0 0 1\n"
+
+// a regular pentagon of radius 1 in the z = 0 plane
+#define PENTAGON                                                         \
+    "v 1 0 0\nv 0.309017 0.951057 0\nv -0.809017 0.587785 0\n"          \
+    "v -0.809017 -0.587785 0\nv 0.309017 -0.951057 0\n"
+
+typedef struct conformanceCase
+{
+    const char *name;
+    const char *text;
+    // tex coords equal the x and y of each position, or are 0, 0 without vt
+    bool hasTexCoords;
+    int vertsLen;
+    int indicesLen;
+    // summed area of the loaded triangles, every one of which faces +z
+    float area;
+} conformanceCase_t;
+
+static const conformanceCase_t VALID_CASES[] = {
+    {"triangle v/vt/vn", SQUARE "f 1/1/1 2/2/1 3/3/1\n", true, 3, 3, 0.5f},
+    {"triangle v/vt", SQUARE "f 1/1 2/2 3/3\n", true, 3, 3, 0.5f},
+    {"triangle v//vn", SQUARE "f 1//1 2//1 3//1\n", false, 3, 3, 0.5f},
+    {"triangle v", SQUARE "f 1 2 3\n", false, 3, 3, 0.5f},
+    {"quad v/vt/vn", SQUARE "f 1/1/1 2/2/1 3/3/1 4/4/1\n", true, 4, 6, 1.0f},
+    {"quad v", SQUARE "f 1 2 3 4\n", false, 4, 6, 1.0f},
+    {"pentagon v", PENTAGON "f 1 2 3 4 5\n", false, 5, 9, 2.377641f},
+    {"concave quad v", "v 0 0 0\nv 2 0 0\nv 0.5 0.5 0\nv 0 2 0\nf 1 2 3 4\n", false, 4, 6, 1.0f},
+    {"negative v/vt/vn", SQUARE "f -4/-4/-1 -3/-3/-1 -2/-2/-1 -1/-1/-1\n", true, 4, 6, 1.0f},
+    {"negative after more records", SQUARE "f 1/1/1 2/2/1 3/3/1\nv 2 0 0\nvt 2 0\nf 2/2/1 -1/-1/1 3/3/1\n",
+     true, 4, 6, 1.0f},
+    {"mixed triangles and quads", SQUARE "v 2 0 0\nv 2 1 0\nvt 2 0\nvt 2 1\nf 1/1 2/2 3/3 4/4\nf 2/2 5/5 6/6\nf 2/2 6/6 3/3\n",
+     true, 6, 12, 2.0f},
+    {"crlf and comments", SQUARE "# square\r\nf 1/1 2/2 3/3 4/4 # quad\r\n", true, 4, 6, 1.0f},
+};
+
+typedef struct invalidCase
+{
+    const char *name;
+    const char *text;
+} invalidCase_t;
+
+// every one of these must fail the load rather than read a default or another
+// record
+static const invalidCase_t INVALID_CASES[] = {
+    {"v 0", SQUARE "f 0 1 2\n"},
+    {"v past the end", SQUARE "f 1 2 5\n"},
+    {"v negative past the start", SQUARE "f -5 1 2\n"},
+    {"vt 0", SQUARE "f 1/0 2/2 3/3\n"},
+    {"vt past the end", SQUARE "f 1/1 2/2 3/5\n"},
+    {"vt negative past the start", SQUARE "f 1/-5 2/2 3/3\n"},
+    {"vt 0 in a quad", SQUARE "f 1/1 2/2 3/3 4/0\n"},
+    {"vn 0", SQUARE "f 1//0 2//1 3//1\n"},
+    {"vn past the end", SQUARE "f 1/1/1 2/2/1 3/3/2\n"},
+    {"vn negative past the start", SQUARE "f 1/1/-2 2/2/1 3/3/1\n"},
+};
+
+static void writeObj(const char *text)
+{
+    FILE *file = fopen(OBJ_PATH, "wb");
+    fputs(text, file);
+    fclose(file);
+}
+
+static void checkValid(const conformanceCase_t *test)
+{
+    writeObj(test->text);
+    vertex_t *verts;
+    unsigned int *indices;
+    int indicesLen;
+    int vertsLen = mesh_loadVerts(&verts, &indices, &indicesLen, (char *)OBJ_PATH);
+
+    TEST_CHECK(vertsLen == test->vertsLen, "%s: %d vertices, expected %d", test->name, vertsLen, test->vertsLen);
+    TEST_CHECK(indicesLen == test->indicesLen, "%s: %d indices, expected %d", test->name, indicesLen, test->indicesLen);
+
+    float area = 0.0f;
+    for (int i = 0; i + 2 < indicesLen; i += 3)
+    {
+        if (indices[i] >= (unsigned int)vertsLen || indices[i + 1] >= (unsigned int)vertsLen ||
+            indices[i + 2] >= (unsigned int)vertsLen)
+        {
+            TEST_CHECK(false, "%s: index out of range in triangle %d", test->name, i / 3);
+            continue;
+        }
+        v3_t a = verts[indices[i]].pos;
+        v3_t b = verts[indices[i + 1]].pos;
+        v3_t c = verts[indices[i + 2]].pos;
+        v3_t normal = v3_cross(v3_sub(b, a), v3_sub(c, a));
+        TEST_CHECK(normal.z > 0.0f, "%s: triangle %d is flipped or degenerate", test->name, i / 3);
+        area += normal.z * 0.5f;
+    }
+    TEST_CHECK(fabsf(area - test->area) < 1e-4f, "%s: area %f, expected %f", test->name, area, test->area);
+
+    for (int i = 0; i < vertsLen; ++i)
+    {
+        TEST_CHECK(fabsf(verts[i].normal.z - 1.0f) < 1e-5f, "%s: vertex %d normal is not +z", test->name, i);
+        v2_t expected = test->hasTexCoords ? v2_create(verts[i].pos.x, verts[i].pos.y) : v2_create(0.0f, 0.0f);
+        TEST_CHECK(verts[i].texCoords.x == expected.x && verts[i].texCoords.y == expected.y,
+                   "%s: vertex %d tex coords %f %f, expected %f %f", test->name, i,
+                   verts[i].texCoords.x, verts[i].texCoords.y, expected.x, expected.y);
+    }
+
+    free(verts);
+    free(indices);
+}
+
+// two quads whose u runs away from the edge they share, as a mirrored uv layout
+// does. the seam must be split, with the tangent along +u on each side
+static void checkMirroredSeam(void)
+{
+    writeObj("v 0 0 0\nv 1 0 0\nv 2 0 0\nv 0 1 0\nv 1 1 0\nv 2 1 0\n"
+             "vt 0 0\nvt 1 0\nvt 0 1\nvt 1 1\n"
+             "f 1/1 2/2 5/4 4/3\nf 2/2 3/1 6/3 5/4\n");
+    vertex_t *verts;
+    unsigned int *indices;
+    int indicesLen;
+    int vertsLen = mesh_loadVerts(&verts, &indices, &indicesLen, (char *)OBJ_PATH);
+    TEST_CHECK(vertsLen == 8, "mirrored seam: %d vertices, expected 8", vertsLen);
+
+    for (int i = 0; i < indicesLen; ++i)
+    {
+        vertex_t vert = verts[indices[i]];
+        // the right quad's u decreases along +x
+        float expectedX = i < 6 ? 1.0f : -1.0f;
+        TEST_CHECK(fabsf(vert.tangent.x - expectedX) < 1e-5f && fabsf(vert.tangent.y) < 1e-5f,
+                   "mirrored seam: corner %d tangent %f %f %f, expected %f 0 0",
+                   i, vert.tangent.x, vert.tangent.y, vert.tangent.z, expectedX);
+        v3_t bitangent = v3_mul(v3_cross(vert.normal, vert.tangent), vert.bitangentSign);
+        TEST_CHECK(fabsf(bitangent.y - 1.0f) < 1e-5f, "mirrored seam: corner %d bitangent isn't +v", i);
+    }
+
+    free(verts);
+    free(indices);
+}
+
+// the quaternion instance rows against the mat4x4 path they replace
+static void checkInstanceTRS(void)
+{
+    unsigned long long seed = 1;
+    for (int i = 0; i < 1000; ++i)
+    {
+        v3_t translation = v3_create(test_randomFloat(&seed, -10.0f, 10.0f), test_randomFloat(&seed, -10.0f, 10.0f), 0.0f);
+        v3_t angles = v3_create(test_randomFloat(&seed, -3.0f, 3.0f), test_randomFloat(&seed, -3.0f, 3.0f), test_randomFloat(&seed, -3.0f, 3.0f));
+        v3_t scale = v3_create(test_randomFloat(&seed, 0.25f, 4.0f), test_randomFloat(&seed, 0.25f, 4.0f), test_randomFloat(&seed, 0.25f, 4.0f));
+        meshInstance_t instance = mesh_createInstanceTRS(translation, quat_createEuler(angles), scale);
+        mat4x4_t model = mat4x4_composeTRS(translation, angles, scale);
+        meshInstance_t expected = mesh_createInstance(model, mat4x4_normalMatrix(model));
+
+        float maxError = 0.0f;
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                float scaleError = fabsf(instance.model.m[row][col] - expected.model.m[row][col]) / fmaxf(1.0f, fabsf(expected.model.m[row][col]));
+                float normalError = fabsf(instance.normalMatrix.m[row][col] - expected.normalMatrix.m[row][col]);
+                maxError = fmaxf(maxError, fmaxf(scaleError, normalError));
+            }
+        }
+        TEST_CHECK(maxError < 1e-5f, "mesh_createInstanceTRS: case %d differs by %g", i, maxError);
+    }
+}
+
+// loads in a child, since an invalid file ends the process
+// the packed bitangent sign has to decode to +-1 under the pre 4.2 snorm rule,
+// (2c + 1) / (2^b - 1), as well as the current max(c / (2^(b-1) - 1), -1)
+static void checkPackedBitangentSign(void)
+{
+    vertex_t vertices[2];
+    memset(vertices, 0, sizeof(vertices));
+    vertices[0].tangent = v3_create(1.0f, 0.0f, 0.0f);
+    vertices[0].bitangentSign = 1.0f;
+    vertices[1].tangent = v3_create(1.0f, 0.0f, 0.0f);
+    vertices[1].bitangentSign = -1.0f;
+    packedVertex_t packed[2];
+    mesh_quantize(vertices, 2, packed);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        int w = (int32_t)packed[i].tangent >> 30;
+        float legacy = (2.0f * w + 1.0f) / 3.0f;
+        float current = fmaxf((float)w, -1.0f);
+        float expected = vertices[i].bitangentSign;
+        TEST_CHECK(legacy == expected && current == expected,
+                   "bitangent sign %g packs as %d, decoding to %g and %g", expected, w, legacy, current);
+    }
+}
+
+static void checkInvalid(const invalidCase_t *test)
+{
+    writeObj(test->text);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        freopen("/dev/null", "w", stdout);
+        vertex_t *verts;
+        unsigned int *indices;
+        int indicesLen;
+        mesh_loadVerts(&verts, &indices, &indicesLen, (char *)OBJ_PATH);
+        exit(EXIT_SUCCESS);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE, "%s: load didn't fail", test->name);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(VALID_CASES) / sizeof(VALID_CASES[0]); ++i)
+    {
+        checkValid(&VALID_CASES[i]);
+    }
+    checkMirroredSeam();
+    checkInstanceTRS();
+    checkPackedBitangentSign();
+    for (size_t i = 0; i < sizeof(INVALID_CASES) / sizeof(INVALID_CASES[0]); ++i)
+    {
+        checkInvalid(&INVALID_CASES[i]);
+    }
+
+    remove(OBJ_PATH);
+    return test_finish("mesh_test");
+}
@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "meshcache.h"
+#include "meshopt.h"
+#include "utils.h"
+#include "bench.h"
+#include "test.h"
+
+// startup cost of a mesh, from its obj against from its cache, for grids of
+// about 1k to 10M triangles
+static const int GRID_SIZES[] = {23, 71, 224, 708, 2237};
+static const char *OBJ_PATH = "./build/tests/meshcache_bench.obj";
+static const char *CACHE_PATH = "./build/tests/meshcache_bench.obj.mesh";
+static const int RUNS = 3;
+
+typedef struct startupBench
+{
+    int numThreads;
+    int trianglesLen;
+    uint32_t sum;
+} startupBench_t;
+
+static void writeGrid(int gridSize)
+{
+    FILE *file = fopen(OBJ_PATH, "w");
+    if (file == NULL)
+    {
+        printf("failed to open file: %s", OBJ_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned long long seed = 1;
+    int rowLen = gridSize + 1;
+    for (int y = 0; y < rowLen; ++y)
+    {
+        for (int x = 0; x < rowLen; ++x)
+        {
+            fprintf(file, "v %f %f %f\n", x * 0.01f, y * 0.01f, test_randomFloat(&seed, -0.01f, 0.01f));
+        }
+    }
+    for (int y = 0; y < rowLen; ++y)
+    {
+        for (int x = 0; x < rowLen; ++x)
+        {
+            fprintf(file, "vt %f %f\n", (float)x / gridSize, (float)y / gridSize);
+        }
+    }
+    for (int y = 0; y < gridSize; ++y)
+    {
+        for (int x = 0; x < gridSize; ++x)
+        {
+            int a = y * rowLen + x + 1;
+            int b = a + 1;
+            int c = a + rowLen;
+            int d = c + 1;
+            fprintf(file, "f %d/%d %d/%d %d/%d\n", a, a, b, b, d, d);
+            fprintf(file, "f %d/%d %d/%d %d/%d\n", a, a, d, d, c, c);
+        }
+    }
+    fclose(file);
+}
+
+// what startup did without a cache: parse, then pack for upload
+static void objJob(void *ctx)
+{
+    startupBench_t *bench = ctx;
+    vertex_t *vertices;
+    unsigned int *indices;
+    int indicesLen;
+    int verticesLen = mesh_loadVertsParallel(&vertices, &indices, &indicesLen, (char *)OBJ_PATH, bench->numThreads);
+    packedVertex_t *packed = utils_malloc(sizeof(packedVertex_t) * (verticesLen > 0 ? verticesLen : 1));
+    mesh_quantize(vertices, verticesLen, packed);
+    bench->trianglesLen = indicesLen / 3;
+    bench->sum = packed[verticesLen / 2].normal;
+    free(packed);
+    free(vertices);
+    free(indices);
+}
+
+// mapping the cache and reading every byte glBufferData would copy, since the
+// mapping itself only reserves address space
+static void cacheJob(void *ctx)
+{
+    startupBench_t *bench = ctx;
+    meshcache_t cache;
+    if (!meshcache_load(&cache, (char *)CACHE_PATH))
+    {
+        printf("failed to load mesh cache: %s\n", CACHE_PATH);
+        exit(EXIT_FAILURE);
+    }
+    uint32_t *packed = (uint32_t *)cache.packedVertices;
+    size_t packedLen = (size_t)cache.verticesLen * sizeof(packedVertex_t) / sizeof(uint32_t);
+    uint32_t sum = 0;
+    for (size_t i = 0; i < packedLen; ++i)
+    {
+        sum += packed[i];
+    }
+    for (int i = 0; i < cache.indicesLen; ++i)
+    {
+        sum += cache.indices[i];
+    }
+    bench->sum = sum;
+    meshcache_free(cache);
+}
+
+int main(void)
+{
+    int numCores = utils_getNumCores();
+    printf("mesh startup, obj parse + pack against cache map + read, %d thread(s)\n", numCores);
+    for (int i = 0; i < (int)(sizeof(GRID_SIZES) / sizeof(GRID_SIZES[0])); ++i)
+    {
+        writeGrid(GRID_SIZES[i]);
+        startupBench_t bench = {numCores, 0, 0};
+
+        vertex_t *vertices;
+        unsigned int *indices;
+        int indicesLen;
+        int verticesLen = mesh_loadVertsParallel(&vertices, &indices, &indicesLen, (char *)OBJ_PATH, numCores);
+        meshopt_optimizeVertexCache(indices, indicesLen, verticesLen);
+        verticesLen = meshopt_optimizeVertexFetch(vertices, verticesLen, indices, indicesLen);
+        if (!meshcache_write((char *)CACHE_PATH, vertices, verticesLen, indices, indicesLen))
+        {
+            printf("failed to write mesh cache: %s\n", CACHE_PATH);
+            exit(EXIT_FAILURE);
+        }
+        free(vertices);
+        free(indices);
+
+        double objElapsed = bench_best(RUNS, objJob, &bench);
+        double cacheElapsed = bench_best(RUNS, cacheJob, &bench);
+        printf("  %9d triangles: obj %9.2f ms  cache %8.2f ms  %6.1fx\n",
+               bench.trianglesLen, objElapsed * 1e3, cacheElapsed * 1e3, objElapsed / cacheElapsed);
+    }
+
+    remove(OBJ_PATH);
+    remove(CACHE_PATH);
+    return EXIT_SUCCESS;
+}
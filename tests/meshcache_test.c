@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "meshcache.h"
+#include "test.h"
+
+static const char *CACHE_PATH = "./build/tests/meshcache_test.mesh";
+
+static void writeCache(vertex_t *vertices, int verticesLen, unsigned int *indices, int indicesLen)
+{
+    TEST_CHECK(meshcache_write((char *)CACHE_PATH, vertices, verticesLen, indices, indicesLen), "meshcache_write failed");
+}
+
+static bool load(void)
+{
+    meshcache_t cache;
+    bool isLoaded = meshcache_load(&cache, (char *)CACHE_PATH);
+    if (isLoaded)
+    {
+        meshcache_free(cache);
+    }
+    return isLoaded;
+}
+
+// overwrites the file's last index in place, as a stale or damaged cache would
+static void setLastIndex(unsigned int index)
+{
+    FILE *file = fopen(CACHE_PATH, "r+b");
+    fseek(file, -(long)sizeof(index), SEEK_END);
+    fwrite(&index, sizeof(index), 1, file);
+    fclose(file);
+}
+
+static void truncateBy(long bytes)
+{
+    mappedFile_t mapped = utils_mapFile((char *)CACHE_PATH);
+    char *copy = utils_malloc(mapped.len);
+    size_t len = mapped.len - bytes;
+    memcpy(copy, mapped.data, len);
+    utils_unmapFile(mapped);
+
+    FILE *file = fopen(CACHE_PATH, "wb");
+    fwrite(copy, 1, len, file);
+    fclose(file);
+    free(copy);
+}
+
+int main(void)
+{
+    vertex_t vertices[4];
+    memset(vertices, 0, sizeof(vertices));
+    for (int i = 0; i < 4; ++i)
+    {
+        vertices[i].pos = v3_create((float)(i & 1), (float)(i >> 1), 0.0f);
+    }
+    unsigned int indices[] = {0, 1, 3, 0, 3, 2};
+    int indicesLen = sizeof(indices) / sizeof(indices[0]);
+
+    writeCache(vertices, 4, indices, indicesLen);
+    meshcache_t cache;
+    TEST_CHECK(meshcache_load(&cache, (char *)CACHE_PATH), "valid cache rejected");
+    TEST_CHECK(cache.verticesLen == 4 && cache.indicesLen == indicesLen, "cache lengths differ");
+    TEST_CHECK(memcmp(cache.indices, indices, sizeof(indices)) == 0, "cache indices differ");
+    packedVertex_t packed[4];
+    meshQuantization_t quantization = mesh_quantize(vertices, 4, packed);
+    TEST_CHECK(memcmp(cache.packedVertices, packed, sizeof(packed)) == 0, "cache packed vertices differ");
+    TEST_CHECK(memcmp(&cache.quantization, &quantization, sizeof(quantization)) == 0, "cache quantization differs");
+    meshcache_free(cache);
+
+    setLastIndex(3);
+    TEST_CHECK(load(), "cache with the last vertex as its last index rejected");
+    setLastIndex(4);
+    TEST_CHECK(!load(), "cache with an index past the last vertex loaded");
+    setLastIndex(0xffffffffu);
+    TEST_CHECK(!load(), "cache with index 0xffffffff loaded");
+
+    writeCache(vertices, 4, indices, indicesLen);
+    truncateBy(sizeof(unsigned int));
+    TEST_CHECK(!load(), "truncated cache loaded");
+
+    writeCache(vertices, 4, NULL, 0);
+    TEST_CHECK(load(), "cache without indices rejected");
+
+    remove(CACHE_PATH);
+    return test_finish("meshcache_test");
+}
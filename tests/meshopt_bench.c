@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "meshopt.h"
+#include "utils.h"
+#include "bench.h"
+#include "test.h"
+#include "sphere.h"
+
+// a frame of unit spheres of about 65k triangles each, spread between the
+// camera and the far plane, with the window and fov of main.c
+#define OBJECTS_LEN 1000
+static const int SPHERE_RINGS = 128;
+static const int SPHERE_SEGMENTS = 256;
+static const int RUNS = 3;
+static const float SCREEN_HEIGHT = 600.0f;
+static const float FOV = M_PI_2;
+static const float MIN_DISTANCE = 1.0f;
+static const float MAX_DISTANCE = 100.0f;
+
+typedef struct lodBench
+{
+    sphere_t sphere;
+    int numThreads;
+    mesh_t mesh;
+} lodBench_t;
+
+static void generateJob(void *ctx)
+{
+    lodBench_t *bench = ctx;
+    unsigned int *lodIndices;
+    bench->mesh.lodsLen = meshopt_generateLods(
+        bench->sphere.vertices, bench->sphere.verticesLen, bench->sphere.indices, bench->sphere.indicesLen,
+        MESH_MAX_LODS, bench->numThreads, &lodIndices, bench->mesh.lods);
+    free(lodIndices);
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    lodBench_t bench;
+    memset(&bench, 0, sizeof(bench));
+    bench.sphere = sphere_create(SPHERE_RINGS, SPHERE_SEGMENTS);
+
+    printf("lods, sphere of %d triangles\n", bench.sphere.indicesLen / 3);
+    bench.numThreads = 1;
+    double generate = bench_best(RUNS, generateJob, &bench);
+    bench.numThreads = utils_getNumCores();
+    double generateParallel = bench_best(RUNS, generateJob, &bench);
+    printf("  meshopt_generateLods %7.2f ms, %7.2f ms on %d threads\n",
+           generate * 1e3, generateParallel * 1e3, bench.numThreads);
+
+    int objectsPerLod[MESH_MAX_LODS] = {0};
+    long trianglesOff = 0;
+    long trianglesOn = 0;
+    for (int i = 0; i < OBJECTS_LEN; ++i)
+    {
+        float distance = test_randomFloat(&seed, MIN_DISTANCE, MAX_DISTANCE);
+        int lod = mesh_selectLod(bench.mesh, distance, 1.0f, SCREEN_HEIGHT, FOV);
+        ++objectsPerLod[lod];
+        trianglesOff += bench.mesh.lods[0].indicesLen / 3;
+        trianglesOn += bench.mesh.lods[lod].indicesLen / 3;
+    }
+    for (int lod = 0; lod < bench.mesh.lodsLen; ++lod)
+    {
+        printf("  lod %d  %6d triangles, error %.4f, drawn for %d of %d objects\n",
+               lod, bench.mesh.lods[lod].indicesLen / 3, bench.mesh.lods[lod].error, objectsPerLod[lod], OBJECTS_LEN);
+    }
+    printf("  triangles per frame  %ld with lods off, %ld on (%.1f%%)\n",
+           trianglesOff, trianglesOn, 100.0 * trianglesOn / trianglesOff);
+
+    sphere_free(bench.sphere);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "meshopt.h"
+#include "utils.h"
+#include "test.h"
+#include "sphere.h"
+
+// a uv sphere of about 65k triangles, big enough that a row of it doesn't fit
+// in the simulated cache
+static const int SPHERE_RINGS = 128;
+static const int SPHERE_SEGMENTS = 256;
+static const int ACMR_CACHE_SIZE = 32;
+// simplification is much slower than reordering, so it gets a smaller sphere
+static const int LOD_SPHERE_RINGS = 32;
+static const int LOD_SPHERE_SEGMENTS = 64;
+static const int LOD_THREADS = 4;
+
+static int compareUints(const void *a, const void *b)
+{
+    unsigned int x = *(const unsigned int *)a;
+    unsigned int y = *(const unsigned int *)b;
+    return (x > y) - (x < y);
+}
+
+// reordering only moves whole triangles, so every index is still used as often
+static void checkVertexCache(void)
+{
+    sphere_t sphere = sphere_create(SPHERE_RINGS, SPHERE_SEGMENTS);
+    unsigned int *original = utils_malloc(sizeof(unsigned int) * sphere.indicesLen);
+    memcpy(original, sphere.indices, sizeof(unsigned int) * sphere.indicesLen);
+
+    float before = meshopt_calcACMR(sphere.indices, sphere.indicesLen, sphere.verticesLen, ACMR_CACHE_SIZE);
+    meshopt_optimizeVertexCache(sphere.indices, sphere.indicesLen, sphere.verticesLen);
+    float after = meshopt_calcACMR(sphere.indices, sphere.indicesLen, sphere.verticesLen, ACMR_CACHE_SIZE);
+    printf("  sphere, %d triangles: acmr %.3f before, %.3f after\n", sphere.indicesLen / 3, before, after);
+    TEST_CHECK(after < before, "acmr %f after vertex cache ordering, %f before", after, before);
+
+    unsigned int *reordered = utils_malloc(sizeof(unsigned int) * sphere.indicesLen);
+    memcpy(reordered, sphere.indices, sizeof(unsigned int) * sphere.indicesLen);
+    qsort(original, sphere.indicesLen, sizeof(unsigned int), compareUints);
+    qsort(reordered, sphere.indicesLen, sizeof(unsigned int), compareUints);
+    TEST_CHECK(memcmp(original, reordered, sizeof(unsigned int) * sphere.indicesLen) == 0,
+               "vertex cache ordering changed the indices used");
+
+    free(reordered);
+    free(original);
+    sphere_free(sphere);
+}
+
+// every level indexes the same vertices, has fewer triangles than the one
+// before and no triangle folded down to a line or point
+static void checkLods(void)
+{
+    sphere_t sphere = sphere_create(LOD_SPHERE_RINGS, LOD_SPHERE_SEGMENTS);
+    unsigned int *lodIndices;
+    mesh_lod_t lods[MESH_MAX_LODS];
+    int lodsLen = meshopt_generateLods(
+        sphere.vertices, sphere.verticesLen, sphere.indices, sphere.indicesLen,
+        MESH_MAX_LODS, LOD_THREADS, &lodIndices, lods);
+    printf("  sphere, %d triangles: %d lods\n", sphere.indicesLen / 3, lodsLen);
+    TEST_CHECK(lodsLen == MESH_MAX_LODS, "sphere simplified to %d lods", lodsLen);
+    TEST_CHECK(lods[0].firstIndex == 0 && lods[0].indicesLen == sphere.indicesLen &&
+                   memcmp(lodIndices, sphere.indices, sizeof(unsigned int) * sphere.indicesLen) == 0,
+               "lod 0 isn't the original mesh");
+
+    for (int lod = 0; lod < lodsLen; ++lod)
+    {
+        printf("    lod %d: %d triangles, error %g\n", lod, lods[lod].indicesLen / 3, lods[lod].error);
+        TEST_CHECK(lods[lod].indicesLen % 3 == 0, "lod %d has %d indices", lod, lods[lod].indicesLen);
+        if (lod > 0)
+        {
+            TEST_CHECK(lods[lod].firstIndex == lods[lod - 1].firstIndex + lods[lod - 1].indicesLen,
+                       "lod %d starts at %d, not after lod %d", lod, lods[lod].firstIndex, lod - 1);
+            TEST_CHECK(lods[lod].indicesLen < lods[lod - 1].indicesLen && lods[lod].error >= lods[lod - 1].error,
+                       "lod %d: %d triangles at error %g, lod %d has %d at %g", lod, lods[lod].indicesLen / 3,
+                       lods[lod].error, lod - 1, lods[lod - 1].indicesLen / 3, lods[lod - 1].error);
+        }
+
+        unsigned int *tris = lodIndices + lods[lod].firstIndex;
+        for (int i = 0; i < lods[lod].indicesLen; i += 3)
+        {
+            unsigned int a = tris[i];
+            unsigned int b = tris[i + 1];
+            unsigned int c = tris[i + 2];
+            if (a >= (unsigned int)sphere.verticesLen || b >= (unsigned int)sphere.verticesLen ||
+                c >= (unsigned int)sphere.verticesLen)
+            {
+                TEST_CHECK(false, "lod %d, triangle %d: indices %u %u %u out of range", lod, i / 3, a, b, c);
+                break;
+            }
+            // the pole and seam vertices share positions, so indices alone
+            // can't tell
+            v3_t ab = v3_sub(sphere.vertices[b].pos, sphere.vertices[a].pos);
+            v3_t ac = v3_sub(sphere.vertices[c].pos, sphere.vertices[a].pos);
+            if (v3_len(v3_cross(ab, ac)) == 0.0f)
+            {
+                TEST_CHECK(false, "lod %d, triangle %d: indices %u %u %u are degenerate", lod, i / 3, a, b, c);
+                break;
+            }
+        }
+    }
+
+    free(lodIndices);
+    sphere_free(sphere);
+}
+
+int main(void)
+{
+    checkVertexCache();
+    checkLods();
+    return test_finish("meshopt_test");
+}
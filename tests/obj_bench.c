@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "obj.h"
+#include "utils.h"
+#include "bench.h"
+#include "test.h"
+#include "objreference.h"
+
+// a 512 x 512 grid of v/vt quads split into triangles, about 36 MB
+static const int GRID_SIZE = 512;
+static const char *BENCH_PATH = "./build/tests/obj_bench.obj";
+static const int RUNS = 5;
+
+typedef struct parseBench
+{
+    int numThreads;
+    int cornersLen;
+} parseBench_t;
+
+static void writeGrid(void)
+{
+    FILE *file = fopen(BENCH_PATH, "w");
+    if (file == NULL)
+    {
+        printf("failed to open file: %s", BENCH_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned long long seed = 1;
+    int rowLen = GRID_SIZE + 1;
+    for (int y = 0; y < rowLen; ++y)
+    {
+        for (int x = 0; x < rowLen; ++x)
+        {
+            fprintf(file, "v %f %f %f\n", x * 0.01f, y * 0.01f, test_randomFloat(&seed, -1.0f, 1.0f));
+        }
+    }
+    for (int y = 0; y < rowLen; ++y)
+    {
+        for (int x = 0; x < rowLen; ++x)
+        {
+            fprintf(file, "vt %f %f\n", (float)x / GRID_SIZE, (float)y / GRID_SIZE);
+        }
+    }
+    for (int y = 0; y < GRID_SIZE; ++y)
+    {
+        for (int x = 0; x < GRID_SIZE; ++x)
+        {
+            int a = y * rowLen + x + 1;
+            int b = a + 1;
+            int c = a + rowLen;
+            int d = c + 1;
+            fprintf(file, "f %d/%d %d/%d %d/%d\n", a, a, b, b, d, d);
+            fprintf(file, "f %d/%d %d/%d %d/%d\n", a, a, d, d, c, c);
+        }
+    }
+    fclose(file);
+}
+
+static void referenceJob(void *ctx)
+{
+    parseBench_t *bench = ctx;
+    FILE *file = fopen(BENCH_PATH, "r");
+    obj_t obj = obj_create();
+    objreference_parse(&obj, file);
+    fclose(file);
+    bench->cornersLen = obj.cornersLen;
+    obj_free(&obj);
+}
+
+static void parseJob(void *ctx)
+{
+    parseBench_t *bench = ctx;
+    mappedFile_t file = utils_mapFile((char *)BENCH_PATH);
+    obj_t obj = obj_create();
+    obj_parseParallel(&obj, file.data, file.data + file.len, bench->numThreads);
+    utils_unmapFile(file);
+    bench->cornersLen = obj.cornersLen;
+    obj_free(&obj);
+}
+
+int main(void)
+{
+    writeGrid();
+    mappedFile_t file = utils_mapFile((char *)BENCH_PATH);
+    double megabytes = file.len / 1e6;
+    utils_unmapFile(file);
+
+    parseBench_t bench = {0};
+    double reference = bench_best(RUNS, referenceJob, &bench);
+    printf("obj parse, %.1f MB, %d triangles\n", megabytes, bench.cornersLen / 3);
+    printf("  fgets + strtof:          %7.1f ms  %6.1f MB/s\n", reference * 1e3, megabytes / reference);
+
+    int numCores = utils_getNumCores();
+    for (int numThreads = 1; numThreads <= numCores; numThreads *= 2)
+    {
+        bench.numThreads = numThreads;
+        double elapsed = bench_best(RUNS, parseJob, &bench);
+        printf("  mapped, %2d thread(s):    %7.1f ms  %6.1f MB/s  %5.1fx\n",
+               numThreads, elapsed * 1e3, megabytes / elapsed, reference / elapsed);
+    }
+
+    remove(BENCH_PATH);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <dirent.h>
+#include <unistd.h>
+#include "obj.h"
+#include "utils.h"
+#include "test.h"
+#include "objreference.h"
+
+static const int FUZZ_ROUNDS = 200;
+// big enough that obj_parseParallel splits it into several chunks
+static const int PARALLEL_VERTICES = 20000;
+
+typedef struct text
+{
+    char *data;
+    int len;
+    int cap;
+} text_t;
+
+static void appendf(text_t *text, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    text->data = utils_reserve(text->data, &text->cap, text->len + len + 1, sizeof(char));
+    va_start(args, format);
+    vsnprintf(text->data + text->len, len + 1, format, args);
+    va_end(args);
+    text->len += len;
+}
+
+static bool objsEqual(obj_t *a, obj_t *b, const char *name)
+{
+    bool isEqual = a->positionsLen == b->positionsLen &&
+                   a->texCoordsLen == b->texCoordsLen &&
+                   a->normalsLen == b->normalsLen &&
+                   a->cornersLen == b->cornersLen &&
+                   memcmp(a->positions, b->positions, sizeof(v3_t) * a->positionsLen) == 0 &&
+                   memcmp(a->texCoords, b->texCoords, sizeof(v2_t) * a->texCoordsLen) == 0 &&
+                   memcmp(a->normals, b->normals, sizeof(v3_t) * a->normalsLen) == 0 &&
+                   memcmp(a->corners, b->corners, sizeof(obj_corner_t) * a->cornersLen) == 0;
+    TEST_CHECK(isEqual, "%s: parsed records differ (%d/%d positions, %d/%d tex coords, %d/%d corners)", name,
+               a->positionsLen, b->positionsLen, a->texCoordsLen, b->texCoordsLen, a->cornersLen, b->cornersLen);
+    return isEqual;
+}
+
+static obj_t parseReference(const char *data, int len)
+{
+    FILE *file = tmpfile();
+    fwrite(data, 1, len, file);
+    rewind(file);
+    obj_t obj = obj_create();
+    objreference_parse(&obj, file);
+    fclose(file);
+    return obj;
+}
+
+// copied to the heap without a terminator, so reading past the end is caught
+// by address sanitizer builds
+static obj_t parse(const char *data, int len)
+{
+    char *copy = utils_malloc(len > 0 ? len : 1);
+    memcpy(copy, data, len);
+    obj_t obj = obj_create();
+    obj_parse(&obj, copy, copy + len);
+    free(copy);
+    return obj;
+}
+
+static void appendFloat(text_t *text, float value, unsigned long long *seed)
+{
+    switch (test_random(seed) % 6)
+    {
+    case 0:
+        appendf(text, "%f", value);
+        break;
+    case 1:
+        appendf(text, "%.9g", value);
+        break;
+    case 2:
+        appendf(text, "%e", value);
+        break;
+    case 3:
+        appendf(text, "%+.3f", value);
+        break;
+    case 4:
+        appendf(text, "%.12E", value);
+        break;
+    default:
+        appendf(text, "%g", value);
+        break;
+    }
+}
+
+static void appendBlanks(text_t *text, unsigned long long *seed)
+{
+    appendf(text, "%.*s", 1 + test_random(seed) % 3, "   ");
+}
+
+// the records of obj written out again with the number formats, spacing,
+// comments and line endings varied, all within what the old parser read
+static text_t rewrite(obj_t *obj, unsigned long long *seed)
+{
+    text_t text = {0};
+    const char *newline = test_random(seed) % 4 == 0 ? "\r\n" : "\n";
+
+    for (int i = 0; i < obj->positionsLen; ++i)
+    {
+        if (test_random(seed) % 8 == 0)
+        {
+            appendf(&text, "# v%d%s%s", i + 1, newline, test_random(seed) % 2 ? newline : "");
+        }
+        appendf(&text, "%sv", test_random(seed) % 8 == 0 ? " " : "");
+        appendBlanks(&text, seed);
+        appendFloat(&text, obj->positions[i].x, seed);
+        appendBlanks(&text, seed);
+        appendFloat(&text, obj->positions[i].y, seed);
+        appendBlanks(&text, seed);
+        appendFloat(&text, obj->positions[i].z, seed);
+        appendf(&text, "%s", newline);
+    }
+    for (int i = 0; i < obj->texCoordsLen; ++i)
+    {
+        appendf(&text, "vt");
+        appendBlanks(&text, seed);
+        appendFloat(&text, obj->texCoords[i].x, seed);
+        appendBlanks(&text, seed);
+        appendFloat(&text, obj->texCoords[i].y, seed);
+        appendf(&text, "%s", newline);
+    }
+    for (int i = 0; i < obj->cornersLen; i += 3)
+    {
+        appendf(&text, "f");
+        for (int j = 0; j < 3; ++j)
+        {
+            obj_corner_t corner = obj->corners[i + j];
+            appendBlanks(&text, seed);
+            appendf(&text, "%d/%d", corner.pos + 1, corner.texCoord + 1);
+        }
+        appendf(&text, "%s%s", test_random(seed) % 4 == 0 ? " " : "", newline);
+    }
+
+    return text;
+}
+
+// random v/vt meshes, so the fuzzing doesn't only see the shapes in assets/
+static obj_t createRandom(unsigned long long *seed, int verticesLen, int trisLen)
+{
+    obj_t obj = obj_create();
+    for (int i = 0; i < verticesLen; ++i)
+    {
+        obj.positions = utils_reserve(obj.positions, &obj.positionsCap, obj.positionsLen + 1, sizeof(v3_t));
+        obj.positions[obj.positionsLen++] = v3_create(
+            test_randomFloat(seed, -1e4f, 1e4f), test_randomFloat(seed, -1.0f, 1.0f), test_randomFloat(seed, -1e-3f, 1e-3f));
+        obj.texCoords = utils_reserve(obj.texCoords, &obj.texCoordsCap, obj.texCoordsLen + 1, sizeof(v2_t));
+        obj.texCoords[obj.texCoordsLen++] = v2_create(test_randomFloat(seed, 0.0f, 1.0f), test_randomFloat(seed, 0.0f, 1.0f));
+    }
+    for (int i = 0; i < trisLen * 3; ++i)
+    {
+        obj.corners = utils_reserve(obj.corners, &obj.cornersCap, obj.cornersLen + 1, sizeof(obj_corner_t));
+        obj_corner_t *corner = &obj.corners[obj.cornersLen++];
+        corner->pos = test_random(seed) % verticesLen;
+        corner->texCoord = test_random(seed) % verticesLen;
+        corner->normal = OBJ_MISSING_INDEX;
+    }
+    return obj;
+}
+
+static void fuzz(obj_t *source, const char *name, unsigned long long *seed)
+{
+    for (int round = 0; round < FUZZ_ROUNDS; ++round)
+    {
+        text_t text = rewrite(source, seed);
+        obj_t expected = parseReference(text.data, text.len);
+        obj_t result = parse(text.data, text.len);
+        bool isEqual = objsEqual(&expected, &result, name);
+        if (!isEqual)
+        {
+            printf("%.*s\n", text.len, text.data);
+        }
+        obj_free(&expected);
+        obj_free(&result);
+        free(text.data);
+        if (!isEqual)
+        {
+            break;
+        }
+    }
+}
+
+static void testAssets(unsigned long long *seed)
+{
+    DIR *dir = opendir("./assets");
+    TEST_CHECK(dir != NULL, "can't open ./assets, run from the repository root");
+    if (dir == NULL)
+    {
+        return;
+    }
+
+    int numFiles = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        size_t nameLen = strlen(entry->d_name);
+        if (nameLen < 4 || strcmp(entry->d_name + nameLen - 4, ".obj") != 0)
+        {
+            continue;
+        }
+        ++numFiles;
+
+        char path[512];
+        snprintf(path, sizeof(path), "./assets/%s", entry->d_name);
+        FILE *file = fopen(path, "r");
+        obj_t expected = obj_create();
+        objreference_parse(&expected, file);
+        fclose(file);
+
+        mappedFile_t mapped = utils_mapFile(path);
+        obj_t result = obj_create();
+        obj_parse(&result, mapped.data, mapped.data + mapped.len);
+        utils_unmapFile(mapped);
+
+        if (objsEqual(&expected, &result, path))
+        {
+            fuzz(&expected, path, seed);
+        }
+        obj_free(&expected);
+        obj_free(&result);
+    }
+    closedir(dir);
+
+    TEST_CHECK(numFiles > 0, "no .obj files in ./assets");
+}
+
+static void testRandom(unsigned long long *seed)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        obj_t source = createRandom(seed, 1 + test_random(seed) % 64, 1 + test_random(seed) % 64);
+        fuzz(&source, "random mesh", seed);
+        obj_free(&source);
+    }
+}
+
+// the chunked parser has to give the same records as one pass over the file
+static void testParallel(unsigned long long *seed)
+{
+    obj_t source = createRandom(seed, PARALLEL_VERTICES, PARALLEL_VERTICES * 2);
+    text_t text = rewrite(&source, seed);
+    obj_free(&source);
+
+    obj_t expected = parse(text.data, text.len);
+    for (int numThreads = 2; numThreads <= 8; numThreads *= 2)
+    {
+        obj_t result = obj_create();
+        obj_parseParallel(&result, text.data, text.data + text.len, numThreads);
+        objsEqual(&expected, &result, "obj_parseParallel");
+        obj_free(&result);
+    }
+    obj_free(&expected);
+    free(text.data);
+}
+
+// "-" and pipes can't be mapped and go through the heap buffer fallback
+static void testStdin(void)
+{
+    mappedFile_t mapped = utils_mapFile("./assets/cube.obj");
+    int fds[2];
+    TEST_CHECK(pipe(fds) == 0, "pipe failed");
+    // the cube is far smaller than a pipe's buffer, so this can't block
+    TEST_CHECK(write(fds[1], mapped.data, mapped.len) == (ssize_t)mapped.len, "short write to pipe");
+    close(fds[1]);
+    int savedStdin = dup(STDIN_FILENO);
+    dup2(fds[0], STDIN_FILENO);
+    close(fds[0]);
+
+    mappedFile_t piped = utils_mapFile("-");
+    TEST_CHECK(!piped.isMapped, "stdin pipe was mapped");
+    TEST_CHECK(piped.len == mapped.len && memcmp(piped.data, mapped.data, mapped.len) == 0, "stdin pipe contents differ");
+
+    utils_unmapFile(piped);
+    utils_unmapFile(mapped);
+    dup2(savedStdin, STDIN_FILENO);
+    close(savedStdin);
+}
+
+int main(void)
+{
+    unsigned long long seed = 0x9e3779b97f4a7c15ull;
+    testAssets(&seed);
+    testRandom(&seed);
+    testParallel(&seed);
+    testStdin();
+    return test_finish("obj_test");
+}
@@ -0,0 +1,64 @@
+#ifndef OBJREFERENCE_H
+#define OBJREFERENCE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "obj.h"
+#include "utils.h"
+
+// the fgets, utils_getToken and strtof parser that obj_parse replaced, kept to
+// check obj_parse against and to measure it by. like the original it reads v, vt
+// and v/vt triangles, from lines shorter than 128 characters. the results go in
+// an obj_t with 0-based indices
+
+static void objreference_parse(obj_t *obj, FILE *file)
+{
+    char line[256];
+    char token[64];
+
+    while (fgets(line, 128, file) != NULL)
+    {
+        char *linePtr = line;
+        utils_getToken(linePtr, ' ', token, &linePtr);
+
+        if (strcmp(token, "v") == 0)
+        {
+            float posX = strtof(linePtr, &linePtr);
+            float posY = strtof(linePtr, &linePtr);
+            float posZ = strtof(linePtr, &linePtr);
+            obj->positions = utils_reserve(obj->positions, &obj->positionsCap, obj->positionsLen + 1, sizeof(v3_t));
+            obj->positions[obj->positionsLen++] = v3_create(posX, posY, posZ);
+        }
+        else if (strcmp(token, "vt") == 0)
+        {
+            float texCoordX = strtof(linePtr, &linePtr);
+            float texCoordY = strtof(linePtr, &linePtr);
+            obj->texCoords = utils_reserve(obj->texCoords, &obj->texCoordsCap, obj->texCoordsLen + 1, sizeof(v2_t));
+            obj->texCoords[obj->texCoordsLen++] = v2_create(texCoordX, texCoordY);
+        }
+        else if (strcmp(token, "f") == 0)
+        {
+            char *tokenPtr;
+            char indexStr[16];
+
+            obj->corners = utils_reserve(obj->corners, &obj->cornersCap, obj->cornersLen + 3, sizeof(obj_corner_t));
+            for (int i = 0; i < 3; ++i)
+            {
+                utils_getToken(linePtr, ' ', token, &linePtr);
+                tokenPtr = token;
+                utils_getToken(tokenPtr, '/', indexStr, &tokenPtr);
+                int posIdx = strtol(indexStr, NULL, 10);
+                utils_getToken(tokenPtr, '/', indexStr, &tokenPtr);
+                int texCoordIdx = strtol(indexStr, NULL, 10);
+
+                obj_corner_t *corner = &obj->corners[obj->cornersLen++];
+                corner->pos = posIdx - 1;
+                corner->texCoord = texCoordIdx - 1;
+                corner->normal = OBJ_MISSING_INDEX;
+            }
+        }
+    }
+}
+
+#endif
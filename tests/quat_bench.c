@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "mat4x4.h"
+#include "mat3x4.h"
+#include "quat.h"
+#include "mesh.h"
+#include "utils.h"
+#include "bench.h"
+#include "test.h"
+
+// per object transform state kept as euler angles and mat4x4 models, as main
+// did, against quaternions and mat3x4 rows
+#define OBJECTS_LEN 1024
+static const int RUNS = 20;
+static const int REPEATS = 100;
+
+typedef struct quatBench
+{
+    v3_t *translations;
+    v3_t *angles;
+    v3_t *scales;
+    quat_t *orientations;
+    mat4x4_t *models;
+    mat4x4_t *rotations;
+    mat3x4_t *affines;
+    meshInstance_t *instances;
+    quat_t spin;
+    mat4x4_t spinMatrix;
+    mat3x4_t spinAffine;
+} quatBench_t;
+
+static void quatComposeJob(void *ctx)
+{
+    quatBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < OBJECTS_LEN; ++i)
+        {
+            bench->orientations[i] = quat_normalize(quat_mul(bench->spin, bench->orientations[i]));
+        }
+    }
+}
+
+static void mat4x4ComposeJob(void *ctx)
+{
+    quatBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < OBJECTS_LEN; ++i)
+        {
+            bench->rotations[i] = mat4x4_mul(bench->spinMatrix, bench->rotations[i]);
+        }
+    }
+}
+
+static void mat3x4ComposeJob(void *ctx)
+{
+    quatBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < OBJECTS_LEN; ++i)
+        {
+            bench->affines[i] = mat3x4_mul(bench->spinAffine, bench->affines[i]);
+        }
+    }
+}
+
+// euler angles to a mat4x4 model and its normal matrix, then cut to instance rows
+static void eulerInstancesJob(void *ctx)
+{
+    quatBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        mat4x4_composeTRSBatch(bench->translations, bench->angles, bench->scales, bench->models, OBJECTS_LEN);
+        for (int i = 0; i < OBJECTS_LEN; ++i)
+        {
+            bench->instances[i] = mesh_createInstance(bench->models[i], mat4x4_normalMatrixUniform(bench->models[i]));
+        }
+    }
+}
+
+static void quatInstancesJob(void *ctx)
+{
+    quatBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < OBJECTS_LEN; ++i)
+        {
+            bench->instances[i] = mesh_createInstanceTRS(bench->translations[i], bench->orientations[i], bench->scales[i]);
+        }
+    }
+}
+
+static void report(const char *name, void (*job)(void *ctx), quatBench_t *bench)
+{
+    double elapsed = bench_best(RUNS, job, bench);
+    printf("  %-40s %7.2f ns/object\n", name, elapsed * 1e9 / ((double)OBJECTS_LEN * REPEATS));
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    quatBench_t bench;
+    bench.translations = utils_malloc(sizeof(v3_t) * OBJECTS_LEN);
+    bench.angles = utils_malloc(sizeof(v3_t) * OBJECTS_LEN);
+    bench.scales = utils_malloc(sizeof(v3_t) * OBJECTS_LEN);
+    bench.orientations = utils_malloc(sizeof(quat_t) * OBJECTS_LEN);
+    bench.models = utils_alignedMalloc(64, sizeof(mat4x4_t) * OBJECTS_LEN);
+    bench.rotations = utils_alignedMalloc(64, sizeof(mat4x4_t) * OBJECTS_LEN);
+    bench.affines = utils_alignedMalloc(64, sizeof(mat3x4_t) * OBJECTS_LEN);
+    bench.instances = utils_alignedMalloc(64, sizeof(meshInstance_t) * OBJECTS_LEN);
+
+    for (int i = 0; i < OBJECTS_LEN; ++i)
+    {
+        bench.translations[i] = v3_create(test_randomFloat(&seed, -100.0f, 100.0f), test_randomFloat(&seed, -100.0f, 100.0f), 0.0f);
+        bench.angles[i] = v3_create(test_randomFloat(&seed, -M_PI, M_PI), test_randomFloat(&seed, -M_PI, M_PI), test_randomFloat(&seed, -M_PI, M_PI));
+        float scale = test_randomFloat(&seed, 0.5f, 2.0f);
+        bench.scales[i] = v3_create(scale, scale, scale);
+        bench.orientations[i] = quat_createEuler(bench.angles[i]);
+        bench.rotations[i] = quat_toMat4x4(bench.orientations[i]);
+        bench.affines[i] = mat3x4_createTRS(bench.translations[i], bench.orientations[i], bench.scales[i]);
+    }
+    bench.spin = quat_createAxisAngle(v3_create(1.0f, 0.0f, 0.0f), 0.01f);
+    bench.spinMatrix = quat_toMat4x4(bench.spin);
+    bench.spinAffine = mat3x4_createTRS(v3_create(0.0f, 0.0f, 0.0f), bench.spin, v3_create(1.0f, 1.0f, 1.0f));
+
+    printf("per object memory\n");
+    printf("  %-40s %4zu bytes\n", "euler angles + mat4x4 model", sizeof(v3_t) + sizeof(mat4x4_t));
+    printf("  %-40s %4zu bytes\n", "quat + mat3x4 model", sizeof(quat_t) + sizeof(mat3x4_t));
+    printf("  %-40s %4zu bytes\n", "mat4x4 model + normal matrix", sizeof(mat4x4_t) * 2);
+    printf("  %-40s %4zu bytes\n", "instance rows, mat3x4 model + normal", sizeof(meshInstance_t));
+
+    printf("composing a rotation onto every object\n");
+    report("quat_mul + quat_normalize", quatComposeJob, &bench);
+    report("mat4x4_mul", mat4x4ComposeJob, &bench);
+    report("mat3x4_mul", mat3x4ComposeJob, &bench);
+
+    printf("building instance rows\n");
+    report("euler, composeTRSBatch + normalMatrix", eulerInstancesJob, &bench);
+    report("quat, mesh_createInstanceTRS", quatInstancesJob, &bench);
+
+    free(bench.translations);
+    free(bench.angles);
+    free(bench.scales);
+    free(bench.orientations);
+    free(bench.models);
+    free(bench.rotations);
+    free(bench.affines);
+    free(bench.instances);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "renderqueue.h"
+#include "utils.h"
+#include "bench.h"
+#include "test.h"
+
+// a frame of 100k draws spread over a scene's programs and meshes, a fifth of
+// them transparent. only the cpu side runs, submit needs a context
+#define DRAWS_LEN 100000
+#define SHADERS_LEN 8
+#define MESHES_LEN 256
+#define TEXTURES_LEN 32
+static const int RUNS = 20;
+static const float TRANSPARENT_SHARE = 0.2f;
+
+typedef struct queueBench
+{
+    shader_t shaders[SHADERS_LEN];
+    mesh_t meshes[MESHES_LEN];
+    texture_t textures[TEXTURES_LEN];
+    int shaderIndices[DRAWS_LEN];
+    int meshIndices[DRAWS_LEN];
+    enum renderqueue_pass passes[DRAWS_LEN];
+    float depths[DRAWS_LEN];
+    uint64_t pushedKeys[DRAWS_LEN];
+    uint64_t keys[DRAWS_LEN];
+    renderqueue_t queue;
+} queueBench_t;
+
+static void pushAll(queueBench_t *bench)
+{
+    meshInstance_t instance;
+    memset(&instance, 0, sizeof(instance));
+    renderqueue_clear(&bench->queue);
+    for (int i = 0; i < DRAWS_LEN; ++i)
+    {
+        renderqueue_push(
+            &bench->queue, bench->passes[i],
+            &bench->meshes[bench->meshIndices[i]], &bench->shaders[bench->shaderIndices[i]],
+            instance, 0, bench->depths[i]);
+    }
+}
+
+static void pushJob(void *ctx)
+{
+    pushAll(ctx);
+}
+
+static void pushSortJob(void *ctx)
+{
+    queueBench_t *bench = ctx;
+    pushAll(bench);
+    renderqueue_sort(&bench->queue);
+}
+
+static int compareKeys(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void qsortJob(void *ctx)
+{
+    queueBench_t *bench = ctx;
+    memcpy(bench->keys, bench->pushedKeys, sizeof(bench->keys));
+    qsort(bench->keys, DRAWS_LEN, sizeof(uint64_t), compareKeys);
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    queueBench_t *bench = utils_malloc(sizeof(queueBench_t));
+    memset(bench, 0, sizeof(*bench));
+    bench->queue = renderqueue_create();
+    for (int i = 0; i < TEXTURES_LEN; ++i)
+    {
+        bench->textures[i].id = 1 + i;
+    }
+    for (int i = 0; i < SHADERS_LEN; ++i)
+    {
+        bench->shaders[i].id = 1 + i;
+    }
+    for (int i = 0; i < MESHES_LEN; ++i)
+    {
+        bench->meshes[i].VAO = 1 + i;
+        bench->meshes[i].textures = &bench->textures[i % TEXTURES_LEN];
+        bench->meshes[i].texturesLen = 1;
+    }
+    for (int i = 0; i < DRAWS_LEN; ++i)
+    {
+        bench->shaderIndices[i] = test_random(&seed) % SHADERS_LEN;
+        bench->meshIndices[i] = test_random(&seed) % MESHES_LEN;
+        bench->passes[i] = test_randomFloat(&seed, 0.0f, 1.0f) < TRANSPARENT_SHARE ? RENDERQUEUE_TRANSPARENT : RENDERQUEUE_OPAQUE;
+        bench->depths[i] = test_randomFloat(&seed, 0.1f, 100.0f);
+    }
+
+    printf("renderqueue, %d draws, %d programs, %d meshes\n", DRAWS_LEN, SHADERS_LEN, MESHES_LEN);
+    double push = bench_best(RUNS, pushJob, bench);
+    for (int i = 0; i < DRAWS_LEN; ++i)
+    {
+        bench->pushedKeys[i] = bench->queue.entries[i].key;
+    }
+    long unsortedChanges = renderqueue_countStateChanges(&bench->queue);
+    double pushSort = bench_best(RUNS, pushSortJob, bench);
+    long sortedChanges = renderqueue_countStateChanges(&bench->queue);
+    double qsorted = bench_best(RUNS, qsortJob, bench);
+    printf("  push                    %7.2f ms\n", push * 1e3);
+    printf("  push + radix sort       %7.2f ms, sort %.2f ms\n", pushSort * 1e3, (pushSort - push) * 1e3);
+    printf("  qsort on the same keys  %7.2f ms\n", qsorted * 1e3);
+    // transparent draws go back to front whatever their program, so they
+    // account for most of the sorted changes
+    printf("  state changes per frame %7ld unsorted, %ld sorted\n", unsortedChanges, sortedChanges);
+
+    renderqueue_free(bench->queue);
+    free(bench);
+    return EXIT_SUCCESS;
+}
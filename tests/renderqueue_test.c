@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "renderqueue.h"
+#include "utils.h"
+#include "test.h"
+
+// keys only need ids, so programs and meshes are made up rather than created
+#define SHADERS_LEN 5
+#define MESHES_LEN 37
+#define TEXTURES_LEN 7
+static const int ITEMS_LENS[] = {0, 1, 2, 255, 256, 257, 10000};
+static const float TRANSPARENT_SHARE = 0.3f;
+
+typedef struct scene
+{
+    shader_t shaders[SHADERS_LEN];
+    mesh_t meshes[MESHES_LEN];
+    texture_t textures[TEXTURES_LEN];
+} scene_t;
+
+static void createScene(scene_t *scene)
+{
+    memset(scene, 0, sizeof(*scene));
+    for (int i = 0; i < TEXTURES_LEN; ++i)
+    {
+        scene->textures[i].id = 100 + i;
+    }
+    for (int i = 0; i < SHADERS_LEN; ++i)
+    {
+        scene->shaders[i].id = 1 + i * 3;
+    }
+    for (int i = 0; i < MESHES_LEN; ++i)
+    {
+        scene->meshes[i].VAO = 1 + i;
+        // some meshes share a material, one has none
+        scene->meshes[i].textures = &scene->textures[i % TEXTURES_LEN];
+        scene->meshes[i].texturesLen = i == 0 ? 0 : 1;
+    }
+}
+
+static int compareKeys(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void checkSort(scene_t *scene, unsigned long long *seed, int itemsLen)
+{
+    renderqueue_t queue = renderqueue_create();
+    float *depths = utils_malloc(sizeof(float) * (itemsLen > 0 ? itemsLen : 1));
+    enum renderqueue_pass *passes = utils_malloc(sizeof(enum renderqueue_pass) * (itemsLen > 0 ? itemsLen : 1));
+    uint64_t *keys = utils_malloc(sizeof(uint64_t) * (itemsLen > 0 ? itemsLen : 1));
+    meshInstance_t instance;
+    memset(&instance, 0, sizeof(instance));
+
+    for (int i = 0; i < itemsLen; ++i)
+    {
+        passes[i] = test_randomFloat(seed, 0.0f, 1.0f) < TRANSPARENT_SHARE ? RENDERQUEUE_TRANSPARENT : RENDERQUEUE_OPAQUE;
+        depths[i] = test_randomFloat(seed, 0.1f, 100.0f);
+        shader_t *shader = &scene->shaders[test_random(seed) % SHADERS_LEN];
+        mesh_t *mesh = &scene->meshes[test_random(seed) % MESHES_LEN];
+        renderqueue_push(&queue, passes[i], mesh, shader, instance, 0, depths[i]);
+        keys[i] = renderqueue_makeKey(passes[i], *shader, *mesh, depths[i]);
+    }
+    qsort(keys, itemsLen, sizeof(uint64_t), compareKeys);
+    renderqueue_sort(&queue);
+
+    for (int i = 0; i < itemsLen; ++i)
+    {
+        renderqueue_entry_t entry = queue.entries[i];
+        renderqueue_item_t *item = &queue.items[entry.item];
+        if (entry.key != keys[i] ||
+            entry.key != renderqueue_makeKey(passes[entry.item], *item->shader, *item->mesh, depths[entry.item]))
+        {
+            TEST_CHECK(false, "%d items: entry %d has key %llx, qsort has %llx", itemsLen, i,
+                       (unsigned long long)entry.key, (unsigned long long)keys[i]);
+            break;
+        }
+    }
+
+    // opaque draws come first, then the transparent ones back to front
+    for (int i = 0; i + 1 < itemsLen; ++i)
+    {
+        int a = queue.entries[i].item;
+        int b = queue.entries[i + 1].item;
+        if (passes[a] > passes[b])
+        {
+            TEST_CHECK(false, "%d items: entry %d is opaque after a transparent one", itemsLen, i + 1);
+            break;
+        }
+        if (passes[a] == RENDERQUEUE_TRANSPARENT && passes[b] == RENDERQUEUE_TRANSPARENT && depths[a] < depths[b] &&
+            renderqueue_makeKey(RENDERQUEUE_TRANSPARENT, scene->shaders[0], scene->meshes[0], depths[a]) !=
+                renderqueue_makeKey(RENDERQUEUE_TRANSPARENT, scene->shaders[0], scene->meshes[0], depths[b]))
+        {
+            TEST_CHECK(false, "%d items: transparent entry %d at depth %g is in front of the next, at %g",
+                       itemsLen, i, depths[a], depths[b]);
+            break;
+        }
+    }
+
+    free(keys);
+    free(passes);
+    free(depths);
+    renderqueue_free(queue);
+}
+
+// sorted opaque draws switch program at most once per program, and mesh at
+// most once per program and mesh pair
+static void checkStateChanges(scene_t *scene, unsigned long long *seed)
+{
+    renderqueue_t queue = renderqueue_create();
+    meshInstance_t instance;
+    memset(&instance, 0, sizeof(instance));
+    for (int i = 0; i < 10000; ++i)
+    {
+        shader_t *shader = &scene->shaders[test_random(seed) % SHADERS_LEN];
+        mesh_t *mesh = &scene->meshes[test_random(seed) % MESHES_LEN];
+        renderqueue_push(&queue, RENDERQUEUE_OPAQUE, mesh, shader, instance, 0, test_randomFloat(seed, 0.1f, 100.0f));
+    }
+    long unsorted = renderqueue_countStateChanges(&queue);
+    renderqueue_sort(&queue);
+    long sorted = renderqueue_countStateChanges(&queue);
+    TEST_CHECK(sorted <= SHADERS_LEN + SHADERS_LEN * MESHES_LEN,
+               "%ld state changes after sorting, %ld before", sorted, unsorted);
+    renderqueue_free(queue);
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    scene_t scene;
+    createScene(&scene);
+    for (size_t i = 0; i < sizeof(ITEMS_LENS) / sizeof(ITEMS_LENS[0]); ++i)
+    {
+        checkSort(&scene, &seed, ITEMS_LENS[i]);
+    }
+    checkStateChanges(&scene, &seed);
+    return test_finish("renderqueue_test");
+}
@@ -0,0 +1,45 @@
+# builds and runs every tests/*_test.c against the engine sources, no window or
+# GL context is created. set CC to use a compiler other than clang
+
+CC=${CC:-clang}
+SOURCES="$(ls ./libs/**/*.c) $(ls ./src/*.c | grep -v '/main\.c$')"
+
+rm -rf build/tests
+mkdir -p build/tests
+
+failed=0
+for test in ./tests/*_test.c; do
+    name=$(basename "$test" .c)
+    if $CC -g -O1 -Wall -DMATH_HEADER_ONLY -I ./libs -I ./src -I ./tests \
+        $SOURCES "$test" -lm -pthread -o "./build/tests/$name"; then
+        "./build/tests/$name" || failed=1
+    else
+        failed=1
+    fi
+done
+
+# the mat4x4, frustum and v3stream kernels are picked from the target's
+# instruction set, so their tests are built again with the scalar kernels and,
+# where this machine can run them, the AVX ones
+run_variant() {
+    test=$1
+    shift
+    if $CC -g -O1 -Wall -DMATH_HEADER_ONLY "$@" -I ./libs -I ./src -I ./tests \
+        $SOURCES "./tests/$test.c" -lm -pthread -o "./build/tests/${test}_variant"; then
+        "./build/tests/${test}_variant" || failed=1
+    else
+        failed=1
+    fi
+}
+
+run_variant mat4x4_test -DMAT4X4_SCALAR
+run_variant frustum_test -DMAT4X4_SCALAR
+run_variant v3stream_test -DV3STREAM_SCALAR
+if echo 'int main(void) { return !__builtin_cpu_supports("avx2"); }' |
+    $CC -mavx2 -x c - -o ./build/tests/avx_probe 2>/dev/null && ./build/tests/avx_probe; then
+    run_variant mat4x4_test -mavx2 -mfma
+    run_variant frustum_test -mavx2 -mfma
+    run_variant v3stream_test -mavx2 -mfma
+fi
+
+exit $failed
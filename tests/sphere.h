@@ -0,0 +1,80 @@
+#ifndef SPHERE_H
+#define SPHERE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "mesh.h"
+#include "utils.h"
+
+// a generated uv sphere, shared by the meshopt test and benchmark. it has the
+// seams and poles a loaded model has, which simplification has to respect
+
+typedef struct sphere
+{
+    vertex_t *vertices;
+    int verticesLen;
+    unsigned int *indices;
+    int indicesLen;
+} sphere_t;
+
+// rings + 1 rows of segments + 1 vertices, the last column repeating the first
+// with u = 1 as a uv seam. each pole is a row of vertices at the same position,
+// so the rows touching it get one triangle per segment instead of two. the
+// triangles go row by row, the order a naive exporter writes them in
+static sphere_t sphere_create(int rings, int segments)
+{
+    sphere_t sphere;
+    int rowLen = segments + 1;
+    sphere.verticesLen = (rings + 1) * rowLen;
+    sphere.vertices = utils_malloc(sizeof(vertex_t) * sphere.verticesLen);
+    memset(sphere.vertices, 0, sizeof(vertex_t) * sphere.verticesLen);
+    for (int ring = 0; ring <= rings; ++ring)
+    {
+        float theta = (float)M_PI * ring / rings;
+        for (int segment = 0; segment <= segments; ++segment)
+        {
+            float phi = 2.0f * (float)M_PI * (segment % segments) / segments;
+            vertex_t *vert = &sphere.vertices[ring * rowLen + segment];
+            vert->pos = v3_create(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+            vert->normal = vert->pos;
+            vert->texCoords = v2_create((float)segment / segments, 1.0f - (float)ring / rings);
+            vert->tangent = v3_create(-sinf(phi), 0.0f, cosf(phi));
+            vert->bitangentSign = 1.0f;
+        }
+    }
+
+    sphere.indices = utils_malloc(sizeof(unsigned int) * rings * segments * 6);
+    sphere.indicesLen = 0;
+    for (int ring = 0; ring < rings; ++ring)
+    {
+        for (int segment = 0; segment < segments; ++segment)
+        {
+            unsigned int a = ring * rowLen + segment;
+            unsigned int b = a + 1;
+            unsigned int c = a + rowLen;
+            unsigned int d = c + 1;
+            if (ring != 0)
+            {
+                sphere.indices[sphere.indicesLen++] = a;
+                sphere.indices[sphere.indicesLen++] = b;
+                sphere.indices[sphere.indicesLen++] = c;
+            }
+            if (ring != rings - 1)
+            {
+                sphere.indices[sphere.indicesLen++] = b;
+                sphere.indices[sphere.indicesLen++] = d;
+                sphere.indices[sphere.indicesLen++] = c;
+            }
+        }
+    }
+    return sphere;
+}
+
+static void sphere_free(sphere_t sphere)
+{
+    free(sphere.vertices);
+    free(sphere.indices);
+}
+
+#endif
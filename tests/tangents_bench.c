@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tangents.h"
+#include "utils.h"
+#include "bench.h"
+#include "test.h"
+
+// a 1024 x 1024 grid, about 2 Mtri
+static const int GRID_SIZE = 1024;
+static const int RUNS = 5;
+// the single thread cost tangent generation has to stay under
+static const double BUDGET_MS_PER_MTRI = 250.0;
+
+typedef struct tangentsBench
+{
+    vertex_t *vertices;
+    int verticesLen;
+    unsigned int *indices;
+    int indicesLen;
+    int numThreads;
+} tangentsBench_t;
+
+static void createGrid(tangentsBench_t *bench)
+{
+    unsigned long long seed = 1;
+    int rowLen = GRID_SIZE + 1;
+    bench->verticesLen = rowLen * rowLen;
+    bench->vertices = utils_malloc(sizeof(vertex_t) * bench->verticesLen);
+    memset(bench->vertices, 0, sizeof(vertex_t) * bench->verticesLen);
+    for (int y = 0; y < rowLen; ++y)
+    {
+        for (int x = 0; x < rowLen; ++x)
+        {
+            vertex_t *vert = &bench->vertices[y * rowLen + x];
+            vert->pos = v3_create(x * 0.01f, y * 0.01f, test_randomFloat(&seed, -0.001f, 0.001f));
+            vert->normal = v3_normalize(v3_create(test_randomFloat(&seed, -0.1f, 0.1f), test_randomFloat(&seed, -0.1f, 0.1f), 1.0f));
+            vert->texCoords = v2_create((float)x / GRID_SIZE, (float)y / GRID_SIZE);
+        }
+    }
+
+    bench->indicesLen = GRID_SIZE * GRID_SIZE * 6;
+    bench->indices = utils_malloc(sizeof(unsigned int) * bench->indicesLen);
+    unsigned int *index = bench->indices;
+    for (int y = 0; y < GRID_SIZE; ++y)
+    {
+        for (int x = 0; x < GRID_SIZE; ++x)
+        {
+            unsigned int a = y * rowLen + x;
+            unsigned int b = a + 1;
+            unsigned int c = a + rowLen;
+            unsigned int d = c + 1;
+            *index++ = a;
+            *index++ = b;
+            *index++ = d;
+            *index++ = a;
+            *index++ = d;
+            *index++ = c;
+        }
+    }
+}
+
+static void tangentsJob(void *ctx)
+{
+    tangentsBench_t *bench = ctx;
+    tangents_generate(bench->vertices, bench->verticesLen, bench->indices, bench->indicesLen, bench->numThreads);
+}
+
+int main(void)
+{
+    tangentsBench_t bench;
+    createGrid(&bench);
+    double megatris = bench.indicesLen / 3 / 1e6;
+    printf("tangents_generate, %.2f Mtri, budget %.0f ms/Mtri on 1 thread\n", megatris, BUDGET_MS_PER_MTRI);
+
+    bool isOverBudget = false;
+    int numCores = utils_getNumCores();
+    for (int numThreads = 1; numThreads <= numCores; numThreads *= 2)
+    {
+        bench.numThreads = numThreads;
+        double elapsed = bench_best(RUNS, tangentsJob, &bench);
+        double msPerMegatri = elapsed * 1e3 / megatris;
+        printf("  %2d thread(s): %7.1f ms  %6.1f ms/Mtri\n", numThreads, elapsed * 1e3, msPerMegatri);
+        isOverBudget |= numThreads == 1 && msPerMegatri > BUDGET_MS_PER_MTRI;
+    }
+    if (isOverBudget)
+    {
+        printf("  over budget\n");
+    }
+
+    free(bench.vertices);
+    free(bench.indices);
+    return isOverBudget ? EXIT_FAILURE : EXIT_SUCCESS;
+}
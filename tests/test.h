@@ -0,0 +1,44 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// failed checks are reported and counted rather than stopping the test, so one
+// run shows every failure. test_finish turns the count into the exit status
+
+static int test_failures = 0;
+
+#define TEST_CHECK(cond, ...)                             \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            printf("%s:%d: failed: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__);                          \
+            printf("\n");                                 \
+            ++test_failures;                              \
+        }                                                 \
+    } while (0)
+
+static inline int test_finish(const char *name)
+{
+    printf("%s: %s\n", name, test_failures == 0 ? "ok" : "FAILED");
+    return test_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// xorshift, so generated inputs are the same on every run
+static inline unsigned int test_random(unsigned long long *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (unsigned int)(*state >> 32);
+}
+
+static inline float test_randomFloat(unsigned long long *state, float min, float max)
+{
+    return min + (max - min) * (test_random(state) / 4294967296.0f);
+}
+
+#endif
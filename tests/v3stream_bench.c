@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "v3stream.h"
+#include "utils.h"
+#include "bench.h"
+#include "test.h"
+
+// small enough for the inputs and output to stay in L2, so the kernels are
+// timed rather than memory
+#define VECS_LEN 4096
+static const int RUNS = 20;
+static const int REPEATS = 200;
+
+typedef struct v3streamBench
+{
+    v3_t *as;
+    v3_t *bs;
+    v3_t *results;
+    float *floats;
+    v3stream_t a;
+    v3stream_t b;
+    v3stream_t result;
+    float *streamFloats;
+} v3streamBench_t;
+
+static void scalarAddJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < VECS_LEN; ++i)
+        {
+            bench->results[i] = v3_add(bench->as[i], bench->bs[i]);
+        }
+    }
+}
+
+static void streamAddJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        v3stream_add(bench->a, bench->b, bench->result);
+    }
+}
+
+static void scalarDotJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < VECS_LEN; ++i)
+        {
+            bench->floats[i] = v3_dot(bench->as[i], bench->bs[i]);
+        }
+    }
+}
+
+static void streamDotJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        v3stream_dot(bench->a, bench->b, bench->streamFloats);
+    }
+}
+
+static void scalarCrossJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < VECS_LEN; ++i)
+        {
+            bench->results[i] = v3_cross(bench->as[i], bench->bs[i]);
+        }
+    }
+}
+
+static void streamCrossJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        v3stream_cross(bench->a, bench->b, bench->result);
+    }
+}
+
+static void scalarLenJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < VECS_LEN; ++i)
+        {
+            bench->floats[i] = v3_len(bench->as[i]);
+        }
+    }
+}
+
+static void streamLenJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        v3stream_len(bench->a, bench->streamFloats);
+    }
+}
+
+static void scalarNormalizeJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < VECS_LEN; ++i)
+        {
+            bench->results[i] = v3_normalize(bench->as[i]);
+        }
+    }
+}
+
+static void streamNormalizeJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        v3stream_normalize(bench->a, bench->result);
+    }
+}
+
+static void scalarInterpolateJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (int i = 0; i < VECS_LEN; ++i)
+        {
+            bench->results[i] = v3_interpolate(bench->as[i], bench->bs[i], 0.25f);
+        }
+    }
+}
+
+static void streamInterpolateJob(void *ctx)
+{
+    v3streamBench_t *bench = ctx;
+    for (int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        v3stream_interpolate(bench->a, bench->b, 0.25f, bench->result);
+    }
+}
+
+static double mvecsPerSecond(void (*job)(void *ctx), v3streamBench_t *bench)
+{
+    double elapsed = bench_best(RUNS, job, bench);
+    return (double)VECS_LEN * REPEATS / elapsed * 1e-6;
+}
+
+static void report(const char *name, void (*scalarJob)(void *ctx), void (*streamJob)(void *ctx), v3streamBench_t *bench)
+{
+    double scalar = mvecsPerSecond(scalarJob, bench);
+    double stream = mvecsPerSecond(streamJob, bench);
+    printf("  %-12s scalar %8.1f Mvec/s  stream %8.1f Mvec/s  %5.1fx\n", name, scalar, stream, stream / scalar);
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    v3streamBench_t bench;
+    bench.as = utils_malloc(sizeof(v3_t) * VECS_LEN);
+    bench.bs = utils_malloc(sizeof(v3_t) * VECS_LEN);
+    bench.results = utils_malloc(sizeof(v3_t) * VECS_LEN);
+    bench.floats = utils_malloc(sizeof(float) * VECS_LEN);
+    for (int i = 0; i < VECS_LEN; ++i)
+    {
+        bench.as[i] = v3_create(test_randomFloat(&seed, -1.0f, 1.0f), test_randomFloat(&seed, -1.0f, 1.0f), test_randomFloat(&seed, -1.0f, 1.0f));
+        bench.bs[i] = v3_create(test_randomFloat(&seed, -1.0f, 1.0f), test_randomFloat(&seed, -1.0f, 1.0f), test_randomFloat(&seed, -1.0f, 1.0f));
+    }
+    bench.a = v3stream_fromV3s(bench.as, VECS_LEN);
+    bench.b = v3stream_fromV3s(bench.bs, VECS_LEN);
+    bench.result = v3stream_create(VECS_LEN);
+    bench.streamFloats = utils_alignedMalloc(V3STREAM_ALIGNMENT, sizeof(float) * v3stream_paddedLen(VECS_LEN));
+
+    printf("v3 api against v3stream, %d vectors\n", VECS_LEN);
+    report("add", scalarAddJob, streamAddJob, &bench);
+    report("dot", scalarDotJob, streamDotJob, &bench);
+    report("cross", scalarCrossJob, streamCrossJob, &bench);
+    report("len", scalarLenJob, streamLenJob, &bench);
+    report("normalize", scalarNormalizeJob, streamNormalizeJob, &bench);
+    report("interpolate", scalarInterpolateJob, streamInterpolateJob, &bench);
+
+    v3stream_free(bench.a);
+    v3stream_free(bench.b);
+    v3stream_free(bench.result);
+    free(bench.streamFloats);
+    free(bench.as);
+    free(bench.bs);
+    free(bench.results);
+    free(bench.floats);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "v3stream.h"
+#include "obj.h"
+#include "utils.h"
+#include "test.h"
+
+// tests/run.sh builds this with each of the scalar, SSE and AVX kernels. none
+// of the lengths are a multiple of 4 or 8, so every kernel runs into the padding
+static const int LENS[] = {1, 3, 7, 13, 17, 31, 100, 1001};
+static const float MAX_ERROR = 1e-5f;
+// 20k triangles without normals, enough that the scratch arrays come from mmap
+static const int NORMALS_GRID_SIZE = 100;
+
+static const char *kernelName(void)
+{
+#if defined(V3STREAM_SCALAR)
+    return "scalar";
+#elif defined(__AVX__)
+    return "avx";
+#elif defined(__SSE2__) || defined(_M_X64)
+    return "sse";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+static bool isClose(float a, float b)
+{
+    return fabsf(a - b) <= MAX_ERROR * fmaxf(1.0f, fmaxf(fabsf(a), fabsf(b)));
+}
+
+static bool isCloseV3(v3_t a, v3_t b)
+{
+    return isClose(a.x, b.x) && isClose(a.y, b.y) && isClose(a.z, b.z);
+}
+
+static v3_t *randomV3s(unsigned long long *seed, int len)
+{
+    v3_t *result = utils_malloc(sizeof(v3_t) * len);
+    for (int i = 0; i < len; ++i)
+    {
+        result[i] = v3_create(
+            test_randomFloat(seed, -100.0f, 100.0f),
+            test_randomFloat(seed, -100.0f, 100.0f),
+            test_randomFloat(seed, -100.0f, 100.0f));
+    }
+    return result;
+}
+
+static void checkStream(const char *name, int len, v3stream_t s, v3_t *expected)
+{
+    for (int i = 0; i < len; ++i)
+    {
+        v3_t v = v3stream_get(s, i);
+        if (!isCloseV3(v, expected[i]))
+        {
+            TEST_CHECK(false, "%s v3stream_%s, len %d, [%d]: %g %g %g, expected %g %g %g",
+                       kernelName(), name, len, i, v.x, v.y, v.z, expected[i].x, expected[i].y, expected[i].z);
+            return;
+        }
+    }
+}
+
+static void checkFloats(const char *name, int len, float *values, float *expected)
+{
+    for (int i = 0; i < len; ++i)
+    {
+        if (!isClose(values[i], expected[i]))
+        {
+            TEST_CHECK(false, "%s v3stream_%s, len %d, [%d]: %g, expected %g",
+                       kernelName(), name, len, i, values[i], expected[i]);
+            return;
+        }
+    }
+}
+
+static void checkKernels(unsigned long long *seed, int len)
+{
+    v3_t *as = randomV3s(seed, len);
+    v3_t *bs = randomV3s(seed, len);
+    v3_t *expected = utils_malloc(sizeof(v3_t) * len);
+    float *expectedFloats = utils_malloc(sizeof(float) * len);
+    float *floats = utils_alignedMalloc(V3STREAM_ALIGNMENT, sizeof(float) * v3stream_paddedLen(len));
+    v3stream_t a = v3stream_fromV3s(as, len);
+    v3stream_t b = v3stream_fromV3s(bs, len);
+    v3stream_t result = v3stream_create(len);
+    float scale = test_randomFloat(seed, -2.0f, 2.0f);
+    float t = test_randomFloat(seed, 0.0f, 1.0f);
+
+    v3stream_toV3s(a, expected);
+    TEST_CHECK(memcmp(expected, as, sizeof(v3_t) * len) == 0, "v3stream_toV3s, len %d, differs from the input", len);
+
+    v3stream_add(a, b, result);
+    for (int i = 0; i < len; ++i)
+    {
+        expected[i] = v3_add(as[i], bs[i]);
+    }
+    checkStream("add", len, result, expected);
+
+    v3stream_sub(a, b, result);
+    for (int i = 0; i < len; ++i)
+    {
+        expected[i] = v3_sub(as[i], bs[i]);
+    }
+    checkStream("sub", len, result, expected);
+
+    v3stream_scale(a, scale, result);
+    for (int i = 0; i < len; ++i)
+    {
+        expected[i] = v3_mul(as[i], scale);
+    }
+    checkStream("scale", len, result, expected);
+
+    v3stream_cross(a, b, result);
+    for (int i = 0; i < len; ++i)
+    {
+        expected[i] = v3_cross(as[i], bs[i]);
+    }
+    checkStream("cross", len, result, expected);
+
+    v3stream_normalize(a, result);
+    for (int i = 0; i < len; ++i)
+    {
+        expected[i] = v3_normalize(as[i]);
+    }
+    checkStream("normalize", len, result, expected);
+
+    v3stream_interpolate(a, b, t, result);
+    for (int i = 0; i < len; ++i)
+    {
+        expected[i] = v3_interpolate(as[i], bs[i], t);
+    }
+    checkStream("interpolate", len, result, expected);
+
+    v3stream_dot(a, b, floats);
+    for (int i = 0; i < len; ++i)
+    {
+        expectedFloats[i] = v3_dot(as[i], bs[i]);
+    }
+    checkFloats("dot", len, floats, expectedFloats);
+
+    v3stream_len(a, floats);
+    for (int i = 0; i < len; ++i)
+    {
+        expectedFloats[i] = v3_len(as[i]);
+    }
+    checkFloats("len", len, floats, expectedFloats);
+
+    v3_t min, max;
+    v3stream_bounds(a, &min, &max);
+    v3_t expectedMin = as[0];
+    v3_t expectedMax = as[0];
+    for (int i = 1; i < len; ++i)
+    {
+        expectedMin = v3_create(fminf(expectedMin.x, as[i].x), fminf(expectedMin.y, as[i].y), fminf(expectedMin.z, as[i].z));
+        expectedMax = v3_create(fmaxf(expectedMax.x, as[i].x), fmaxf(expectedMax.y, as[i].y), fmaxf(expectedMax.z, as[i].z));
+    }
+    // the padding is zeros, which must not widen the bounds
+    TEST_CHECK(memcmp(&min, &expectedMin, sizeof(v3_t)) == 0 && memcmp(&max, &expectedMax, sizeof(v3_t)) == 0,
+               "%s v3stream_bounds, len %d: %g %g %g to %g %g %g, expected %g %g %g to %g %g %g",
+               kernelName(), len, min.x, min.y, min.z, max.x, max.y, max.z,
+               expectedMin.x, expectedMin.y, expectedMin.z, expectedMax.x, expectedMax.y, expectedMax.z);
+
+    v3stream_free(result);
+    v3stream_free(b);
+    v3stream_free(a);
+    free(floats);
+    free(expectedFloats);
+    free(expected);
+    free(bs);
+    free(as);
+}
+
+// zero length vectors normalize to zero rather than nan
+static void checkNormalizeZero(void)
+{
+    v3stream_t s = v3stream_create(3);
+    v3stream_set(s, 1, v3_create(3.0f, 0.0f, 4.0f));
+    v3stream_normalize(s, s);
+    v3_t zero = v3stream_get(s, 0);
+    TEST_CHECK(zero.x == 0.0f && zero.y == 0.0f && zero.z == 0.0f,
+               "%s v3stream_normalize of zero: %g %g %g", kernelName(), zero.x, zero.y, zero.z);
+    TEST_CHECK(isCloseV3(v3stream_get(s, 1), v3_create(0.6f, 0.0f, 0.8f)), "%s v3stream_normalize", kernelName());
+    v3stream_free(s);
+}
+
+// normal generation feeds its own scratch arrays to v3stream_len and
+// v3stream_dot. a flat grid without vn records must come out facing +z
+static void checkGenerateNormals(void)
+{
+    int rowLen = NORMALS_GRID_SIZE + 1;
+    size_t textCap = (size_t)rowLen * rowLen * 32 + (size_t)NORMALS_GRID_SIZE * NORMALS_GRID_SIZE * 2 * 48;
+    char *text = utils_malloc(textCap);
+    size_t textLen = 0;
+    for (int y = 0; y < rowLen; ++y)
+    {
+        for (int x = 0; x < rowLen; ++x)
+        {
+            textLen += snprintf(text + textLen, textCap - textLen, "v %d %d 0\n", x, y);
+        }
+    }
+    for (int y = 0; y < NORMALS_GRID_SIZE; ++y)
+    {
+        for (int x = 0; x < NORMALS_GRID_SIZE; ++x)
+        {
+            int a = y * rowLen + x + 1;
+            int b = a + 1;
+            int c = a + rowLen;
+            int d = c + 1;
+            textLen += snprintf(text + textLen, textCap - textLen, "f %d %d %d\nf %d %d %d\n", a, b, d, a, d, c);
+        }
+    }
+
+    obj_t obj = obj_create();
+    obj_parse(&obj, text, text + textLen);
+    obj_generateNormals(&obj, (float)M_PI / 3.0f, 1);
+    TEST_CHECK(obj.cornersLen == NORMALS_GRID_SIZE * NORMALS_GRID_SIZE * 6, "grid has %d corners", obj.cornersLen);
+    for (int i = 0; i < obj.cornersLen; ++i)
+    {
+        int normal = obj.corners[i].normal;
+        if (normal < 0 || normal >= obj.normalsLen || !isCloseV3(obj.normals[normal], v3_create(0.0f, 0.0f, 1.0f)))
+        {
+            TEST_CHECK(false, "%s obj_generateNormals: corner %d has no +z normal", kernelName(), i);
+            break;
+        }
+    }
+
+    obj_free(&obj);
+    free(text);
+}
+
+int main(void)
+{
+    unsigned long long seed = 1;
+    for (size_t i = 0; i < sizeof(LENS) / sizeof(LENS[0]); ++i)
+    {
+        checkKernels(&seed, LENS[i]);
+    }
+    checkNormalizeZero();
+    checkGenerateNormals();
+
+    printf("%s kernels: ", kernelName());
+    return test_finish("v3stream_test");
+}